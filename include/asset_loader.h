@@ -0,0 +1,25 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "raylib.h"
+#include "assets.h"
+
+#define ASSET_LOADER_MAX_WORKERS 4
+#define ASSET_LOADER_MAX_FILES 16       // Files prefetched for one model (glTF, buffers, images)
+
+// Asynchronous asset loading. Worker threads read files and decode
+// images; the main thread uploads finished assets to the GPU within a
+// per-frame time budget. Requests return registry handles right away,
+// and the asset becomes usable once IsAssetReady reports it.
+void InitAssetLoader(void);
+void UnloadAssetLoader(void);
+AssetHandle RequestTexture(const char* path, Color fallback);
+AssetHandle RequestModel(const char* path);
+AssetHandle RequestShader(const char* vsPath, const char* fsPath);
+AssetHandle RequestGeneratedTexture(const TexGenParams* params);
+int UpdateAssetLoader(double budget);
+void CompleteAssetLoad(AssetHandle handle);
+bool AssetLoadsPending(void);
+float GetAssetLoadProgress(void);
+
+#endif // ASSET_LOADER_H
@@ -0,0 +1,65 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "raylib.h"
+#include "texgen.h"
+
+#define ASSET_KEY_LENGTH 128
+#define ASSET_INVALID -1
+
+// Handle to an entry in the asset registry
+typedef int AssetHandle;
+
+// Kinds of asset the registry holds
+typedef enum {
+    ASSET_TEXTURE,
+    ASSET_MODEL,
+    ASSET_SHADER
+} AssetType;
+
+// Primitive shapes for generated models
+typedef enum {
+    MESH_SHAPE_CUBE,        // size = width, height, length
+    MESH_SHAPE_PLANE,       // size = width, -, length; detail = subdivisions per side
+    MESH_SHAPE_CYLINDER,    // size = radius, height, -; detail = slices
+    MESH_SHAPE_SPHERE       // size = radius, -, -; detail = rings and slices
+} MeshShape;
+
+// One registered asset. Entries stay resident when their reference count
+// drops to zero, so a later acquire of the same key costs nothing.
+typedef struct {
+    char key[ASSET_KEY_LENGTH];
+    unsigned int hash;
+    AssetType type;
+    int refCount;
+    bool ready;             // False while an asynchronous load is in flight
+    AssetHandle dependency; // Texture a pak model holds a reference on, or ASSET_INVALID
+    union {
+        Texture2D texture;
+        Model model;
+        Shader shader;
+    };
+} AssetEntry;
+
+// Asset registry functions
+void InitAssetRegistry(void);
+void UnloadAssetRegistry(void);
+AssetHandle AcquireTexture(const char* path, Color fallback);
+AssetHandle AcquireColorTexture(int size, Color color);
+AssetHandle AcquireGeneratedTexture(const TexGenParams* params);
+AssetHandle AcquireMeshModel(const char* key, MeshShape shape, Vector3 size, int detail);
+AssetHandle AcquireModelFile(const char* path);
+AssetHandle AcquireShader(const char* vsPath, const char* fsPath);
+void ReleaseAsset(AssetHandle handle);
+Texture2D GetTextureAsset(AssetHandle handle);
+Model* GetModelAsset(AssetHandle handle);
+Shader GetShaderAsset(AssetHandle handle);
+
+// Hooks for the asynchronous loader
+AssetHandle ReserveAsset(const char* key, AssetType type, bool* created);
+void StoreTextureAsset(AssetHandle handle, Texture2D texture);
+void StoreModelAsset(AssetHandle handle, Model model, AssetHandle dependency);
+void StoreShaderAsset(AssetHandle handle, Shader shader);
+bool IsAssetReady(AssetHandle handle);
+
+#endif // ASSETS_H
@@ -0,0 +1,12 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include "raylib.h"
+
+// The audio device is opened the first time a sound needs it rather than
+// at startup, so a session that never plays sound never pays for it
+bool EnsureAudioDevice(void);
+Sound LoadGameSound(const char* path);
+void CloseGameAudio(void);
+
+#endif // AUDIO_H
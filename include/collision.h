@@ -0,0 +1,24 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "raylib.h"
+#include "dungeon.h"
+
+#define COLLISION_RADIUS_SCALE 0.65f    // Share of an entity's radius that walls see
+#define COLLISION_MAX_SLIDES 3          // Wall contacts resolved in one move
+#define COLLISION_SKIN 0.001f           // Gap left between a circle and the wall it stops against
+
+// Circles moving over the dungeon floor, on the x/z plane. A move is swept
+// rather than sampled at its end: the centre's path is walked through the
+// tile grid with a DDA, each solid tile near it is tested as a box grown
+// by the radius with rounded corners, and the earliest contact wins. The
+// rest of the move then slides along the wall, so a move of any length
+// stops at the first wall in its way and never tunnels. Tiles outside the
+// level are solid. Radii are the entity's; walls see COLLISION_RADIUS_SCALE
+// of them, so the widest archetypes still fit one-tile corridors.
+float SweepCircle(Dungeon* dungeon, Vector2 start, Vector2 move, float radius, Vector2* normal);
+bool MoveCircle(Dungeon* dungeon, Vector2* position, Vector2 move, float radius);
+void MoveCircles(Dungeon* dungeon, float* positionX, float* positionZ, const float* moveX, const float* moveZ,
+                 const float* radius, int count);
+
+#endif // COLLISION_H
@@ -0,0 +1,74 @@
+#ifndef DIRECTOR_H
+#define DIRECTOR_H
+
+#include "raylib.h"
+#include "spawner.h"
+#include "dungeon.h"
+
+// Share of the frame budget awake enemies may cost, sim and render together
+#define DIRECTOR_BUDGET_SHARE 0.35f
+#define DIRECTOR_MIN_ACTIVE 8
+#define DIRECTOR_MAX_ACTIVE 128
+#define DIRECTOR_MIN_WAKE_RADIUS 8.0f
+#define DIRECTOR_MAX_WAKE_RADIUS SPAWN_WAKE_RADIUS
+#define DIRECTOR_WAKES_PER_SECOND 12.0f // A full room wakes over a few ticks, not in one
+#define DIRECTOR_WAKE_BURST 3.0f
+#define DIRECTOR_SMOOTHING 0.05f        // Weight of the newest sample in the cost averages
+#define DIRECTOR_MIN_FIT_VARIANCE 4.0f  // Spread of enemies drawn needed to fit the render cost
+#define DIRECTOR_UP_FRAMES 60           // Frames with headroom before the active cap grows
+#define DIRECTOR_UP_HEADROOM 1.25f      // How far the affordable count must exceed the cap
+#define DIRECTOR_WAVE_INTERVAL 30.0f    // Seconds between waves with the cap mostly free
+#define DIRECTOR_WAVE_RETRY 3.0f        // Wait before retrying a wave the budget held back
+#define DIRECTOR_WAVE_BUDGET_SHARE 0.25f // Share of the level's spawn budget one wave spends
+
+// Why the director last held spawning back
+typedef enum {
+    DIRECTOR_UNCONSTRAINED,
+    DIRECTOR_CAPPED_WAKES,              // Dormant enemies in range waiting for the active cap
+    DIRECTOR_RATE_LIMITED,              // Dormant enemies in range waiting for the wake rate
+    DIRECTOR_DEFERRED_WAVE              // A wave was due but would not fit under the cap
+} DirectorLimit;
+
+// Keeps awake enemies inside a share of the frame budget. Costs are
+// measured: sim time per awake enemy directly, render time per drawn
+// enemy by fitting scene time against the number drawn. From those the
+// director sets the active cap, the wake radius and the wave pacing.
+// Every field is telemetry as well as state.
+typedef struct {
+    float budget;                       // Seconds per frame enemies may cost
+    float simCostPerEnemy;              // Seconds per awake enemy per tick
+    float renderCostPerEnemy;           // Seconds per drawn enemy per frame
+    float projectedCost;                // Seconds per frame at the current active count
+
+    int activeEnemies;
+    int maxActive;
+    float wakeRadius;
+    float wakeTokens;
+    int waitingWakes;                   // Dormant in range but held back, last tick
+
+    float waveTimer;
+    float waveInterval;
+    int wavesSpawned;
+    int wavesDeferred;
+
+    DirectorLimit limit;
+    int framesWithHeadroom;
+    bool capHeld;                       // Keep the cap off the clock, so recorded runs replay exactly
+
+    // Exponentially weighted moments for the render cost fit
+    float meanDrawn;
+    float meanSceneTime;
+    float meanDrawnSquared;
+    float meanDrawnSceneTime;
+} SpawnDirector;
+
+// Spawn director functions
+void InitSpawnDirector(SpawnDirector* director, int targetFps);
+void ResetSpawnDirectorLevel(SpawnDirector* director);
+void UpdateSpawnDirector(SpawnDirector* director, EnemyPool* pool, const SpatialHash* spatial, Dungeon* dungeon,
+                         Vector3 playerPosition, int level, float deltaTime);
+void RecordEnemySimCost(SpawnDirector* director, float seconds, int awakeEnemies);
+void RecordEnemyRenderCost(SpawnDirector* director, float sceneSeconds, int drawnEnemies, int ticksThisFrame);
+const char* GetDirectorLimitName(DirectorLimit limit);
+
+#endif // DIRECTOR_H
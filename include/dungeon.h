@@ -2,6 +2,27 @@
 #define DUNGEON_H
 
 #include "raylib.h"
+#include "render_queue.h"
+#include "assets.h"
+
+#define DUNGEON_MAX_ASSETS 24
+
+// Level themes. Only the dungeon theme has texture files; the others use
+// procedurally generated surfaces.
+typedef enum {
+    DUNGEON_THEME_DUNGEON,
+    DUNGEON_THEME_CAVE,
+    DUNGEON_THEME_CRYPT,
+    DUNGEON_THEME_COUNT
+} DungeonTheme;
+
+// Files loaded for the dungeon theme
+#define DUNGEON_WALL_TEXTURE "assets/textures/dungeon/tiling_dungeon_brickwall01.png"
+#define DUNGEON_FLOOR_TEXTURE "assets/textures/dungeon/tiling_dungeon_floor01.png"
+#define DUNGEON_WALL_FALLBACK (Color){128, 128, 128, 255}      // Gray
+#define DUNGEON_FLOOR_FALLBACK (Color){139, 69, 19, 255}       // Brown
+#define DUNGEON_TILING_VS "assets/shaders/custom_tiling.vs"
+#define DUNGEON_TILING_FS "assets/shaders/custom_tiling.fs"
 
 // Define tile types for the dungeon
 typedef enum {
@@ -24,6 +45,26 @@ typedef struct {
     bool connected;
 } Room;
 
+// Static torch light mounted on a wall
+typedef struct {
+    Vector3 position;   // World position of the flame
+    int tileX;          // Floor tile the torch shines into
+    int tileY;
+    float radius;       // Light falloff radius in tiles
+    float intensity;
+    Color color;
+} TorchLight;
+
+// Cached shadow map for one torch - a square window of tiles around the
+// torch, packed into the dungeon's shared shadow atlas
+typedef struct {
+    int originX;        // First tile covered by the window
+    int originY;
+    int size;           // Window is size x size tiles
+    int atlasOffset;    // Index of the window's first cell in the atlas
+    bool dynamicActive; // Dynamic casters were rendered into it last update
+} TorchShadowMap;
+
 // Dungeon structure definition
 typedef struct Dungeon {
     int width;
@@ -42,6 +83,26 @@ typedef struct Dungeon {
     // Dungeon theme (affects textures and models used)
     int theme;
     
+    // Static torch lights placed by AddDecorativeProps
+    TorchLight* torches;
+    int torchCount;
+    
+    // Baked per-tile lighting (ambient occlusion * static torch light)
+    // Indexed as [x * height + y], filled by BakeDungeonLighting
+    Color* bakedLight;
+    
+    // Static shadow maps per torch (light reaching each tile past the walls),
+    // built once at level load by BuildTorchShadowMaps
+    TorchShadowMap* torchShadows;
+    float* shadowAtlas;
+    int shadowAtlasSize;
+    
+    // Torch light removed from each tile by moving casters this frame
+    Vector3* dynamicShadow;
+    
+    // Room and corridor clusters for long paths, built by BuildNavGraph
+    struct NavGraph* navGraph;
+    
     // Models used for dungeon rendering
     Model floorModel;
     Model wallModel;
@@ -63,16 +124,20 @@ typedef struct Dungeon {
     
     // Custom shader for wall texture tiling
     Shader tilingShader;
+    
+    // Registry handles behind the models, textures and shader above
+    AssetHandle assets[DUNGEON_MAX_ASSETS];
+    int assetCount;
 } Dungeon;
 
 // Dungeon generation and management functions
 void InitDungeon(Dungeon* dungeon);
 void GenerateDungeon(Dungeon* dungeon, int width, int height, int maxRooms, int theme);
+void RequestDungeonAssets(void);
 void LoadDungeonAssets(Dungeon* dungeon, int theme);
 void UnloadDungeon(Dungeon* dungeon);
-void DrawDungeon(Dungeon* dungeon);
+void DrawDungeon(Dungeon* dungeon, RenderQueue* queue);
 Vector3 GetRandomFloorPosition(Dungeon* dungeon);
-bool IsWalkable(Dungeon* dungeon, float x, float z, float radius);
 bool IsInsideDungeon(Dungeon* dungeon, float x, float z);
 
 #endif // DUNGEON_H
@@ -2,17 +2,24 @@
 #define DUNGEON_PROPS_H
 
 #include "dungeon.h"
+#include "ecs.h"
 
 // Function to clear 90-degree corners for better navigation
 void ClearCornerBlocks(Dungeon* dungeon);
 
+// Create the prop models shared by every level
+void LoadPropModels();
+
 // Function to add decorative props to the dungeon
 void AddDecorativeProps(Dungeon* dungeon);
 
-// Unload prop resources
+// Function to place barrels, crates and tables as prop entities
+void SpawnPropEntities(World* world, Dungeon* dungeon);
+
+// Release prop resources
 void UnloadProps();
 
-// Draw props - called from the main rendering loop
-void DrawDungeonProps(Dungeon* dungeon);
+// Draw wall torches - called from the main rendering loop
+void DrawDungeonProps(Dungeon* dungeon, RenderQueue* queue);
 
 #endif // DUNGEON_PROPS_H
@@ -0,0 +1,154 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include "raylib.h"
+#include "item.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define ECS_MAX_SYSTEMS 16
+#define ENTITY_INDEX_BITS 20            // Low bits index the entity, high bits count its reuses
+#define ENTITY_INDEX_MASK ((1u << ENTITY_INDEX_BITS) - 1)
+#define ENTITY_GENERATION_MASK ((1u << (32 - ENTITY_INDEX_BITS)) - 1)
+#define ENTITY_NONE 0xFFFFFFFFu
+
+// Handle to an entity. A handle kept past the entity's destruction stops
+// resolving, even after its index is reused.
+typedef uint32_t Entity;
+
+// Component types. Each one is a sparse set: a dense, contiguous array of
+// component data with the owning entities alongside, and a sparse table
+// from entity index to dense position.
+typedef enum {
+    COMPONENT_TRANSFORM,
+    COMPONENT_RENDERABLE,
+    COMPONENT_ENEMY,
+    COMPONENT_ITEM,
+    COMPONENT_PROJECTILE,
+    COMPONENT_PROP,
+    COMPONENT_COUNT
+} ComponentType;
+
+// Query masks, one bit per component type
+typedef enum {
+    WITH_TRANSFORM  = 1 << COMPONENT_TRANSFORM,
+    WITH_RENDERABLE = 1 << COMPONENT_RENDERABLE,
+    WITH_ENEMY      = 1 << COMPONENT_ENEMY,
+    WITH_ITEM       = 1 << COMPONENT_ITEM,
+    WITH_PROJECTILE = 1 << COMPONENT_PROJECTILE,
+    WITH_PROP       = 1 << COMPONENT_PROP
+} ComponentMask;
+
+// Placement in the world
+typedef struct {
+    Vector3 position;
+    float rotation;                     // Degrees about Y
+} WorldTransform;
+
+// Model drawn at the entity's transform
+typedef struct {
+    const Model* model;                 // Shared; the entity does not own it
+    Color tint;
+} Renderable;
+
+// Enemy whose simulation state lives in the enemy pool's arrays
+typedef struct {
+    int slot;
+} EnemyComponent;
+
+// Item lying on the ground, until the player picks it up
+typedef Item ItemComponent;
+
+// Bolt flying in a straight line until it hits a wall or the player, or
+// runs out of time
+typedef struct {
+    Vector3 velocity;
+    float radius;
+    float lifetime;
+    int damage;
+} Projectile;
+
+// Static decoration placed with the level
+typedef enum {
+    PROP_BARREL,
+    PROP_CRATE,
+    PROP_TABLE
+} PropKind;
+
+typedef struct {
+    PropKind kind;
+} Prop;
+
+typedef struct {
+    int* sparse;                        // Entity index -> dense position, -1 when absent
+    Entity* dense;                      // Owner of each dense element
+    unsigned char* data;                // count elements of size bytes, contiguous
+    size_t size;
+    int count;
+    int capacity;
+} ComponentStore;
+
+typedef struct World World;
+
+// A system runs once per tick over the components it queries
+typedef void (*SystemFunction)(World* world, void* context, float deltaTime);
+
+typedef struct {
+    const char* name;
+    SystemFunction update;
+} System;
+
+// Entities, their components, and the systems run over them in order
+struct World {
+    uint16_t* generations;              // Reuse count per entity index
+    int* freeIndices;
+    int freeCount;
+    int used;                           // Indices [0, used) have been handed out
+    int capacity;
+    int liveCount;
+
+    ComponentStore stores[COMPONENT_COUNT];
+
+    // Destruction is deferred until the running system finishes, so a
+    // system can destroy entities while iterating
+    Entity* pendingDestroy;
+    int pendingCount;
+
+    System systems[ECS_MAX_SYSTEMS];
+    int systemCount;
+};
+
+// Iterates the entities holding every component in a mask, driven by the
+// smallest of those components' stores
+typedef struct {
+    World* world;
+    unsigned mask;
+    ComponentStore* driver;
+    int next;
+    Entity entity;                      // Current match after QueryNext returns true
+} Query;
+
+// World functions
+void InitWorld(World* world, int maxEntities);
+void UnloadWorld(World* world);
+void ClearWorld(World* world);
+void RegisterComponent(World* world, ComponentType type, size_t size, int capacity);
+Entity CreateEntity(World* world);
+void DestroyEntity(World* world, Entity entity);
+void FlushDestroyedEntities(World* world);
+bool IsEntityAlive(const World* world, Entity entity);
+
+// Component functions
+void* AddComponent(World* world, Entity entity, ComponentType type);
+void RemoveComponent(World* world, Entity entity, ComponentType type);
+void* GetComponent(World* world, Entity entity, ComponentType type);
+void* GetComponentArray(World* world, ComponentType type);
+int GetComponentCount(const World* world, ComponentType type);
+
+// Query and system functions
+Query BeginQuery(World* world, unsigned mask);
+bool QueryNext(Query* query);
+void AddSystem(World* world, const char* name, SystemFunction update);
+void RunSystems(World* world, void* context, float deltaTime);
+
+#endif // ECS_H
@@ -2,18 +2,55 @@
 #define ENEMY_H
 
 #include "raylib.h"
+#include "render_queue.h"
+#include "assets.h"
+#include "ecs.h"
+#include "flow_field.h"
+#include "dungeon.h"
+#include "field_of_view.h"
 
-// Enemy types
+// Enemy types, one per row of data/enemies.def
 typedef enum {
-    ENEMY_SKELETON_BASIC,
-    ENEMY_SKELETON_WARRIOR,
-    ENEMY_SKELETON_ARCHER,
-    ENEMY_SKELETON_MAGE,
+#define ENEMY_DEF(id, ...) ENEMY_##id,
+#include "../data/enemies.def"
+#undef ENEMY_DEF
     ENEMY_COUNT
 } EnemyType;
 
+// Stats shared by every enemy of a type, before level scaling
+typedef struct {
+    const char* name;
+    Color color;
+    float width;
+    float height;
+    float radius;
+    float speed;
+    float speedPerLevel;
+    int health;
+    int healthPerLevel;
+    int attackDamage;
+    int attackDamagePerLevel;
+    float attackRange;
+    float detectionRange;
+    float patrolRadius;
+    float attackCooldown;
+    int experienceValue;
+    int experiencePerLevel;
+    float dropChance;
+    float dropChancePerLevel;
+    int minGold;
+    int maxGold;
+    int maxGoldPerLevel;
+    int spawnCost;                      // Difficulty budget points
+    int minLevel;                       // First dungeon level it spawns on
+    float projectileSpeed;              // Zero for melee attackers
+} EnemyArchetype;
+
+extern const EnemyArchetype enemyArchetypes[ENEMY_COUNT];
+
 // Enemy states
 typedef enum {
+    ENEMY_DORMANT,                      // Placed but not simulated until woken
     ENEMY_IDLE,
     ENEMY_PATROLLING,
     ENEMY_CHASING,
@@ -22,20 +59,29 @@ typedef enum {
     ENEMY_DEAD
 } EnemyState;
 
-// Enemy structure
+// How often an awake enemy is updated, by distance from the player
+typedef enum {
+    ENEMY_LOD_FULL,                     // Every tick
+    ENEMY_LOD_REDUCED,                  // In turn with the other mid-range enemies
+    ENEMY_LOD_FROZEN,                   // Not at all; sent back to dormant, position and health kept
+    ENEMY_LOD_COUNT
+} EnemyLodTier;
+
+#define ENEMY_PATHFIND_INTERVAL 1.0f     // Seconds between patrol retargets
+#define ENEMY_LOD_FULL_RADIUS 18.0f     // Past the field of view and every detection range
+#define ENEMY_LOD_REDUCED_RADIUS 36.0f
+#define ENEMY_LOD_SLICE_BUDGET 16       // Reduced-tier updates per tick
+#define ENEMY_LOD_MAX_STEP 0.5f         // Longest stretch of time one reduced update covers
+#define ENEMY_SIMD_WIDTH 4              // Lanes per kernel batch; pool capacity is a multiple
+#define ENEMY_JOB_GRAIN 64              // Kernel batches per update job at least
+
+// Cold per-enemy data: read on spawn, hits, deaths and drawing, never by
+// the update kernels
 typedef struct Enemy {
-    // Enemy type and state
     EnemyType type;
-    EnemyState state;
-    
-    // Position and movement
-    Vector3 position;
-    Vector3 velocity;
-    Vector3 direction;
-    float speed;
-    float patrolRadius;
+    int level;
     Vector3 spawnPosition;
-    float rotationAngle;
+    float patrolRadius;
     
     // Physical properties
     float height;
@@ -45,41 +91,87 @@ typedef struct Enemy {
     int health;
     int maxHealth;
     int attackDamage;
-    float attackRange;
-    float detectionRange;
     int experienceValue;
-    int level;
-    
-    // Combat properties
-    float attackTimer;
-    float attackCooldown;
-    bool isAttacking;
-    
-    // Visual representation
-    Model model;
-    
-    // AI properties
-    float pathfindTimer;
-    float pathfindInterval;
-    float stateTimer;
     
     // Loot drop chances
     float dropChance;
     int minGold;
     int maxGold;
     
-    // Animation properties
-    float animTimer;
-    bool isAlive;
+    // Visual representation, shared by every enemy of the archetype
+    Model* model;
+    
+    Entity entity;                      // The enemy's handle in the world
+    
+    // Next step of a long chase, found past the flow field's reach
+    int navTile;                        // Tile the step was found from, -1 for none
+    Vector3 navStep;
+    bool hasNavStep;
 } Enemy;
 
+// Preallocated enemy slots. Hot state the update runs on every tick is
+// stored as one array per field, indexed by slot, so the kernels stream
+// through it four enemies at a time; the rest lives in the cold records.
+// Slots [0, used) have held an enemy; dead ones go on the free list and
+// are handed out again before the pool grows into unused slots, so
+// spawning never allocates.
+typedef struct {
+    // Hot state
+    float* positionX;
+    float* positionY;
+    float* positionZ;
+    float* velocityX;
+    float* velocityZ;
+    float* directionX;
+    float* directionZ;
+    float* rotation;                    // Degrees about Y, facing the direction of travel
+    float* attackTimer;
+    float* pathfindTimer;
+    float* stateTimer;
+    float* animTimer;
+    int* state;                         // EnemyState
+    int* attacking;                     // All bits set the tick an attack is ready
+    int* seesPlayer;                    // All bits set while the player is in view, from UpdateEnemySight
+    
+    // Update scheduling
+    float* stepTime;                    // Seconds the slot advances this tick, zero to skip it
+    float* lodTime;                     // Seconds a reduced-tier slot has waited for its turn
+    int* lodTier;                       // EnemyLodTier
+    
+    // Per-enemy constants the kernels read
+    float* speed;
+    float* attackRange;
+    float* detectionRange;
+    float* attackCooldown;
+    
+    // Cold records
+    Enemy* enemies;
+    
+    int* freeSlots;                     // Stack of released slot indices
+    int freeCount;
+    int used;
+    int capacity;
+    int liveCount;                      // Alive, dormant or awake
+    int dormantCount;
+    int lodCursor;                      // Next slot the reduced-tier round-robin looks at
+    int tierCounts[ENEMY_LOD_COUNT];    // Awake enemies per tier, last tick; frozen counts the dormant
+    
+    World* world;                       // Holds an entity per live enemy
+} EnemyPool;
+
 // Enemy functions
-void InitEnemy(Enemy* enemy, EnemyType type, Vector3 position, int level);
-void UpdateEnemy(Enemy* enemy, Vector3 playerPosition, float deltaTime, bool canSeePlayer);
-void DrawEnemy(Enemy* enemy, Camera camera);
-void UnloadEnemy(Enemy* enemy);
-void EnemyTakeDamage(Enemy* enemy, int damage);
-bool EnemyAttack(Enemy* enemy, Vector3 playerPosition, float playerRadius, int* damageDealt);
+void LoadEnemyModels(void);
+void UnloadEnemyModels(void);
+void InitEnemy(EnemyPool* pool, int slot, EnemyType type, Vector3 position, int level);
+void UpdateEnemySight(EnemyPool* pool, const FieldOfView* fov);
+void UpdateEnemies(EnemyPool* pool, Dungeon* dungeon, const FlowField* flowField, Vector3 playerPosition,
+                   float deltaTime);
+void RecordEnemies(const EnemyPool* pool, SceneList* scene);
+void EnemyTakeDamage(EnemyPool* pool, int slot, int damage);
+bool EnemyAttack(EnemyPool* pool, Dungeon* dungeon, int slot, Vector3 playerPosition, float playerRadius,
+                 int* damageDealt);
+Vector3 GetEnemyPosition(const EnemyPool* pool, int slot);
+bool IsEnemyAwake(const EnemyPool* pool, int slot);
 int GetRandomEnemyLoot(Enemy* enemy);
 
 #endif // ENEMY_H
@@ -0,0 +1,33 @@
+#ifndef FIELD_OF_VIEW_H
+#define FIELD_OF_VIEW_H
+
+#include "raylib.h"
+#include "dungeon.h"
+#include <stdint.h>
+
+#define FOV_RADIUS 16                   // Tiles; covers every archetype's detection range
+
+// Tiles the player can see, as one bit per tile. Recomputed with recursive
+// shadowcasting whenever the player steps onto another tile, so checking
+// whether an enemy can see the player is a bit test rather than a ray.
+typedef struct {
+    int width;
+    int height;
+    int capacity;                       // Tiles the bitset holds
+    int originX;                        // Player tile it was cast from, -1 when there is none
+    int originZ;
+    uint32_t* visible;                  // Bit x * height + z set when the tile is in view
+} FieldOfView;
+
+// Field of view functions
+void UnloadFieldOfView(FieldOfView* fov);
+void ResetFieldOfView(FieldOfView* fov);
+bool UpdateFieldOfView(FieldOfView* fov, Dungeon* dungeon, Vector3 origin);
+bool IsTileVisible(const FieldOfView* fov, int x, int z);
+bool IsPositionVisible(const FieldOfView* fov, Vector3 position);
+
+// Walk the tiles a straight line crosses between two points (grid DDA).
+// Returns false if any tile after the first blocks sight.
+bool HasLineOfSight(Dungeon* dungeon, Vector3 from, Vector3 to);
+
+#endif // FIELD_OF_VIEW_H
@@ -0,0 +1,33 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "raylib.h"
+#include "dungeon.h"
+
+#define FLOW_FIELD_RADIUS 24            // Steps from the player's tile the field reaches
+#define FLOW_FIELD_UNREACHED 0xFFFF
+
+// Direction toward the player from every open tile within reach of the
+// player's tile, shared by all chasing enemies. It is rebuilt with a
+// breadth-first search whenever the player steps onto another tile. Only
+// the tiles the previous search reached are cleared, so a rebuild costs
+// the activity area rather than the whole level.
+typedef struct {
+    int width;
+    int height;
+    int capacity;                       // Tiles the arrays hold
+    int targetX;                        // Player tile the field leads to, -1 when there is none
+    int targetZ;
+    unsigned short* distance;           // Steps to the target per tile, indexed [x * height + z]
+    int* next;                          // Neighbour one step closer, -1 at the target or out of reach
+    int* reached;                       // Tiles the last search reached, in search order
+    int reachedCount;
+} FlowField;
+
+// Flow field functions
+void UnloadFlowField(FlowField* field);
+void ResetFlowField(FlowField* field);
+bool UpdateFlowField(FlowField* field, Dungeon* dungeon, Vector3 target);
+bool SampleFlowField(const FlowField* field, float x, float z, float* directionX, float* directionZ);
+
+#endif // FLOW_FIELD_H
@@ -5,19 +5,37 @@
 #include "dungeon.h"
 #include "player.h"
 #include "enemy.h"
+#include "spawner.h"
+#include "director.h"
 #include "item.h"
+#include "ecs.h"
+#include "spatial.h"
+#include "input.h"
+#include "render_queue.h"
 
 // Game state enumeration
 typedef enum {
+    LOADING,
     TITLE_SCREEN,
     GAMEPLAY,
     GAME_OVER,
     VICTORY
 } GameStateEnum;
 
+// Startup work deferred past the first frame, advanced one stage per tick
+// while the title screen shows
+typedef enum {
+    WARMUP_START,                       // Nothing requested yet
+    WARMUP_ASSETS,                      // Dungeon files decoding on the loader workers
+    WARMUP_SHARED,                      // HUD textures, entity storage and shared models
+    WARMUP_LEVEL,                       // The first level
+    WARMUP_DONE
+} WarmupStage;
+
 // Game state structure
 typedef struct GameState {
     GameStateEnum currentState;
+    WarmupStage warmup;
     int screenWidth;
     int screenHeight;
     
@@ -25,14 +43,17 @@ typedef struct GameState {
     Player* player;
     Dungeon* dungeon;
     
-    // Enemy management
-    Enemy* enemies;
-    int enemyCount;
-    int maxEnemies;
+    // Entities and the systems run over them each tick
+    World world;
+    SpatialHash spatial;                // Enemies and items by cell, rebuilt every tick
+    FlowField flowField;                // Paths to the player, rebuilt when they change tile
+    FieldOfView fieldOfView;            // Tiles the player sees, recast when they change tile
     
-    // Item management
-    Item* items;
-    int itemCount;
+    // Enemy management - the world holds an entity per enemy, the pool
+    // their simulation state
+    EnemyPool enemyPool;
+    SpawnDirector director;             // Keeps awake enemies inside the frame budget
+    int maxEnemies;
     int maxItems;
     
     // Game assets
@@ -43,6 +64,9 @@ typedef struct GameState {
     // Game camera
     Camera camera;
     
+    // Input for the current simulation tick
+    InputFrame input;
+    
     // Game settings
     float gameTime;
     int currentLevel;
@@ -54,8 +78,9 @@ typedef struct GameState {
 void LoadGameAssets(GameState* gameState);
 void UnloadGameAssets(GameState* gameState);
 void UpdateGame(GameState* gameState, float deltaTime);
+void DrawLoadingScreen(GameState* gameState);
 void DrawTitleScreen(GameState* gameState);
-void DrawGameplay(GameState* gameState);
+void DrawGameplayHUD(GameState* gameState);
 void DrawGameOver(GameState* gameState);
 void DrawVictory(GameState* gameState);
 
@@ -0,0 +1,36 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+
+// Game actions the simulation reacts to
+typedef enum {
+    INPUT_MOVE_FORWARD,
+    INPUT_MOVE_BACK,
+    INPUT_STRAFE_LEFT,
+    INPUT_STRAFE_RIGHT,
+    INPUT_JUMP,
+    INPUT_ATTACK,
+    INPUT_INTERACT,
+    INPUT_PAUSE,
+    INPUT_CONFIRM,
+    INPUT_RESTART,
+    INPUT_ACTION_COUNT
+} InputAction;
+
+// Input for one simulation tick. Presses and mouse movement are latched
+// across render frames until a tick consumes them, so nothing is lost or
+// repeated when the render rate differs from the tick rate.
+typedef struct {
+    unsigned int down;      // Bit per InputAction held this tick
+    unsigned int pressed;   // Bit per InputAction pressed since the last tick
+    Vector2 mouseDelta;     // Mouse movement since the last tick
+} InputFrame;
+
+// Input functions
+void PollInput(InputFrame* pending);
+InputFrame ConsumeInput(InputFrame* pending);
+bool InputDown(const InputFrame* input, InputAction action);
+bool InputPressed(const InputFrame* input, InputAction action);
+
+#endif // INPUT_H
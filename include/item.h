@@ -2,6 +2,8 @@
 #define ITEM_H
 
 #include "raylib.h"
+#include "render_queue.h"
+#include "assets.h"
 
 // Item types
 typedef enum {
@@ -12,7 +14,8 @@ typedef enum {
     ITEM_POTION,
     ITEM_SCROLL,
     ITEM_KEY,
-    ITEM_GOLD
+    ITEM_GOLD,
+    ITEM_TYPE_COUNT
 } ItemType;
 
 // Weapon types
@@ -21,7 +24,8 @@ typedef enum {
     WEAPON_AXE,
     WEAPON_MACE,
     WEAPON_STAFF,
-    WEAPON_BOW
+    WEAPON_BOW,
+    WEAPON_COUNT
 } WeaponType;
 
 // Armor types
@@ -29,7 +33,8 @@ typedef enum {
     ARMOR_HELMET,
     ARMOR_CHEST,
     ARMOR_GLOVES,
-    ARMOR_BOOTS
+    ARMOR_BOOTS,
+    ARMOR_COUNT
 } ArmorType;
 
 // Potion types
@@ -38,14 +43,49 @@ typedef enum {
     POTION_MANA,
     POTION_STRENGTH,
     POTION_SPEED,
-    POTION_INVISIBILITY
+    POTION_INVISIBILITY,
+    POTION_COUNT
 } PotionType;
 
+#define ITEM_MAX_SUBTYPES 8
+#define ITEM_ICON_SIZE 40
+
+// Item definitions, one per row of data/items.def
+typedef enum {
+#define ITEM_DEF(id, ...) ITEM_DEF_##id,
+#define ITEM_DEFAULT(id, ...) ITEM_DEF_##id,
+#include "../data/items.def"
+#undef ITEM_DEF
+#undef ITEM_DEFAULT
+    ITEM_DEF_COUNT
+} ItemDefId;
+
+// Everything an item of one type and subtype starts with, before level
+// scaling
+typedef struct {
+    const char* name;
+    const char* description;
+    MeshShape shape;                    // Placeholder mesh the item is drawn with
+    Vector3 shapeSize;
+    int minDamage;
+    int maxDamage;
+    int armor;
+    int strength;
+    int dexterity;
+    int intelligence;
+    int effectValue;
+    float effectDuration;
+    int value;
+    Color color;
+} ItemDef;
+
+extern const ItemDef itemDefs[ITEM_DEF_COUNT];
+
 // Item structure
 typedef struct Item {
     // Basic item properties
-    char name[64];
-    char description[256];
+    const char* name;                   // Points into itemDefs
+    const char* description;
     ItemType type;
     int subType;
     int level;
@@ -65,8 +105,8 @@ typedef struct Item {
     int effectValue;
     float effectDuration;
     
-    // Visual representation
-    Model model;
+    // Visual representation, shared by every item of the definition
+    const Model* model;
     Texture2D icon;
     Color color;
     
@@ -79,11 +119,13 @@ typedef struct Item {
 } Item;
 
 // Item functions
+void LoadItemModels(void);
+void UnloadItemModels(void);
+const ItemDef* GetItemDef(ItemType type, int subType);
 void InitItem(Item* item, ItemType type, int subType, int level, Vector3 position);
 void UpdateItem(Item* item, float deltaTime);
-void DrawItem(Item* item);
+void RecordItem(const Item* item, unsigned int id, SceneList* scene);
 void DrawItemIcon(Item* item, Rectangle bounds);
-void UnloadItem(Item* item);
 Item GenerateRandomItem(int level);
 const char* GetItemName(Item* item);
 const char* GetItemDescription(Item* item);
@@ -0,0 +1,43 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include "raylib.h"
+#include <stdatomic.h>
+
+#define JOB_MAX_WORKERS 16              // Threads including the one that starts the system
+#define JOB_DEQUE_CAPACITY 1024         // Jobs queued per thread; a power of two
+#define JOB_MAX_SPLITS 64               // Jobs one ParallelFor splits its range into at most
+
+// Work on the index range [begin, end) of whatever the context describes
+typedef void (*JobFunction)(void* context, int begin, int end);
+
+// Jobs of a batch not yet finished. A counter can be shared by several
+// batches and waited on once.
+typedef struct {
+    atomic_int pending;
+} JobCounter;
+
+// A job belongs to its caller until the counter it was run with drops to
+// zero, so arrays of them can live on the stack
+typedef struct {
+    JobFunction function;
+    void* context;
+    int begin;
+    int end;
+    JobCounter* counter;                // Set by RunJobs
+} Job;
+
+// Work-stealing job system. Every thread has its own deque: it pushes and
+// pops its jobs at one end, and idle threads steal from the other. The
+// thread that starts the system is one of the workers and helps with jobs
+// whenever it waits on a counter, as do jobs that start jobs of their own,
+// so work that depends on other work simply waits for it. Without
+// InitJobSystem, and on threads outside the system, jobs run inline.
+void InitJobSystem(int workerCount);
+void UnloadJobSystem(void);
+int GetJobWorkerCount(void);
+void RunJobs(Job* jobs, int count, JobCounter* counter);
+void WaitForJobs(JobCounter* counter);
+void ParallelFor(int count, int grain, JobFunction function, void* context);
+
+#endif // JOBS_H
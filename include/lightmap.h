@@ -0,0 +1,28 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include "raylib.h"
+#include "dungeon.h"
+
+// Lighting bake parameters
+#define LIGHTMAP_AMBIENT 0.35f          // Base light level for unlit tiles
+#define LIGHTMAP_AO_STRENGTH 0.06f      // Darkening per neighbouring wall tile
+#define LIGHTMAP_COLUMN_GRAIN 4         // Columns per bake job at least
+
+// Bake ambient occlusion and static torch light into dungeon->bakedLight.
+// The tile grid is split by columns across the job system.
+void BakeDungeonLighting(Dungeon* dungeon);
+
+// Free the baked lighting buffer
+void UnloadDungeonLighting(Dungeon* dungeon);
+
+// Get the baked light colour for a tile (WHITE if nothing is baked)
+Color GetTileLight(Dungeon* dungeon, int x, int y);
+
+// Check line of sight between two tiles through the tile grid
+bool TileLineOfSight(Dungeon* dungeon, int x0, int y0, int x1, int y1);
+
+// Light a torch casts on a tile, ignoring walls (0 outside its radius)
+float TorchLightAmount(const TorchLight* torch, int x, int y);
+
+#endif // LIGHTMAP_H
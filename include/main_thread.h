@@ -0,0 +1,22 @@
+#ifndef MAIN_THREAD_H
+#define MAIN_THREAD_H
+
+#include "raylib.h"
+
+#define MAIN_THREAD_MAX_WAITING 16      // Requests queued at once; further callers wait for room
+
+// Work run on the main thread, which owns the window and the GL context
+typedef void (*MainThreadFunction)(void* context);
+
+// Commands for the main thread. The simulation runs on a thread of its
+// own, so whatever it needs created or released through raylib or the
+// asset registry - which is not thread-safe either - is handed over with
+// RunOnMainThread. The caller blocks until the main thread has run it
+// between two frames, so the context can live on its stack. Called on the
+// main thread, or before InitMainThread, the function just runs in place.
+void InitMainThread(void);
+bool IsMainThread(void);
+void RunOnMainThread(MainThreadFunction function, void* context);
+int RunMainThreadWork(void);
+
+#endif // MAIN_THREAD_H
@@ -0,0 +1,99 @@
+#ifndef NAV_GRAPH_H
+#define NAV_GRAPH_H
+
+#include "raylib.h"
+#include "dungeon.h"
+
+#define NAV_CLUSTER_SIZE 32             // Side of the blocks corridor tiles are grouped in
+#define NAV_MAX_CLUSTER_AREA (NAV_CLUSTER_SIZE * NAV_CLUSTER_SIZE)
+#define NAV_LONG_ENTRANCE 6             // Border runs at least this long get an entrance at each end
+#define NAV_STRAIGHT_COST 10
+#define NAV_DIAGONAL_COST 14
+#define NAV_CACHE_GRAIN 8               // Entrances per cache job at least
+#define NAV_LANDMARKS 8                 // Entrances whose costs to every other bound the route search
+#define NAV_UNREACHED 0xFFFF
+#define NAV_NO_STEP 0xFF
+
+// A room, or a piece of corridor inside one NAV_CLUSTER_SIZE block. Every
+// cluster is connected, and its entrances are numbered contiguously.
+typedef struct {
+    int minX;                           // Bounding box in tiles
+    int minZ;
+    int width;
+    int height;
+    int firstNode;
+    int nodeCount;
+} NavCluster;
+
+// Entrance tile on a cluster's border, paired with a tile of the
+// neighbouring cluster
+typedef struct {
+    int tile;                           // x * level height + z
+    int cluster;
+    int firstEdge;
+    int edgeCount;
+    int cacheOffset;                    // First of the cluster's width * height cache cells
+} NavNode;
+
+typedef struct {
+    int to;
+    int cost;
+} NavEdge;
+
+typedef struct {
+    int priority;
+    int node;
+} NavHeapEntry;
+
+// Two-level abstraction of the level for long paths (HPA*). Rooms and
+// corridor pieces are clusters; entrances between them are the nodes of an
+// abstract graph whose edges are single steps across a border or cached
+// path costs inside a cluster. Each entrance also caches, for every tile of
+// its cluster, the cost to reach it and the first step there, so refining
+// the next segment of a route is a table lookup. Costs from a few spread
+// out landmark entrances give the route search tighter lower bounds than
+// straight-line distance through winding corridors.
+typedef struct NavGraph {
+    int width;                          // Level size in tiles
+    int height;
+    int* clusterOfTile;                 // -1 for closed tiles
+
+    NavCluster* clusters;
+    int clusterCount;
+    NavNode* nodes;
+    int nodeCount;
+    NavEdge* edges;
+    int edgeCount;
+
+    unsigned short* cacheDistance;      // Per entrance and cluster tile: cost to the entrance
+    unsigned char* cacheStep;           // Per entrance and cluster tile: direction of the next tile
+    int cacheSize;
+    int* landmarkCost;                  // Per entrance and landmark: abstract cost between them
+
+    // Scratch for queries, reused between calls
+    int* cost;
+    int* estimate;                      // Lower bound on the remaining cost, set when first reached
+    int* parent;
+    unsigned* visited;                  // Search id that last reached each node
+    unsigned searchId;
+    NavHeapEntry* heap;
+    int heapCapacity;
+    int* route;
+    unsigned short localDistance[NAV_MAX_CLUSTER_AREA];
+    unsigned char localStep[NAV_MAX_CLUSTER_AREA];
+    NavHeapEntry localHeap[NAV_MAX_CLUSTER_AREA * 8];   // Query heap; cache jobs bring their own
+} NavGraph;
+
+// Build the level's navigation graph once its layout is final
+void BuildNavGraph(Dungeon* dungeon);
+
+// Free the navigation graph
+void UnloadNavGraph(Dungeon* dungeon);
+
+// Centre of the next tile on the shortest route between two positions,
+// searching the abstract graph and refining only the first segment.
+// Returns false when either end is closed, they share a tile, or no route
+// exists.
+bool FindNavStep(Dungeon* dungeon, Vector3 from, Vector3 to, Vector3* step);
+
+#endif // NAV_GRAPH_H
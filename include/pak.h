@@ -0,0 +1,87 @@
+#ifndef PAK_H
+#define PAK_H
+
+#include "raylib.h"
+#include "assets.h"
+#include <stdint.h>
+
+// Baked asset archive written by tools/bake_assets and memory-mapped by
+// the game. Layout: header, entry data (each block PAK_ALIGNMENT aligned),
+// then the table of contents sorted by name.
+#define PAK_MAGIC 0x4B415043u           // "CPAK"
+#define PAK_VERSION 3
+#define PAK_NAME_LENGTH 96
+#define PAK_ALIGNMENT 16
+#define PAK_NO_TEXTURE 0xFFFFFFFFu
+#define PAK_DEFAULT_PATH "assets/craven.pak"
+
+// Kinds of archive entry
+typedef enum {
+    PAK_ENTRY_TEXTURE = 1,
+    PAK_ENTRY_MODEL = 2
+} PakEntryType;
+
+// Archive header
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t tocOffset;
+} PakHeader;
+
+// Table of contents entry. The name is the runtime path of the source
+// file the entry replaces, so lookups use the same keys as the registry.
+typedef struct {
+    char name[PAK_NAME_LENGTH];
+    uint32_t type;
+    uint32_t offset;                    // From the start of the archive
+    uint32_t size;
+    union {
+        struct {
+            uint32_t width;
+            uint32_t height;
+            uint32_t format;            // raylib PixelFormat
+            uint32_t mipmaps;           // Levels stored back to back, largest first
+        } texture;
+        struct {
+            uint32_t meshCount;         // PakMesh records after the PakModel header
+            uint32_t textureEntry;      // TOC index of the diffuse texture, or PAK_NO_TEXTURE
+            uint32_t reserved[2];
+        } model;
+    };
+} PakEntry;
+
+// Header at the start of a model entry's data, followed by the PakMesh
+// records. Positions are stored as 16-bit fractions of the model's bounds,
+// and normals stretched by the bounds size so the scale in the model
+// transform leaves them pointing the right way.
+typedef struct {
+    float boundsMin[3];
+    float boundsSize[3];
+} PakModel;
+
+#define PAK_MESH_FLOAT_TEXCOORDS 1u     // Texcoords outside [0, 1] are kept as floats
+
+// Mesh inside a model entry: separate quantized streams followed by
+// 16-bit indices, in vertex cache order. Offsets are relative to the
+// entry's data.
+typedef struct {
+    uint32_t vertexCount;
+    uint32_t indexCount;                // 0 for non-indexed meshes
+    uint32_t flags;                     // PAK_MESH_* bits
+    uint32_t positionOffset;            // 4 x uint16 per vertex (x, y, z, padding)
+    uint32_t texcoordOffset;            // 2 x uint16 (unorm), or 2 x float
+    uint32_t normalOffset;              // 4 x int8 per vertex (x, y, z, padding), snorm, stretched by the bounds
+    uint32_t indexOffset;
+    uint32_t reserved;
+} PakMesh;
+
+// Runtime archive functions
+bool OpenAssetPak(const char* path);
+void CloseAssetPak(void);
+const PakEntry* FindPakEntry(const char* name, PakEntryType type);
+void PrefetchPakEntry(const PakEntry* entry);
+Texture2D LoadPakTexture(const PakEntry* entry);
+Model LoadPakModel(const PakEntry* entry, AssetHandle* texture);
+
+#endif // PAK_H
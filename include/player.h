@@ -3,6 +3,7 @@
 
 #include "raylib.h"
 #include "item.h"
+#include "input.h"
 
 // Player stats
 typedef struct {
@@ -74,7 +75,8 @@ typedef struct Player {
 
 // Player functions
 void InitPlayer(Player* player);
-void UpdatePlayer(Player* player, float deltaTime);
+void ResetPlayer(Player* player);
+void UpdatePlayer(Player* player, const InputFrame* input, float deltaTime);
 void DrawPlayer(Player* player);
 void UnloadPlayer(Player* player);
 void PlayerAttack(Player* player);
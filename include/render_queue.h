@@ -0,0 +1,108 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "raylib.h"
+
+// Render passes, in the order they are flushed
+typedef enum {
+    RENDER_PASS_OPAQUE,     // 3D models, sorted by state then front-to-back
+    RENDER_PASS_OVERLAY     // 2D overlays projected from 3D, drawn after the scene
+} RenderPass;
+
+// Kinds of draw command
+typedef enum {
+    RENDER_CMD_MODEL,
+    RENDER_CMD_HEALTH_BAR
+} RenderCommandType;
+
+// Sort key layout (most significant first):
+//   pass (4 bits) | material (16 bits) | mesh (16 bits) | depth (28 bits)
+#define RENDER_KEY_PASS_SHIFT 60
+#define RENDER_KEY_MATERIAL_SHIFT 44
+#define RENDER_KEY_MESH_SHIFT 28
+#define RENDER_KEY_DEPTH_BITS 28
+#define RENDER_DEPTH_SCALE 256.0f   // Depth steps per world unit
+#define RENDER_MATERIAL_MAX 0xFFFF  // Dense material ids that fit the key
+
+// A single queued draw
+typedef struct {
+    RenderCommandType type;
+    const Model* model;
+    Vector3 position;
+    Vector3 rotationAxis;
+    float rotationAngle;
+    Vector3 scale;
+    Color tint;
+    float value;            // Fill ratio for health bars
+} RenderCommand;
+
+// Per-frame submission counters
+typedef struct {
+    int commands;
+    int modelDraws;
+    int overlayDraws;
+    int materialBinds;          // Shader and texture binds made
+    int materialBindsSkipped;   // Draws that kept the bound shader and textures
+    int meshBinds;              // Vertex array binds made
+    int meshBindsSkipped;       // Draws that kept the bound vertex array
+    double sortTime;
+    double flushTime;
+} RenderStats;
+
+// Render queue - systems push commands, the queue sorts and draws them
+typedef struct {
+    RenderCommand* commands;
+    unsigned long long* keys;
+    int* order;             // Command indices in sorted order
+    unsigned long long* sortKeys;
+    int* sortScratch;       // Radix sort ping-pong buffers
+    unsigned long long* sortKeysScratch;
+    int count;
+    int capacity;
+    Camera camera;
+    RenderStats stats;
+
+    // Dense material ids by (shader id, diffuse texture id), kept across
+    // frames so a material keeps its place in the sort
+    unsigned long long* materialPairs;  // Pair held by each slot, 0 when empty
+    unsigned short* materialIds;
+    int materialSlots;      // Table size, a power of two
+    int materialCount;      // Ids handed out so far
+} RenderQueue;
+
+// A moving model recorded by the simulation, queued later by the renderer.
+// The id stays with the same object from one recording to the next, so its
+// pose can be blended between them.
+typedef struct {
+    unsigned int id;        // Entity handle of the object
+    const Model* model;     // Shared; outlives every recording
+    Vector3 position;
+    float rotation;         // Degrees about Y
+    Color tint;
+    float healthBar;        // Fill of the health bar above it, 0 for none
+    float barHeight;        // Height of the health bar above the position
+} SceneModel;
+
+// Models recorded for one tick, grown as needed
+typedef struct {
+    SceneModel* models;
+    int count;
+    int capacity;
+} SceneList;
+
+// Render queue functions
+void InitRenderQueue(RenderQueue* queue, int capacity);
+void UnloadRenderQueue(RenderQueue* queue);
+void BeginRenderQueue(RenderQueue* queue, Camera camera);
+void QueueModel(RenderQueue* queue, const Model* model, Vector3 position, Vector3 rotationAxis,
+                float rotationAngle, Vector3 scale, Color tint);
+void QueueHealthBar(RenderQueue* queue, Vector3 position, float ratio);
+void FlushRenderQueue(RenderQueue* queue);
+
+// Scene list functions
+void ClearSceneList(SceneList* scene);
+SceneModel* RecordSceneModel(SceneList* scene, unsigned int id, const Model* model, Vector3 position,
+                             float rotation, Color tint);
+void UnloadSceneList(SceneList* scene);
+
+#endif // RENDER_QUEUE_H
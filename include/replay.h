@@ -0,0 +1,69 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "raylib.h"
+#include "game.h"
+#include <stdint.h>
+
+// Recorded input file: header, then one encoded input frame per tick.
+// Each tick is a varint mask of the fields that differ from the previous
+// tick, followed by those fields as LEB128 varints, so an idle tick takes
+// one byte and held keys cost nothing until they are released.
+#define REPLAY_MAGIC 0x50525643u        // "CVRP"
+#define REPLAY_VERSION 1
+#define REPLAY_MOUSE_STEPS 64.0f        // Mouse deltas are stored in 1/64 pixel steps
+#define REPLAY_TICKS_PER_FRAME 64       // Ticks a replay runs per drawn frame
+#define REPLAY_INITIAL_CAPACITY 4096    // Bytes of tick data reserved when recording starts
+
+// Fields present in a tick's record
+#define REPLAY_FIELD_DOWN 1u            // Held actions, XOR the previous tick's
+#define REPLAY_FIELD_PRESSED 2u         // Actions pressed this tick
+#define REPLAY_FIELD_MOUSE_X 4u         // Mouse steps, zigzag, minus the previous tick's
+#define REPLAY_FIELD_MOUSE_Y 8u
+
+// File header
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seed;                      // Random seed the session started from
+    uint32_t tickCount;
+    uint32_t stateHash;                 // HashGameState after the last tick
+    uint32_t dataSize;                  // Bytes of tick data after the header
+} ReplayHeader;
+
+typedef enum {
+    REPLAY_OFF,
+    REPLAY_RECORDING,
+    REPLAY_PLAYING,
+    REPLAY_FINISHED
+} ReplayMode;
+
+// A session being recorded or played back. Recording and playback both
+// start on the first gameplay tick; everything before it is driven only
+// by the seed.
+typedef struct {
+    ReplayMode mode;
+    const char* path;
+    ReplayHeader header;
+    unsigned char* data;
+    int size;
+    int capacity;
+    int cursor;                         // Read position during playback
+    int ticks;                          // Ticks recorded or played so far
+    bool failed;                        // A tick could not be recorded; the file would be out of sync
+    unsigned int previousDown;
+    int previousMouseX;                 // Previous tick's mouse steps
+    int previousMouseY;
+    double startTime;                   // When playback started, for the throughput report
+} Replay;
+
+// Replay functions
+bool StartRecording(Replay* replay, const char* path, unsigned int seed);
+bool LoadReplay(Replay* replay, const char* path);
+void RecordReplayTick(Replay* replay, InputFrame* input);
+bool NextReplayTick(Replay* replay, InputFrame* input);
+bool FinishReplay(Replay* replay, unsigned int stateHash);
+void UnloadReplay(Replay* replay);
+unsigned int HashGameState(GameState* gameState);
+
+#endif // REPLAY_H
@@ -0,0 +1,41 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include "raylib.h"
+
+// Dynamic resolution limits and controller tuning
+#define RES_MIN_SCALE 0.5f
+#define RES_MAX_SCALE 1.0f
+#define RES_SMOOTHING 0.1f              // Weight of the newest frame in the moving average
+#define RES_DOWN_THRESHOLD 0.95f        // Shrink once the average passes this share of the budget
+#define RES_UP_THRESHOLD 0.75f          // Grow only once the average drops below this share
+#define RES_DOWN_FRAMES 6               // Consecutive frames over budget before shrinking
+#define RES_UP_FRAMES 45                // Consecutive frames under budget before growing
+#define RES_MAX_STEP 0.1f               // Largest scale change in one adjustment
+#define RES_UP_STEP 0.05f
+
+// Offscreen scene target whose rendered area follows the frame time.
+// The texture is allocated at full size once; lower scales render into
+// its bottom-left corner so changing scale never reallocates.
+typedef struct {
+    RenderTexture2D target;
+    int fullWidth;
+    int fullHeight;
+    int renderWidth;            // Size of the area the scene is rendered into
+    int renderHeight;
+    float scale;
+    float targetFrameTime;      // Frame budget in seconds
+    float averageFrameTime;     // Smoothed measured frame cost
+    int framesOverBudget;
+    int framesUnderBudget;
+} DynamicResolution;
+
+// Dynamic resolution functions
+void InitDynamicResolution(DynamicResolution* resolution, int width, int height, int targetFps);
+void UnloadDynamicResolution(DynamicResolution* resolution);
+void UpdateDynamicResolution(DynamicResolution* resolution, float frameTime, float busyTime);
+void BeginSceneRender(DynamicResolution* resolution);
+void EndSceneRender(DynamicResolution* resolution);
+void DrawSceneUpscaled(DynamicResolution* resolution);
+
+#endif // RESOLUTION_H
@@ -0,0 +1,18 @@
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include "raylib.h"
+
+#define SHADER_CACHE_DIR "cache/shaders"
+#define SHADER_CACHE_MAX_LOCATIONS 32   // raylib's shader location array size
+
+// Shader programs built through a disk cache of linked GL program
+// binaries, keyed by the sources and the driver. WarmUpShader draws with
+// a program once offscreen, so the driver's deferred compile happens at
+// load time rather than on the first frame that uses it.
+void InitShaderCache(void);
+void UnloadShaderCache(void);
+Shader LoadShaderCached(const char* vsCode, const char* fsCode);
+void WarmUpShader(Shader shader);
+
+#endif // SHADER_CACHE_H
@@ -0,0 +1,27 @@
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include "raylib.h"
+#include "dungeon.h"
+
+// Maximum dynamic casters considered per light
+#define SHADOW_MAX_CASTERS_PER_LIGHT 64
+
+// A moving object that blocks torch light (player, enemies)
+typedef struct {
+    Vector3 position;
+    float radius;
+} ShadowCaster;
+
+// Build the cached static shadow map of every torch. The static part is
+// only rendered here, at level load.
+void BuildTorchShadowMaps(Dungeon* dungeon);
+
+// Free the shadow atlas and the dynamic shadow buffer
+void UnloadTorchShadowMaps(Dungeon* dungeon);
+
+// Re-render dynamic casters for the lights whose radius contains one,
+// on top of their cached static maps. Returns the number of lights updated.
+int UpdateTorchShadows(Dungeon* dungeon, const ShadowCaster* casters, int casterCount);
+
+#endif // SHADOW_H
@@ -0,0 +1,92 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "raylib.h"
+#include "game.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Fixed simulation rate
+#define SIM_TICK_RATE 60
+#define SIM_TICK_TIME (1.0f / SIM_TICK_RATE)
+#define SIM_MAX_TICKS_PER_FRAME 8       // Drop time instead of spiralling after a stall
+#define SIM_SNAP_DISTANCE 2.0f          // Teleports further than this are not interpolated
+#define SIM_SNAPSHOT_COUNT 4            // Two being drawn, one being written, one waiting
+#define SIM_SNAPSHOT_FRESH 0x100        // Set on the waiting slot until the renderer takes it
+
+// Everything the renderer needs from one tick, copied out of the
+// simulation so a frame never reads state the simulation is changing.
+// Shared models and textures are referenced rather than copied; they stay
+// resident until shutdown.
+typedef struct {
+    double time;                        // When the tick was due, on the GetTime clock
+    GameState view;                     // What the screens and HUD read; its pointers lead into this snapshot only
+    Player player;                      // The inventory points at the copy below
+    Dungeon level;                      // Tiles, lighting and torches as drawn; the rest is cleared
+    SceneList scene;                    // Enemies, entities and ground items
+    int enemyTiers[ENEMY_LOD_COUNT];    // Awake enemies per update tier, for the overlay
+    int awakeEnemies;
+
+    // Storage behind the copies, grown as needed
+    Item* inventory;
+    int inventoryCapacity;
+    TileType* tiles;
+    int tileCapacity;
+    TileType** tileColumns;
+    int columnCapacity;
+    Color* light;
+    int lightCapacity;
+    TorchLight* torches;
+    int torchCapacity;
+} SimSnapshot;
+
+// Fixed-timestep clock and the handoff between the simulation thread and
+// the renderer. Each slot is always held by exactly one side: the
+// simulation fills the one it is writing and swaps it into ready; the
+// renderer swaps the older of its two drawn slots back for the ready one
+// when it is fresh. With two slots drawn, one written and one waiting,
+// neither side ever blocks the other or sees a slot change under it.
+typedef struct {
+    // Simulation thread
+    double accumulator;
+    int writing;                        // Slot being filled
+
+    // Newest finished slot, with SIM_SNAPSHOT_FRESH until the renderer takes it
+    atomic_int ready;
+    SimSnapshot snapshots[SIM_SNAPSHOT_COUNT];
+
+    // Renderer
+    int drawn[2];                       // Previous and latest slots
+    int taken;                          // Snapshots taken so far (capped at 2)
+
+    // Input and scene cost the renderer hands to the simulation
+    pthread_mutex_t mailbox;
+    InputFrame pendingInput;
+    float sceneTime;
+    int sceneEnemies;
+    bool sceneReported;
+} SimClock;
+
+// The pair of snapshots a frame draws and the blend between them
+typedef struct {
+    SimSnapshot* previous;
+    SimSnapshot* latest;
+    float alpha;
+    Camera camera;                      // Blended
+} SimView;
+
+// Simulation thread
+void InitSimClock(SimClock* clock);
+void UnloadSimClock(SimClock* clock);
+int AdvanceSimClock(SimClock* clock, float elapsed);
+void PublishSimSnapshot(SimClock* clock, GameState* gameState, double time);
+InputFrame ConsumeSimInput(SimClock* clock);
+bool TakeSceneCost(SimClock* clock, float* seconds, int* enemies);
+
+// Renderer
+bool TakeSimView(SimClock* clock, double now, SimView* view);
+void DrawInterpolatedScene(const SimView* view, RenderQueue* queue);
+void PollSimInput(SimClock* clock);
+void ReportSceneCost(SimClock* clock, float seconds, int enemies);
+
+#endif // SIM_H
@@ -0,0 +1,45 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include "raylib.h"
+#include "ecs.h"
+
+#define SPATIAL_CELL_SIZE 2.0f          // Tiles per cell side
+#define SPATIAL_MAX_RESULTS 256         // Handles one query call site gathers at most
+
+// Entity position filed under its cell
+typedef struct {
+    Entity entity;
+    Vector3 position;
+    unsigned kind;                      // ComponentMask bits the entity was filed under
+} SpatialEntry;
+
+// Uniform grid of tile cells over the level, rebuilt every tick. Entries
+// are inserted unsorted, then bucketed by cell with a counting sort, so a
+// query visits only the cells its shape overlaps.
+typedef struct {
+    int cellsX;
+    int cellsZ;
+    int* cellStart;                     // cellsX * cellsZ + 1 offsets into entries
+    int cellCapacity;
+    SpatialEntry* entries;              // Sorted by cell after EndSpatialHash
+    SpatialEntry* pending;              // Inserted this tick, not yet sorted
+    int* entryCells;
+    int count;
+    int capacity;
+} SpatialHash;
+
+// Spatial hash functions
+void InitSpatialHash(SpatialHash* hash, int capacity);
+void UnloadSpatialHash(SpatialHash* hash);
+void BeginSpatialHash(SpatialHash* hash, int width, int height);
+void InsertSpatialEntity(SpatialHash* hash, Entity entity, Vector3 position, unsigned kind);
+void EndSpatialHash(SpatialHash* hash);
+int QuerySpatialRadius(const SpatialHash* hash, Vector3 center, float radius, unsigned kind,
+                       Entity* results, int maxResults);
+int QuerySpatialCone(const SpatialHash* hash, Vector3 origin, Vector3 direction, float range, float minDot,
+                     unsigned kind, Entity* results, int maxResults);
+int QuerySpatialBox(const SpatialHash* hash, Vector2 min, Vector2 max, unsigned kind,
+                    Entity* results, int maxResults);
+
+#endif // SPATIAL_H
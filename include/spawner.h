@@ -0,0 +1,30 @@
+#ifndef SPAWNER_H
+#define SPAWNER_H
+
+#include "raylib.h"
+#include "enemy.h"
+#include "dungeon.h"
+#include "spatial.h"
+
+// Difficulty budget a level's rooms are filled from
+#define SPAWN_BUDGET_BASE 12
+#define SPAWN_BUDGET_PER_LEVEL 8
+#define SPAWN_WAKE_RADIUS 16.0f         // Dormant enemies closer than this start simulating
+#define SPAWN_SAFE_DISTANCE 6.0f        // Nothing spawns this close to the level start
+#define SPAWN_MAX_WAVE_ROOMS 32         // Rooms considered when placing a wave
+
+// Enemy pool and spawner functions
+void InitEnemyPool(EnemyPool* pool, int capacity, World* world);
+void UnloadEnemyPool(EnemyPool* pool);
+void ClearEnemyPool(EnemyPool* pool);
+int SpawnEnemy(EnemyPool* pool, EnemyType type, Vector3 position, int level, bool dormant);
+void ReleaseEnemy(EnemyPool* pool, int slot);
+int GetAwakeEnemyCount(const EnemyPool* pool);
+int GetLevelSpawnBudget(int level);
+int PopulateDungeon(EnemyPool* pool, Dungeon* dungeon, int level);
+int SpawnWave(EnemyPool* pool, Dungeon* dungeon, Vector3 playerPosition, int level, int budget,
+              float minDistance, float maxDistance);
+int WakeEnemies(EnemyPool* pool, const SpatialHash* spatial, Vector3 playerPosition, float radius, int maxWakes,
+                int* waiting);
+
+#endif // SPAWNER_H
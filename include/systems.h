@@ -0,0 +1,26 @@
+#ifndef SYSTEMS_H
+#define SYSTEMS_H
+
+#include "raylib.h"
+#include "ecs.h"
+#include "game.h"
+
+// Capacities of the world's component stores besides enemies and items
+#define MAX_PROJECTILES 256
+#define MAX_PROPS 512
+
+#define PROJECTILE_RADIUS 0.15f
+#define PROJECTILE_LIFETIME 3.0f
+#define ITEM_PICKUP_RANGE 1.5f
+#define ENEMY_SEPARATION_REACH 0.5f     // Largest enemy radius; neighbours further off can't overlap
+
+// Game world functions
+void InitGameWorld(World* world, int maxEnemies, int maxItems);
+void UnloadGameWorld(World* world);
+void ClearGameWorld(World* world);
+void RebuildSpatialHash(GameState* gameState);
+Entity SpawnItemEntity(World* world, ItemType type, int subType, int level, Vector3 position);
+Entity SpawnProjectile(World* world, Vector3 position, Vector3 velocity, int damage);
+void RecordWorldEntities(World* world, SceneList* scene);
+
+#endif // SYSTEMS_H
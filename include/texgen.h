@@ -0,0 +1,41 @@
+#ifndef TEXGEN_H
+#define TEXGEN_H
+
+#include "raylib.h"
+
+#define TEXGEN_VERSION 1                // Bump whenever a generator's output changes
+#define TEXGEN_CACHE_DIR "cache/textures"
+#define TEXGEN_DEFAULT_SIZE 256
+
+// Surface patterns the generator can produce
+typedef enum {
+    TEXGEN_STONE,                       // Cobbled stone: noisy cells split by mortar
+    TEXGEN_CAVE_ROCK,                   // Ridged rock with layered strata
+    TEXGEN_CRYPT_BRICK                  // Offset courses of worn brick
+} TexGenPattern;
+
+// Which image of a generated material to produce
+typedef enum {
+    TEXGEN_ALBEDO,
+    TEXGEN_NORMAL                       // Tangent space, from the same height field
+} TexGenChannel;
+
+// Everything that determines a generated texture. Two requests with equal
+// parameters produce the same pixels, so this is also the cache key.
+typedef struct {
+    TexGenPattern pattern;
+    TexGenChannel channel;
+    int size;                           // Power of two; every pattern tiles
+    unsigned int seed;
+    Color baseColor;
+    Color accentColor;                  // Mortar, cracks and crevices
+    float featureScale;                 // Cells, brick courses or strata per tile
+    float normalStrength;
+} TexGenParams;
+
+// Texture generation. LoadGeneratedImage only allocates and touches
+// files, so the loader runs it on its worker threads.
+void GetTexGenKey(const TexGenParams* params, char* key, int size);
+Image LoadGeneratedImage(const TexGenParams* params);
+
+#endif // TEXGEN_H
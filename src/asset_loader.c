@@ -0,0 +1,497 @@
+#include "../include/asset_loader.h"
+#include "../include/pak.h"
+#include "../include/shader_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// Kinds of load job
+typedef enum {
+    LOAD_JOB_TEXTURE,
+    LOAD_JOB_MODEL,
+    LOAD_JOB_SHADER,
+    LOAD_JOB_GENERATED
+} LoadJobType;
+
+// A file read ahead of time by a worker
+typedef struct {
+    char path[ASSET_KEY_LENGTH * 2];
+    unsigned char* data;
+    int size;
+} PrefetchedFile;
+
+// One asset moving from disk to the GPU
+typedef struct LoadJob {
+    LoadJobType type;
+    AssetHandle handle;
+    char path[ASSET_KEY_LENGTH];
+    char fsPath[ASSET_KEY_LENGTH];      // Fragment shader, for shader jobs
+    Color fallback;                     // Texture used when an image fails to load
+    const PakEntry* pakEntry;           // Baked version of the asset, if the archive has one
+    TexGenParams generator;             // Generated textures only
+
+    // Worker results
+    Image image;
+    char* vsCode;
+    char* fsCode;
+    PrefetchedFile files[ASSET_LOADER_MAX_FILES];
+    int fileCount;
+
+    struct LoadJob* next;
+} LoadJob;
+
+// FIFO of jobs
+typedef struct {
+    LoadJob* head;
+    LoadJob* tail;
+} LoadJobQueue;
+
+// Loader state - queues are shared with the workers under the mutex
+static pthread_t workers[ASSET_LOADER_MAX_WORKERS];
+static LoadJob* activeJobs[ASSET_LOADER_MAX_WORKERS];
+static int workerCount = 0;
+static pthread_mutex_t loaderMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t workAvailable = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobDecoded = PTHREAD_COND_INITIALIZER;
+static LoadJobQueue queuedJobs = {0};
+static LoadJobQueue decodedJobs = {0};
+static bool quitWorkers = false;
+
+// Files handed to raylib while a model is being built on the main thread
+static PrefetchedFile* servingFiles = NULL;
+static int servingFileCount = 0;
+
+// Progress of the current batch of requests (main thread only)
+static int jobsInFlight = 0;
+static int batchRequested = 0;
+static int batchCompleted = 0;
+
+// Append a job to a queue
+static void PushJob(LoadJobQueue* queue, LoadJob* job) {
+    job->next = NULL;
+    if (queue->tail != NULL) queue->tail->next = job;
+    else queue->head = job;
+    queue->tail = job;
+}
+
+// Remove the first job from a queue, or the first one for a handle
+static LoadJob* TakeJob(LoadJobQueue* queue, AssetHandle handle) {
+    LoadJob* previous = NULL;
+    for (LoadJob* job = queue->head; job != NULL; previous = job, job = job->next) {
+        if (handle != ASSET_INVALID && job->handle != handle) continue;
+
+        if (previous != NULL) previous->next = job->next;
+        else queue->head = job->next;
+        if (queue->tail == job) queue->tail = previous;
+        job->next = NULL;
+        return job;
+    }
+    return NULL;
+}
+
+// Read a whole file from disk
+static unsigned char* ReadFileFromDisk(const char* fileName, int* dataSize) {
+    *dataSize = 0;
+    FILE* file = fopen(fileName, "rb");
+    if (file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = (size > 0) ? (unsigned char*)malloc(size) : NULL;
+    if (data != NULL && fread(data, 1, size, file) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    if (data != NULL) *dataSize = (int)size;
+    return data;
+}
+
+// raylib file callback - serves files prefetched for the model being
+// built, otherwise reads from disk. Called from workers and main thread.
+static unsigned char* LoadFileDataPrefetched(const char* fileName, int* dataSize) {
+    pthread_mutex_lock(&loaderMutex);
+    for (int i = 0; i < servingFileCount; i++) {
+        PrefetchedFile* file = &servingFiles[i];
+        if (file->data != NULL && strcmp(file->path, fileName) == 0) {
+            // raylib frees what it is given, so hand the buffer over
+            unsigned char* data = file->data;
+            *dataSize = file->size;
+            file->data = NULL;
+            pthread_mutex_unlock(&loaderMutex);
+            return data;
+        }
+    }
+    pthread_mutex_unlock(&loaderMutex);
+
+    return ReadFileFromDisk(fileName, dataSize);
+}
+
+// Read a model file and, for glTF, the buffers and images it references
+static void PrefetchModelFiles(LoadJob* job) {
+    PrefetchedFile* root = &job->files[job->fileCount++];
+    snprintf(root->path, sizeof(root->path), "%s", job->path);
+    root->data = ReadFileFromDisk(job->path, &root->size);
+
+    // Only glTF references other files (raylib's IsFileExtension is not
+    // thread-safe, so compare here)
+    const char* extension = strrchr(job->path, '.');
+    if (root->data == NULL || extension == NULL || strcasecmp(extension, ".gltf") != 0) return;
+
+    // Directory of the glTF, which its relative URIs resolve against
+    char directory[ASSET_KEY_LENGTH];
+    snprintf(directory, sizeof(directory), "%s", job->path);
+    char* slash = strrchr(directory, '/');
+    if (slash != NULL) slash[1] = '\0';
+    else directory[0] = '\0';
+
+    // Scan the JSON for "uri" strings - enough to find external files
+    // without a full parser
+    char* text = (char*)malloc(root->size + 1);
+    if (text == NULL) return;
+    memcpy(text, root->data, root->size);
+    text[root->size] = '\0';
+
+    for (char* cursor = strstr(text, "\"uri\""); cursor != NULL; cursor = strstr(cursor + 1, "\"uri\"")) {
+        char* start = strchr(cursor + 5, '"');
+        if (start == NULL) break;
+        start++;
+        char* end = strchr(start, '"');
+        if (end == NULL) break;
+
+        // Embedded data needs no file
+        int length = (int)(end - start);
+        if (length == 0 || strncmp(start, "data:", 5) == 0) continue;
+        if (job->fileCount >= ASSET_LOADER_MAX_FILES) break;
+
+        PrefetchedFile* file = &job->files[job->fileCount];
+        snprintf(file->path, sizeof(file->path), "%s%.*s", directory, length, start);
+        file->data = ReadFileFromDisk(file->path, &file->size);
+        if (file->data != NULL) job->fileCount++;
+    }
+
+    free(text);
+}
+
+// Worker-side part of a job: file reads and decoding
+static void DecodeJob(LoadJob* job) {
+    // Baked assets need no decode, only their pages read in
+    if (job->pakEntry != NULL) {
+        PrefetchPakEntry(job->pakEntry);
+        return;
+    }
+
+    switch (job->type) {
+        case LOAD_JOB_TEXTURE:
+            job->image = LoadImage(job->path);
+            break;
+        case LOAD_JOB_GENERATED:
+            job->image = LoadGeneratedImage(&job->generator);
+            break;
+        case LOAD_JOB_SHADER:
+            if (job->path[0] != '\0') job->vsCode = LoadFileText(job->path);
+            if (job->fsPath[0] != '\0') job->fsCode = LoadFileText(job->fsPath);
+            break;
+        case LOAD_JOB_MODEL:
+            PrefetchModelFiles(job);
+            break;
+    }
+}
+
+// Free whatever a job still holds
+static void FreeJob(LoadJob* job) {
+    if (job->image.data != NULL) UnloadImage(job->image);
+    if (job->vsCode != NULL) UnloadFileText(job->vsCode);
+    if (job->fsCode != NULL) UnloadFileText(job->fsCode);
+    for (int i = 0; i < job->fileCount; i++) {
+        free(job->files[i].data);
+    }
+    free(job);
+}
+
+// Main-thread part of a job: GPU upload into the registry entry
+static void UploadJob(LoadJob* job) {
+    switch (job->type) {
+        case LOAD_JOB_TEXTURE:
+        case LOAD_JOB_GENERATED: {
+            Texture2D texture;
+            if (job->pakEntry != NULL) {
+                texture = LoadPakTexture(job->pakEntry);
+            } else if (job->image.data != NULL) {
+                texture = LoadTextureFromImage(job->image);
+            } else {
+                Image img = GenImageColor(128, 128, job->fallback);
+                texture = LoadTextureFromImage(img);
+                UnloadImage(img);
+            }
+            StoreTextureAsset(job->handle, texture);
+            TraceLog(LOG_INFO, "ASSETS: Loaded texture %s", job->path);
+        } break;
+
+        case LOAD_JOB_SHADER: {
+            // Touch the pipeline now so its first real draw doesn't hitch
+            Shader shader = LoadShaderCached(job->vsCode, job->fsCode);
+            WarmUpShader(shader);
+            StoreShaderAsset(job->handle, shader);
+            TraceLog(LOG_INFO, "ASSETS: Compiled shader %s|%s", job->path, job->fsPath);
+        } break;
+
+        case LOAD_JOB_MODEL: {
+            // raylib still parses the model here, but every file it asks
+            // for comes from memory
+            pthread_mutex_lock(&loaderMutex);
+            servingFiles = job->files;
+            servingFileCount = job->fileCount;
+            pthread_mutex_unlock(&loaderMutex);
+
+            AssetHandle texture = ASSET_INVALID;
+            Model model = (job->pakEntry != NULL) ? LoadPakModel(job->pakEntry, &texture) : LoadModel(job->path);
+
+            pthread_mutex_lock(&loaderMutex);
+            servingFiles = NULL;
+            servingFileCount = 0;
+            pthread_mutex_unlock(&loaderMutex);
+
+            StoreModelAsset(job->handle, model, texture);
+            TraceLog(LOG_INFO, "ASSETS: Loaded model %s", job->path);
+        } break;
+    }
+
+    FreeJob(job);
+    jobsInFlight--;
+    batchCompleted++;
+}
+
+// Worker thread - decodes queued jobs until the loader shuts down
+static void* LoaderWorker(void* arg) {
+    int index = (int)(size_t)arg;
+
+    pthread_mutex_lock(&loaderMutex);
+    while (true) {
+        while (!quitWorkers && queuedJobs.head == NULL) {
+            pthread_cond_wait(&workAvailable, &loaderMutex);
+        }
+        if (quitWorkers) break;
+
+        LoadJob* job = TakeJob(&queuedJobs, ASSET_INVALID);
+        activeJobs[index] = job;
+        pthread_mutex_unlock(&loaderMutex);
+
+        DecodeJob(job);
+
+        pthread_mutex_lock(&loaderMutex);
+        activeJobs[index] = NULL;
+        PushJob(&decodedJobs, job);
+        pthread_cond_broadcast(&jobDecoded);
+    }
+    pthread_mutex_unlock(&loaderMutex);
+
+    return NULL;
+}
+
+// Queue a new job for the workers
+static void SubmitJob(LoadJob* job) {
+    jobsInFlight++;
+    batchRequested++;
+
+    // Without workers, decode right away and leave only the upload
+    if (workerCount == 0) {
+        DecodeJob(job);
+        PushJob(&decodedJobs, job);
+        return;
+    }
+
+    pthread_mutex_lock(&loaderMutex);
+    PushJob(&queuedJobs, job);
+    pthread_cond_signal(&workAvailable);
+    pthread_mutex_unlock(&loaderMutex);
+}
+
+// Start the worker threads - call once after the asset registry
+void InitAssetLoader(void) {
+    quitWorkers = false;
+    jobsInFlight = 0;
+    batchRequested = 0;
+    batchCompleted = 0;
+
+    // Every file raylib reads goes through the prefetch lookup
+    SetLoadFileDataCallback(LoadFileDataPrefetched);
+
+    // Leave a core for the main thread
+    int wanted = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (wanted < 1) wanted = 1;
+    if (wanted > ASSET_LOADER_MAX_WORKERS) wanted = ASSET_LOADER_MAX_WORKERS;
+
+    workerCount = 0;
+    for (int i = 0; i < wanted; i++) {
+        activeJobs[i] = NULL;
+        if (pthread_create(&workers[workerCount], NULL, LoaderWorker, (void*)(size_t)workerCount) == 0) {
+            workerCount++;
+        }
+    }
+
+    TraceLog(LOG_INFO, "ASSETS: Loader started with %d worker(s)", workerCount);
+}
+
+// Stop the workers and drop unfinished jobs
+void UnloadAssetLoader(void) {
+    pthread_mutex_lock(&loaderMutex);
+    quitWorkers = true;
+    pthread_cond_broadcast(&workAvailable);
+    pthread_mutex_unlock(&loaderMutex);
+
+    for (int i = 0; i < workerCount; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    workerCount = 0;
+
+    LoadJob* job;
+    while ((job = TakeJob(&queuedJobs, ASSET_INVALID)) != NULL) FreeJob(job);
+    while ((job = TakeJob(&decodedJobs, ASSET_INVALID)) != NULL) FreeJob(job);
+    jobsInFlight = 0;
+
+    SetLoadFileDataCallback(NULL);
+}
+
+// Request a texture; a flat fallback color is used if the file is missing
+AssetHandle RequestTexture(const char* path, Color fallback) {
+    bool created = false;
+    AssetHandle handle = ReserveAsset(path, ASSET_TEXTURE, &created);
+    if (!created) return handle;
+
+    LoadJob* job = (LoadJob*)calloc(1, sizeof(LoadJob));
+    job->type = LOAD_JOB_TEXTURE;
+    job->handle = handle;
+    job->fallback = fallback;
+    job->pakEntry = FindPakEntry(path, PAK_ENTRY_TEXTURE);
+    snprintf(job->path, sizeof(job->path), "%s", path);
+    SubmitJob(job);
+    return handle;
+}
+
+// Request a model file, with its glTF buffers and images read ahead
+AssetHandle RequestModel(const char* path) {
+    bool created = false;
+    AssetHandle handle = ReserveAsset(path, ASSET_MODEL, &created);
+    if (!created) return handle;
+
+    LoadJob* job = (LoadJob*)calloc(1, sizeof(LoadJob));
+    job->type = LOAD_JOB_MODEL;
+    job->handle = handle;
+    job->pakEntry = FindPakEntry(path, PAK_ENTRY_MODEL);
+    snprintf(job->path, sizeof(job->path), "%s", path);
+    SubmitJob(job);
+    return handle;
+}
+
+// Request a shader program - sources are read off-thread, compiled on upload
+AssetHandle RequestShader(const char* vsPath, const char* fsPath) {
+    char key[ASSET_KEY_LENGTH];
+    snprintf(key, sizeof(key), "%s|%s", vsPath, fsPath);
+
+    bool created = false;
+    AssetHandle handle = ReserveAsset(key, ASSET_SHADER, &created);
+    if (!created) return handle;
+
+    LoadJob* job = (LoadJob*)calloc(1, sizeof(LoadJob));
+    job->type = LOAD_JOB_SHADER;
+    job->handle = handle;
+    snprintf(job->path, sizeof(job->path), "%s", vsPath ? vsPath : "");
+    snprintf(job->fsPath, sizeof(job->fsPath), "%s", fsPath ? fsPath : "");
+    SubmitJob(job);
+    return handle;
+}
+
+// Request a procedurally generated texture - generated (or read from the
+// disk cache) on a worker
+AssetHandle RequestGeneratedTexture(const TexGenParams* params) {
+    char key[ASSET_KEY_LENGTH];
+    GetTexGenKey(params, key, sizeof(key));
+
+    bool created = false;
+    AssetHandle handle = ReserveAsset(key, ASSET_TEXTURE, &created);
+    if (!created) return handle;
+
+    LoadJob* job = (LoadJob*)calloc(1, sizeof(LoadJob));
+    job->type = LOAD_JOB_GENERATED;
+    job->handle = handle;
+    job->generator = *params;
+    job->fallback = params->baseColor;
+    snprintf(job->path, sizeof(job->path), "%s", key);
+    SubmitJob(job);
+    return handle;
+}
+
+// Upload decoded assets until the frame's budget (in seconds) is spent.
+// At least one upload happens per call so loading always progresses.
+// Returns the number of requests still outstanding.
+int UpdateAssetLoader(double budget) {
+    double startTime = GetTime();
+
+    while (true) {
+        pthread_mutex_lock(&loaderMutex);
+        LoadJob* job = TakeJob(&decodedJobs, ASSET_INVALID);
+        pthread_mutex_unlock(&loaderMutex);
+        if (job == NULL) break;
+
+        UploadJob(job);
+        if (GetTime() - startTime >= budget) break;
+    }
+
+    // Start a fresh batch once everything has landed
+    if (jobsInFlight == 0) {
+        batchRequested = 0;
+        batchCompleted = 0;
+    }
+
+    return jobsInFlight;
+}
+
+// Finish one asset immediately, for callers that cannot wait a frame
+void CompleteAssetLoad(AssetHandle handle) {
+    LoadJob* job = NULL;
+
+    pthread_mutex_lock(&loaderMutex);
+    while (job == NULL) {
+        job = TakeJob(&decodedJobs, handle);
+        if (job != NULL) break;
+
+        // Not picked up yet - decode it here rather than wait in line
+        job = TakeJob(&queuedJobs, handle);
+        if (job != NULL) {
+            pthread_mutex_unlock(&loaderMutex);
+            DecodeJob(job);
+            pthread_mutex_lock(&loaderMutex);
+            break;
+        }
+
+        // Otherwise a worker has it; wait unless nobody does
+        bool decoding = false;
+        for (int i = 0; i < workerCount; i++) {
+            if (activeJobs[i] != NULL && activeJobs[i]->handle == handle) decoding = true;
+        }
+        if (!decoding) break;
+
+        pthread_cond_wait(&jobDecoded, &loaderMutex);
+    }
+    pthread_mutex_unlock(&loaderMutex);
+
+    if (job != NULL) UploadJob(job);
+}
+
+// Check if any requested asset is still loading
+bool AssetLoadsPending(void) {
+    return jobsInFlight > 0;
+}
+
+// Fraction of the current batch of requests that is ready
+float GetAssetLoadProgress(void) {
+    if (batchRequested == 0) return 1.0f;
+    return (float)batchCompleted / (float)batchRequested;
+}
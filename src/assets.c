@@ -0,0 +1,320 @@
+#include "../include/assets.h"
+#include "../include/asset_loader.h"
+#include "../include/pak.h"
+#include "../include/shader_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ASSET_FALLBACK_SIZE 128
+
+// Process-wide registry, keyed by path (or by a generated name)
+static AssetEntry* entries = NULL;
+static int entryCount = 0;
+static int entryCapacity = 0;
+
+// FNV-1a hash of an asset key
+static unsigned int HashAssetKey(const char* key) {
+    unsigned int hash = 2166136261u;
+    for (const char* c = key; *c != '\0'; c++) {
+        hash ^= (unsigned char)*c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Look up a key without taking a reference
+static AssetHandle LookupAsset(const char* key, AssetType type) {
+    unsigned int hash = HashAssetKey(key);
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].hash == hash && entries[i].type == type && strcmp(entries[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return ASSET_INVALID;
+}
+
+// Look up a key for a synchronous acquire, taking a reference. An asset
+// still loading in the background is finished first.
+static AssetHandle FindAsset(const char* key, AssetType type) {
+    AssetHandle handle = LookupAsset(key, type);
+    if (handle == ASSET_INVALID) return ASSET_INVALID;
+
+    entries[handle].refCount++;
+    if (!entries[handle].ready) CompleteAssetLoad(handle);
+    return handle;
+}
+
+// Append a new entry holding one reference
+static AssetHandle AddAsset(const char* key, AssetType type) {
+    if (entryCount >= entryCapacity) {
+        int capacity = entryCapacity == 0 ? 64 : entryCapacity * 2;
+        AssetEntry* grown = (AssetEntry*)realloc(entries, capacity * sizeof(AssetEntry));
+        if (grown == NULL) return ASSET_INVALID;
+        entries = grown;
+        entryCapacity = capacity;
+    }
+
+    AssetEntry* entry = &entries[entryCount];
+    memset(entry, 0, sizeof(AssetEntry));
+    snprintf(entry->key, sizeof(entry->key), "%s", key);
+    entry->hash = HashAssetKey(entry->key);
+    entry->type = type;
+    entry->refCount = 1;
+    entry->ready = true;
+    entry->dependency = ASSET_INVALID;
+    return entryCount++;
+}
+
+// Initialize the registry - call once after the window is created
+void InitAssetRegistry(void) {
+    entries = NULL;
+    entryCount = 0;
+    entryCapacity = 0;
+}
+
+// Unload every registered asset - call once before the window closes
+void UnloadAssetRegistry(void) {
+    // Models give back the textures they hold first, and forget them so
+    // UnloadModel leaves the shared texture to its own entry
+    for (int i = 0; i < entryCount; i++) {
+        AssetEntry* entry = &entries[i];
+        if (entry->dependency == ASSET_INVALID) continue;
+        if (entry->ready) entry->model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = (Texture2D){0};
+        ReleaseAsset(entry->dependency);
+        entry->dependency = ASSET_INVALID;
+    }
+
+    for (int i = 0; i < entryCount; i++) {
+        AssetEntry* entry = &entries[i];
+        if (entry->refCount > 0) {
+            TraceLog(LOG_DEBUG, "ASSETS: %s still has %d reference(s) at shutdown", entry->key, entry->refCount);
+        }
+
+        if (!entry->ready) continue;
+        switch (entry->type) {
+            case ASSET_TEXTURE: UnloadTexture(entry->texture); break;
+            case ASSET_MODEL:   UnloadModel(entry->model); break;
+            case ASSET_SHADER:  UnloadShader(entry->shader); break;
+        }
+    }
+
+    free(entries);
+    entries = NULL;
+    entryCount = 0;
+    entryCapacity = 0;
+}
+
+// Acquire a texture from disk, substituting a flat color if it is missing.
+// The fallback is cached under the same path so the file is tried only once.
+AssetHandle AcquireTexture(const char* path, Color fallback) {
+    AssetHandle handle = FindAsset(path, ASSET_TEXTURE);
+    if (handle != ASSET_INVALID) return handle;
+
+    // Prefer the baked archive, which needs no decode
+    const PakEntry* pakEntry = FindPakEntry(path, PAK_ENTRY_TEXTURE);
+    Texture2D texture = (pakEntry != NULL) ? LoadPakTexture(pakEntry) : LoadTexture(path);
+    if (texture.id == 0) {
+        Image img = GenImageColor(ASSET_FALLBACK_SIZE, ASSET_FALLBACK_SIZE, fallback);
+        texture = LoadTextureFromImage(img);
+        UnloadImage(img);
+    }
+
+    handle = AddAsset(path, ASSET_TEXTURE);
+    if (handle == ASSET_INVALID) {
+        UnloadTexture(texture);
+        return ASSET_INVALID;
+    }
+    entries[handle].texture = texture;
+    TraceLog(LOG_INFO, "ASSETS: Loaded texture %s", path);
+    return handle;
+}
+
+// Acquire a square texture of a single color
+AssetHandle AcquireColorTexture(int size, Color color) {
+    char key[ASSET_KEY_LENGTH];
+    snprintf(key, sizeof(key), "color:%02x%02x%02x%02x:%d", color.r, color.g, color.b, color.a, size);
+
+    AssetHandle handle = FindAsset(key, ASSET_TEXTURE);
+    if (handle != ASSET_INVALID) return handle;
+
+    Image img = GenImageColor(size, size, color);
+    Texture2D texture = LoadTextureFromImage(img);
+    UnloadImage(img);
+
+    handle = AddAsset(key, ASSET_TEXTURE);
+    if (handle == ASSET_INVALID) {
+        UnloadTexture(texture);
+        return ASSET_INVALID;
+    }
+    entries[handle].texture = texture;
+    return handle;
+}
+
+// Acquire a procedurally generated texture - read from the disk cache
+// when an earlier run already generated it
+AssetHandle AcquireGeneratedTexture(const TexGenParams* params) {
+    char key[ASSET_KEY_LENGTH];
+    GetTexGenKey(params, key, sizeof(key));
+
+    AssetHandle handle = FindAsset(key, ASSET_TEXTURE);
+    if (handle != ASSET_INVALID) return handle;
+
+    Image image = LoadGeneratedImage(params);
+    if (image.data == NULL) image = GenImageColor(ASSET_FALLBACK_SIZE, ASSET_FALLBACK_SIZE, params->baseColor);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    handle = AddAsset(key, ASSET_TEXTURE);
+    if (handle == ASSET_INVALID) {
+        UnloadTexture(texture);
+        return ASSET_INVALID;
+    }
+    entries[handle].texture = texture;
+    return handle;
+}
+
+// Acquire a model built from a primitive mesh. The key names the model
+// rather than the mesh, since models with the same shape can carry
+// different materials.
+AssetHandle AcquireMeshModel(const char* key, MeshShape shape, Vector3 size, int detail) {
+    AssetHandle handle = FindAsset(key, ASSET_MODEL);
+    if (handle != ASSET_INVALID) return handle;
+
+    Mesh mesh;
+    switch (shape) {
+        case MESH_SHAPE_PLANE:    mesh = GenMeshPlane(size.x, size.z, detail, detail); break;
+        case MESH_SHAPE_CYLINDER: mesh = GenMeshCylinder(size.x, size.y, detail); break;
+        case MESH_SHAPE_SPHERE:   mesh = GenMeshSphere(size.x, detail, detail); break;
+        case MESH_SHAPE_CUBE:
+        default:                  mesh = GenMeshCube(size.x, size.y, size.z); break;
+    }
+    Model model = LoadModelFromMesh(mesh);
+
+    handle = AddAsset(key, ASSET_MODEL);
+    if (handle == ASSET_INVALID) {
+        UnloadModel(model);
+        return ASSET_INVALID;
+    }
+    entries[handle].model = model;
+    return handle;
+}
+
+// Acquire a model from a file (glTF, OBJ, ...)
+AssetHandle AcquireModelFile(const char* path) {
+    AssetHandle handle = FindAsset(path, ASSET_MODEL);
+    if (handle != ASSET_INVALID) return handle;
+
+    const PakEntry* pakEntry = FindPakEntry(path, PAK_ENTRY_MODEL);
+    AssetHandle texture = ASSET_INVALID;
+    Model model = (pakEntry != NULL) ? LoadPakModel(pakEntry, &texture) : LoadModel(path);
+
+    handle = AddAsset(path, ASSET_MODEL);
+    if (handle == ASSET_INVALID) {
+        if (texture != ASSET_INVALID) model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = (Texture2D){0};
+        ReleaseAsset(texture);
+        UnloadModel(model);
+        return ASSET_INVALID;
+    }
+    entries[handle].model = model;
+    entries[handle].dependency = texture;
+    TraceLog(LOG_INFO, "ASSETS: Loaded model %s", path);
+    return handle;
+}
+
+// Acquire a shader program, compiled (or read from the binary cache) on
+// first use only
+AssetHandle AcquireShader(const char* vsPath, const char* fsPath) {
+    char key[ASSET_KEY_LENGTH];
+    snprintf(key, sizeof(key), "%s|%s", vsPath, fsPath);
+
+    AssetHandle handle = FindAsset(key, ASSET_SHADER);
+    if (handle != ASSET_INVALID) return handle;
+
+    char* vsCode = (vsPath != NULL) ? LoadFileText(vsPath) : NULL;
+    char* fsCode = (fsPath != NULL) ? LoadFileText(fsPath) : NULL;
+    Shader shader = LoadShaderCached(vsCode, fsCode);
+    if (vsCode != NULL) UnloadFileText(vsCode);
+    if (fsCode != NULL) UnloadFileText(fsCode);
+    WarmUpShader(shader);
+
+    handle = AddAsset(key, ASSET_SHADER);
+    if (handle == ASSET_INVALID) {
+        UnloadShader(shader);
+        return ASSET_INVALID;
+    }
+    entries[handle].shader = shader;
+    TraceLog(LOG_INFO, "ASSETS: Compiled shader %s", key);
+    return handle;
+}
+
+// Drop a reference. The asset stays loaded for the next acquire.
+void ReleaseAsset(AssetHandle handle) {
+    if (handle < 0 || handle >= entryCount) return;
+    if (entries[handle].refCount > 0) entries[handle].refCount--;
+}
+
+// Get the texture behind a handle
+Texture2D GetTextureAsset(AssetHandle handle) {
+    if (handle < 0 || handle >= entryCount || entries[handle].type != ASSET_TEXTURE) return (Texture2D){0};
+    return entries[handle].texture;
+}
+
+// Get the model behind a handle. Models are shared, so changes to their
+// materials are seen by every holder. The pointer is only valid until the
+// next acquire; copy the Model to keep it.
+Model* GetModelAsset(AssetHandle handle) {
+    if (handle < 0 || handle >= entryCount || entries[handle].type != ASSET_MODEL) return NULL;
+    return &entries[handle].model;
+}
+
+// Get the shader behind a handle
+Shader GetShaderAsset(AssetHandle handle) {
+    if (handle < 0 || handle >= entryCount || entries[handle].type != ASSET_SHADER) return (Shader){0};
+    return entries[handle].shader;
+}
+
+// Find or add an entry for the asynchronous loader, taking a reference.
+// New entries are left not ready until the loader stores the asset.
+AssetHandle ReserveAsset(const char* key, AssetType type, bool* created) {
+    AssetHandle handle = LookupAsset(key, type);
+    if (handle != ASSET_INVALID) {
+        entries[handle].refCount++;
+        *created = false;
+        return handle;
+    }
+
+    handle = AddAsset(key, type);
+    if (handle != ASSET_INVALID) entries[handle].ready = false;
+    *created = (handle != ASSET_INVALID);
+    return handle;
+}
+
+// Store a texture finished by the loader
+void StoreTextureAsset(AssetHandle handle, Texture2D texture) {
+    if (handle < 0 || handle >= entryCount) return;
+    entries[handle].texture = texture;
+    entries[handle].ready = true;
+}
+
+// Store a model finished by the loader, with the texture reference it
+// took if it came from the pak
+void StoreModelAsset(AssetHandle handle, Model model, AssetHandle dependency) {
+    if (handle < 0 || handle >= entryCount) return;
+    entries[handle].model = model;
+    entries[handle].dependency = dependency;
+    entries[handle].ready = true;
+}
+
+// Store a shader finished by the loader
+void StoreShaderAsset(AssetHandle handle, Shader shader) {
+    if (handle < 0 || handle >= entryCount) return;
+    entries[handle].shader = shader;
+    entries[handle].ready = true;
+}
+
+// Check if an asset has finished loading
+bool IsAssetReady(AssetHandle handle) {
+    if (handle < 0 || handle >= entryCount) return false;
+    return entries[handle].ready;
+}
@@ -0,0 +1,27 @@
+#include "../include/audio.h"
+
+static bool audioOpened = false;
+
+// Open the audio device on first use. Returns false if it is unavailable,
+// in which case sounds load empty and play silently.
+bool EnsureAudioDevice(void) {
+    if (!audioOpened) {
+        double start = GetTime();
+        InitAudioDevice();
+        audioOpened = true;
+        TraceLog(LOG_INFO, "AUDIO: Device opened on first use (%.1f ms)", (GetTime() - start) * 1000.0);
+    }
+    return IsAudioDeviceReady();
+}
+
+// Load a sound, opening the audio device if this is the first one
+Sound LoadGameSound(const char* path) {
+    if (!EnsureAudioDevice()) return (Sound){ 0 };
+    return LoadSound(path);
+}
+
+// Close the audio device if anything opened it
+void CloseGameAudio(void) {
+    if (audioOpened) CloseAudioDevice();
+    audioOpened = false;
+}
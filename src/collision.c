@@ -0,0 +1,183 @@
+#include "../include/collision.h"
+#include "raymath.h"
+#include <math.h>
+
+// Check if a tile stops movement. Everything outside the level does.
+static bool IsSolidTile(Dungeon* dungeon, int x, int z) {
+    if (x < 0 || x >= dungeon->width || z < 0 || z >= dungeon->height) return true;
+    return dungeon->tiles[x][z] == TILE_WALL || dungeon->tiles[x][z] == TILE_NONE;
+}
+
+// Test a moving circle against one solid tile. On a contact earlier than
+// *time, store its time and the wall normal there and return true.
+static bool SweepTile(Vector2 start, Vector2 move, float radius, int tileX, int tileZ, float* time, Vector2* normal) {
+    // Already touching: a hit at once if moving further in, nothing if
+    // moving out, so a circle left in contact can always back away
+    Vector2 closest = { Clamp(start.x, (float)tileX, tileX + 1.0f), Clamp(start.y, (float)tileZ, tileZ + 1.0f) };
+    Vector2 away = Vector2Subtract(start, closest);
+    float distanceSquared = Vector2LengthSqr(away);
+    if (distanceSquared < radius * radius) {
+        Vector2 out = (distanceSquared > 0.0f) ? Vector2Scale(away, 1.0f / sqrtf(distanceSquared))
+                                               : Vector2Normalize(Vector2Negate(move));
+        if (Vector2DotProduct(move, out) >= 0.0f) return false;
+        *time = 0.0f;
+        *normal = out;
+        return true;
+    }
+
+    // Entry into the tile's box grown by the radius, one slab per axis
+    float minimum[2] = { tileX - radius, tileZ - radius };
+    float maximum[2] = { tileX + 1.0f + radius, tileZ + 1.0f + radius };
+    float origin[2] = { start.x, start.y };
+    float delta[2] = { move.x, move.y };
+    float enter = -INFINITY;
+    float exit = INFINITY;
+    int enterAxis = -1;
+    for (int axis = 0; axis < 2; axis++) {
+        if (delta[axis] == 0.0f) {
+            if (origin[axis] <= minimum[axis] || origin[axis] >= maximum[axis]) return false;
+            continue;
+        }
+        float near = (((delta[axis] > 0.0f) ? minimum[axis] : maximum[axis]) - origin[axis]) / delta[axis];
+        float far = (((delta[axis] > 0.0f) ? maximum[axis] : minimum[axis]) - origin[axis]) / delta[axis];
+        if (near > enter) {
+            enter = near;
+            enterAxis = axis;
+        }
+        if (far < exit) exit = far;
+    }
+    if (enter > exit || exit < 0.0f || enter > 1.0f) return false;
+    bool startedInside = enter < 0.0f;
+    if (startedInside) enter = 0.0f;
+    if (enter >= *time) return false;
+
+    // Entering along a face: the grown box is the true shape there. A start
+    // inside it beside a face is a graze the overlap test let go.
+    Vector2 contact = Vector2Add(start, Vector2Scale(move, enter));
+    bool alongX = contact.x >= tileX && contact.x <= tileX + 1.0f;
+    bool alongZ = contact.y >= tileZ && contact.y <= tileZ + 1.0f;
+    if (alongX || alongZ) {
+        if (startedInside || enterAxis < 0) return false;
+        *time = enter;
+        *normal = (enterAxis == 0) ? (Vector2){ (move.x > 0.0f) ? -1.0f : 1.0f, 0.0f }
+                                   : (Vector2){ 0.0f, (move.y > 0.0f) ? -1.0f : 1.0f };
+        return true;
+    }
+
+    // Entering through a corner square: only that corner's rounding can be
+    // hit, as the ray against a circle of the radius
+    Vector2 corner = { Clamp(contact.x, (float)tileX, tileX + 1.0f), Clamp(contact.y, (float)tileZ, tileZ + 1.0f) };
+    Vector2 offset = Vector2Subtract(start, corner);
+    float a = Vector2LengthSqr(move);
+    float b = Vector2DotProduct(offset, move);
+    float c = Vector2LengthSqr(offset) - radius * radius;
+    float discriminant = b * b - a * c;
+    if (b >= 0.0f || discriminant < 0.0f) return false;
+
+    float hit = (-b - sqrtf(discriminant)) / a;
+    if (hit < 0.0f || hit > 1.0f || hit >= *time) return false;
+    *time = hit;
+    *normal = Vector2Scale(Vector2Add(offset, Vector2Scale(move, hit)), 1.0f / radius);
+    return true;
+}
+
+// Time in [0, 1] along the move at which the circle first touches a wall,
+// 1 when the whole move is clear. normal receives the wall's normal at the
+// contact. The radius is used as given.
+float SweepCircle(Dungeon* dungeon, Vector2 start, Vector2 move, float radius, Vector2* normal) {
+    float time = 1.0f;
+    *normal = (Vector2){ 0.0f, 0.0f };
+
+    // Walk the cells the centre passes through. A circle centred in a cell
+    // only reaches tiles within reach of it, so those are tested at each.
+    int reach = (int)ceilf(radius);
+    int cellX = (int)floorf(start.x);
+    int cellZ = (int)floorf(start.y);
+    int stepX = (move.x > 0.0f) ? 1 : -1;
+    int stepZ = (move.y > 0.0f) ? 1 : -1;
+    float deltaX = (move.x != 0.0f) ? fabsf(1.0f / move.x) : INFINITY;
+    float deltaZ = (move.y != 0.0f) ? fabsf(1.0f / move.y) : INFINITY;
+    float nextX = (move.x != 0.0f) ? ((cellX + (stepX > 0)) - start.x) / move.x : INFINITY;
+    float nextZ = (move.y != 0.0f) ? ((cellZ + (stepZ > 0)) - start.y) / move.y : INFINITY;
+
+    for (;;) {
+        for (int x = cellX - reach; x <= cellX + reach; x++) {
+            for (int z = cellZ - reach; z <= cellZ + reach; z++) {
+                if (IsSolidTile(dungeon, x, z)) SweepTile(start, move, radius, x, z, &time, normal);
+            }
+        }
+
+        // Stop once the next cell starts past the move or the contact
+        float next = fminf(nextX, nextZ);
+        if (next > 1.0f || next >= time) break;
+        if (nextX < nextZ) {
+            cellX += stepX;
+            nextX += deltaX;
+        } else {
+            cellZ += stepZ;
+            nextZ += deltaZ;
+        }
+    }
+    return time;
+}
+
+// Move a circle, sliding along the walls it meets. Returns true if it
+// touched any.
+bool MoveCircle(Dungeon* dungeon, Vector2* position, Vector2 move, float radius) {
+    radius *= COLLISION_RADIUS_SCALE;
+    bool touched = false;
+
+    for (int slide = 0; slide < COLLISION_MAX_SLIDES; slide++) {
+        if (move.x == 0.0f && move.y == 0.0f) break;
+
+        Vector2 normal;
+        float time = SweepCircle(dungeon, *position, move, radius, &normal);
+        if (time >= 1.0f) {
+            *position = Vector2Add(*position, move);
+            return touched;
+        }
+
+        // Stop just short of the contact, backing off along the path already
+        // found clear, and keep what is left of the move along the wall
+        touched = true;
+        float stop = fmaxf(time - COLLISION_SKIN / Vector2Length(move), 0.0f);
+        *position = Vector2Add(*position, Vector2Scale(move, stop));
+        Vector2 rest = Vector2Scale(move, 1.0f - stop);
+        move = Vector2Subtract(rest, Vector2Scale(normal, Vector2DotProduct(rest, normal)));
+    }
+    return touched;
+}
+
+// Move count circles held as separate arrays. Moves that stay clear of
+// every solid tile - most of them, out in the rooms - are applied without
+// a sweep; the rest go through MoveCircle.
+void MoveCircles(Dungeon* dungeon, float* positionX, float* positionZ, const float* moveX, const float* moveZ,
+                 const float* radius, int count) {
+    for (int i = 0; i < count; i++) {
+        if (moveX[i] == 0.0f && moveZ[i] == 0.0f) continue;
+
+        // Tiles under the box around the whole swept circle
+        float reach = radius[i] * COLLISION_RADIUS_SCALE;
+        int minX = (int)floorf(fminf(positionX[i], positionX[i] + moveX[i]) - reach);
+        int maxX = (int)floorf(fmaxf(positionX[i], positionX[i] + moveX[i]) + reach);
+        int minZ = (int)floorf(fminf(positionZ[i], positionZ[i] + moveZ[i]) - reach);
+        int maxZ = (int)floorf(fmaxf(positionZ[i], positionZ[i] + moveZ[i]) + reach);
+
+        bool clear = true;
+        for (int x = minX; x <= maxX && clear; x++) {
+            for (int z = minZ; z <= maxZ && clear; z++) {
+                clear = !IsSolidTile(dungeon, x, z);
+            }
+        }
+
+        if (clear) {
+            positionX[i] += moveX[i];
+            positionZ[i] += moveZ[i];
+        } else {
+            Vector2 position = { positionX[i], positionZ[i] };
+            MoveCircle(dungeon, &position, (Vector2){ moveX[i], moveZ[i] }, radius[i]);
+            positionX[i] = position.x;
+            positionZ[i] = position.y;
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#include "../include/director.h"
+#include "raymath.h"
+#include <math.h>
+#include <string.h>
+
+// Start from conservative cost guesses; measurements replace them within
+// a second or two of gameplay
+void InitSpawnDirector(SpawnDirector* director, int targetFps) {
+    memset(director, 0, sizeof(SpawnDirector));
+    director->budget = DIRECTOR_BUDGET_SHARE / (float)targetFps;
+    director->simCostPerEnemy = 20e-6f;
+    director->renderCostPerEnemy = 40e-6f;
+    director->maxActive = DIRECTOR_MIN_ACTIVE * 4;
+    director->wakeRadius = DIRECTOR_MAX_WAKE_RADIUS;
+    ResetSpawnDirectorLevel(director);
+}
+
+// Restart wave pacing for a new level. Cost estimates carry over.
+void ResetSpawnDirectorLevel(SpawnDirector* director) {
+    director->activeEnemies = 0;
+    director->waitingWakes = 0;
+    director->wakeTokens = DIRECTOR_WAKE_BURST;
+    director->waveInterval = DIRECTOR_WAVE_INTERVAL;
+    director->waveTimer = DIRECTOR_WAVE_INTERVAL;
+    director->limit = DIRECTOR_UNCONSTRAINED;
+}
+
+// Move the active cap, logging the decision
+static void SetActiveCap(SpawnDirector* director, int maxActive, float costPerEnemy) {
+    if (maxActive < DIRECTOR_MIN_ACTIVE) maxActive = DIRECTOR_MIN_ACTIVE;
+    if (maxActive > DIRECTOR_MAX_ACTIVE) maxActive = DIRECTOR_MAX_ACTIVE;
+    director->framesWithHeadroom = 0;
+    if (maxActive == director->maxActive) return;
+
+    TraceLog(LOG_INFO, "DIRECTOR: Active cap %d -> %d (%.1f us per enemy, %.2f ms budget)",
+             director->maxActive, maxActive, costPerEnemy * 1e6f, director->budget * 1000.0f);
+    director->maxActive = maxActive;
+}
+
+// Run one tick: wake dormant enemies near the player within the cap and
+// the wake rate, and send a wave when one is due and fits
+void UpdateSpawnDirector(SpawnDirector* director, EnemyPool* pool, const SpatialHash* spatial, Dungeon* dungeon,
+                         Vector3 playerPosition, int level, float deltaTime) {
+    int active = GetAwakeEnemyCount(pool);
+    director->limit = DIRECTOR_UNCONSTRAINED;
+
+    // Wakes are metered, so a packed room comes alive over several ticks
+    director->wakeTokens = fminf(director->wakeTokens + DIRECTOR_WAKES_PER_SECOND * deltaTime, DIRECTOR_WAKE_BURST);
+    int capacity = (director->maxActive > active) ? director->maxActive - active : 0;
+    int allowed = ((int)director->wakeTokens < capacity) ? (int)director->wakeTokens : capacity;
+
+    int woken = WakeEnemies(pool, spatial, playerPosition, director->wakeRadius, allowed, &director->waitingWakes);
+    director->wakeTokens -= woken;
+    active += woken;
+    if (director->waitingWakes > 0) {
+        director->limit = (woken >= capacity) ? DIRECTOR_CAPPED_WAKES : DIRECTOR_RATE_LIMITED;
+    }
+
+    // The fuller the cap, the closer the player has to be to wake anything
+    float headroom = Clamp(1.0f - (float)active / (float)director->maxActive, 0.0f, 1.0f);
+    float targetRadius = Lerp(DIRECTOR_MIN_WAKE_RADIUS, DIRECTOR_MAX_WAKE_RADIUS, Clamp(headroom * 2.0f, 0.0f, 1.0f));
+    director->wakeRadius += (targetRadius - director->wakeRadius) * fminf(deltaTime, 1.0f);
+
+    // Waves come in just beyond the wake radius. Each enemy costs at least
+    // one point, so a wave never adds more enemies than its budget.
+    director->waveTimer -= deltaTime;
+    if (director->waveTimer <= 0.0f) {
+        int waveBudget = (int)(GetLevelSpawnBudget(level) * DIRECTOR_WAVE_BUDGET_SHARE);
+        if (waveBudget < 1) waveBudget = 1;
+
+        if (active + waveBudget <= director->maxActive) {
+            int spawned = SpawnWave(pool, dungeon, playerPosition, level, waveBudget,
+                                    director->wakeRadius, director->wakeRadius * 2.0f);
+            if (spawned > 0) {
+                director->wavesSpawned++;
+                active += spawned;
+                TraceLog(LOG_INFO, "DIRECTOR: Wave of %d enemies (%d/%d active)", spawned, active, director->maxActive);
+            }
+
+            // Pace the next wave by how much of the cap is still free
+            director->waveInterval = DIRECTOR_WAVE_INTERVAL / fmaxf(headroom, 0.25f);
+            director->waveTimer = director->waveInterval;
+        } else {
+            director->wavesDeferred++;
+            director->limit = DIRECTOR_DEFERRED_WAVE;
+            director->waveTimer = DIRECTOR_WAVE_RETRY;
+        }
+    }
+
+    director->activeEnemies = active;
+}
+
+// Feed the time one tick spent updating awake enemies
+void RecordEnemySimCost(SpawnDirector* director, float seconds, int awakeEnemies) {
+    if (awakeEnemies <= 0) return;
+
+    float sample = seconds / (float)awakeEnemies;
+    director->simCostPerEnemy += (sample - director->simCostPerEnemy) * DIRECTOR_SMOOTHING;
+}
+
+// Feed one frame's scene render time and the enemies drawn in it, then
+// rebalance the active cap. The scene also holds the dungeon, so the
+// per-enemy cost is the slope of scene time against enemies drawn, fitted
+// over recent frames. A held cap keeps the estimates but never moves.
+void RecordEnemyRenderCost(SpawnDirector* director, float sceneSeconds, int drawnEnemies, int ticksThisFrame) {
+    float drawn = (float)drawnEnemies;
+
+    // Seed the averages with the first frame rather than fitting from zero
+    if (director->meanSceneTime == 0.0f) {
+        director->meanDrawn = drawn;
+        director->meanSceneTime = sceneSeconds;
+        director->meanDrawnSquared = drawn * drawn;
+        director->meanDrawnSceneTime = drawn * sceneSeconds;
+    }
+    director->meanDrawn += (drawn - director->meanDrawn) * DIRECTOR_SMOOTHING;
+    director->meanSceneTime += (sceneSeconds - director->meanSceneTime) * DIRECTOR_SMOOTHING;
+    director->meanDrawnSquared += (drawn * drawn - director->meanDrawnSquared) * DIRECTOR_SMOOTHING;
+    director->meanDrawnSceneTime += (drawn * sceneSeconds - director->meanDrawnSceneTime) * DIRECTOR_SMOOTHING;
+
+    // Only trust the slope once the count has varied enough to fit it
+    float variance = director->meanDrawnSquared - director->meanDrawn * director->meanDrawn;
+    if (variance > DIRECTOR_MIN_FIT_VARIANCE) {
+        float slope = (director->meanDrawnSceneTime - director->meanDrawn * director->meanSceneTime) / variance;
+        director->renderCostPerEnemy += (fmaxf(slope, 0.0f) - director->renderCostPerEnemy) * DIRECTOR_SMOOTHING;
+    }
+
+    float ticks = fmaxf((float)ticksThisFrame, 1.0f);
+    float costPerEnemy = director->simCostPerEnemy * ticks + director->renderCostPerEnemy;
+    director->projectedCost = costPerEnemy * director->activeEnemies;
+    if (director->capHeld) return;
+
+    // Cut the cap as soon as it is unaffordable; raise it only after a
+    // sustained stretch of headroom, and halfway at a time
+    int affordable = (costPerEnemy > 0.0f) ? (int)fminf(director->budget / costPerEnemy, (float)DIRECTOR_MAX_ACTIVE)
+                                           : DIRECTOR_MAX_ACTIVE;
+    if (affordable < director->maxActive) {
+        SetActiveCap(director, affordable, costPerEnemy);
+    } else if (affordable > director->maxActive * DIRECTOR_UP_HEADROOM) {
+        if (++director->framesWithHeadroom >= DIRECTOR_UP_FRAMES) {
+            SetActiveCap(director, director->maxActive + (affordable - director->maxActive + 1) / 2, costPerEnemy);
+        }
+    } else {
+        director->framesWithHeadroom = 0;
+    }
+}
+
+// Short label for the telemetry overlay
+const char* GetDirectorLimitName(DirectorLimit limit) {
+    switch (limit) {
+        case DIRECTOR_CAPPED_WAKES:  return "CAPPED";
+        case DIRECTOR_RATE_LIMITED:  return "METERED";
+        case DIRECTOR_DEFERRED_WAVE: return "WAVE HELD";
+        default:                     return "OK";
+    }
+}
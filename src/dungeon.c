@@ -1,10 +1,14 @@
 #include "../include/dungeon.h"
 #include "../include/dungeon_props.h"
+#include "../include/lightmap.h"
+#include "../include/asset_loader.h"
+#include "../include/shadow.h"
+#include "../include/nav_graph.h"
+#include "../include/main_thread.h"
 #include "raymath.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 
 // Initialize dungeon structure
 void InitDungeon(Dungeon* dungeon) {
@@ -17,6 +21,15 @@ void InitDungeon(Dungeon* dungeon) {
     dungeon->startPosition = (Vector3){0.0f, 0.0f, 0.0f};
     dungeon->endPosition = (Vector3){0.0f, 0.0f, 0.0f};
     dungeon->theme = 0;
+    dungeon->torches = NULL;
+    dungeon->torchCount = 0;
+    dungeon->bakedLight = NULL;
+    dungeon->torchShadows = NULL;
+    dungeon->shadowAtlas = NULL;
+    dungeon->shadowAtlasSize = 0;
+    dungeon->dynamicShadow = NULL;
+    dungeon->navGraph = NULL;
+    dungeon->assetCount = 0;
 }
 
 // Generate a random dungeon layout
@@ -41,11 +54,6 @@ void GenerateDungeon(Dungeon* dungeon, int width, int height, int maxRooms, int
     dungeon->rooms = (Room*)malloc(maxRooms * sizeof(Room));
     dungeon->roomCount = 0;
     
-    // Random seed if not already set
-    if (GetRandomValue(0, 1) == 0) {
-        SetRandomSeed(time(NULL));
-    }
-    
     // Generate rooms
     for (int i = 0; i < maxRooms; i++) {
         // Random room size (width and height)
@@ -156,6 +164,15 @@ void GenerateDungeon(Dungeon* dungeon, int width, int height, int maxRooms, int
     
     // Add decorative props (torches, barrels, crates, etc.)
     AddDecorativeProps(dungeon);
+    
+    // Bake ambient occlusion and torch light now that the layout is final
+    BakeDungeonLighting(dungeon);
+    
+    // Cache the static part of every torch's shadow map
+    BuildTorchShadowMaps(dungeon);
+    
+    // Cluster the layout for hierarchical pathfinding
+    BuildNavGraph(dungeon);
 }
 
 // Create a horizontal corridor between x1 and x2 at y (now with adjustable width)
@@ -334,138 +351,148 @@ void AddRandomChests(Dungeon* dungeon, int count) {
     }
 }
 
-// Load dungeon assets based on theme
-void LoadDungeonAssets(Dungeon* dungeon, int theme) {
-    // Path to models directory
-    const char* modelsPath = "assets/models/";
-    const char* texturesPath = "assets/textures/";
-    
-    // Asset file names for different themes
-    const char* themeNames[] = {"dungeon", "cave", "crypt"};
-    const char* themeName = themeNames[theme % 3]; // Ensure theme is valid
-    
-    char modelPath[256];
-    char texturePath[256];
-    
-    // Create directory structure for models if it doesn't exist
-    snprintf(modelPath, sizeof(modelPath), "mkdir -p assets/models/%s", themeName);
-    system(modelPath);
-    
-    // Create directory structure for textures if it doesn't exist
-    snprintf(texturePath, sizeof(texturePath), "mkdir -p assets/textures/%s", themeName);
-    system(texturePath);
-    
-    // Copy models and textures from raw-assets to our asset directory
-    // For now, we'll use the raylib's built-in primitive shapes for testing
-    // In a real implementation, you'd load actual model files
-    
-    // Create models using raylib primitives
-    // Floor with 2x2 segments for better texture mapping
-    dungeon->floorModel = LoadModelFromMesh(GenMeshPlane(1.0f, 1.0f, 2, 2));
-    
-    // Wall - using standard cube mesh with 1x3x1 dimensions
-    dungeon->wallModel = LoadModelFromMesh(GenMeshCube(1.0f, 3.0f, 1.0f));
-    
-    // Ceiling - create a plane with 2x2 segments for better texture mapping
-    dungeon->ceilingModel = LoadModelFromMesh(GenMeshPlane(1.0f, 1.0f, 2, 2));
-    
-    // Door - increased height to match walls
-    dungeon->doorModel = LoadModelFromMesh(GenMeshCube(1.0f, 3.0f, 0.2f));
-    
-    // Stairs
-    dungeon->stairsUpModel = LoadModelFromMesh(GenMeshCube(1.0f, 0.5f, 1.0f));
-    dungeon->stairsDownModel = LoadModelFromMesh(GenMeshCube(1.0f, 0.5f, 1.0f));
-    
-    // Trap
-    dungeon->trapModel = LoadModelFromMesh(GenMeshPlane(0.8f, 0.8f, 1, 1));
-    
-    // Chest
-    dungeon->chestModel = LoadModelFromMesh(GenMeshCube(0.8f, 0.5f, 0.5f));
-    
-    // Load actual textures for floor and walls
-    char wallTexturePath[256];
-    char floorTexturePath[256];
-    
-    // Build paths to textures
-    snprintf(wallTexturePath, sizeof(wallTexturePath), "%sdungeon/tiling_dungeon_brickwall01.png", texturesPath);
-    snprintf(floorTexturePath, sizeof(floorTexturePath), "%sdungeon/tiling_dungeon_floor01.png", texturesPath);
-    
-    // Load wall texture
-    dungeon->wallTexture = LoadTexture(wallTexturePath);
-    
-    // Load floor texture
-    dungeon->floorTexture = LoadTexture(floorTexturePath);
-    
-    // Use wall texture for ceiling
-    dungeon->ceilingTexture = dungeon->wallTexture;
-    
-    // If textures couldn't be loaded, create fallbacks
-    if (dungeon->wallTexture.id == 0) {
-        Image img = GenImageColor(128, 128, (Color){128, 128, 128, 255}); // Gray
-        dungeon->wallTexture = LoadTextureFromImage(img);
-        UnloadImage(img);
+// Generated wall or floor surface for a theme without texture files
+static TexGenParams GetThemeSurface(int theme, bool wall, TexGenChannel channel) {
+    TexGenParams params = { 0 };
+    params.channel = channel;
+    params.size = TEXGEN_DEFAULT_SIZE;
+    params.seed = 1 + theme * 2 + (wall ? 1 : 0);
+    params.normalStrength = 2.0f;
+    
+    if (theme == DUNGEON_THEME_CAVE) {
+        if (wall) {
+            params.pattern = TEXGEN_CAVE_ROCK;
+            params.baseColor = (Color){ 112, 98, 82, 255 };
+            params.accentColor = (Color){ 44, 38, 32, 255 };
+            params.featureScale = 6.0f;
+        } else {
+            params.pattern = TEXGEN_STONE;
+            params.baseColor = (Color){ 96, 88, 78, 255 };
+            params.accentColor = (Color){ 40, 35, 30, 255 };
+            params.featureScale = 5.0f;
+        }
+    } else {
+        if (wall) {
+            params.pattern = TEXGEN_CRYPT_BRICK;
+            params.baseColor = (Color){ 150, 150, 138, 255 };
+            params.accentColor = (Color){ 58, 60, 56, 255 };
+            params.featureScale = 8.0f;
+        } else {
+            params.pattern = TEXGEN_STONE;
+            params.baseColor = (Color){ 122, 120, 114, 255 };
+            params.accentColor = (Color){ 50, 50, 48, 255 };
+            params.featureScale = 4.0f;
+        }
     }
-    
-    if (dungeon->floorTexture.id == 0) {
-        Image img = GenImageColor(128, 128, (Color){139, 69, 19, 255}); // Brown
-        dungeon->floorTexture = LoadTextureFromImage(img);
-        UnloadImage(img);
+    return params;
+}
+
+// Queue the dungeon's files and theme surfaces on the loader (main thread)
+static void RequestThemeAssets(void* context) {
+    (void)context;
+
+    ReleaseAsset(RequestTexture(DUNGEON_WALL_TEXTURE, DUNGEON_WALL_FALLBACK));
+    ReleaseAsset(RequestTexture(DUNGEON_FLOOR_TEXTURE, DUNGEON_FLOOR_FALLBACK));
+    ReleaseAsset(RequestShader(DUNGEON_TILING_VS, DUNGEON_TILING_FS));
+    
+    // Every generated theme surface, so no level change has to generate
+    // one. Only the albedo is uploaded: no tile shader samples a normal map,
+    // and generating the albedo caches the normal map on disk regardless.
+    for (int theme = DUNGEON_THEME_CAVE; theme < DUNGEON_THEME_COUNT; theme++) {
+        for (int wall = 0; wall <= 1; wall++) {
+            TexGenParams albedo = GetThemeSurface(theme, wall, TEXGEN_ALBEDO);
+            ReleaseAsset(RequestGeneratedTexture(&albedo));
+        }
+    }
+}
+
+// Start loading the dungeon's files and generating the themes' surfaces in
+// the background. LoadDungeonAssets picks them up from the registry once
+// they are ready.
+void RequestDungeonAssets(void) {
+    RunOnMainThread(RequestThemeAssets, NULL);
+}
+
+// Keep a registry handle so UnloadDungeon can release it
+static AssetHandle TrackDungeonAsset(Dungeon* dungeon, AssetHandle handle) {
+    if (dungeon->assetCount < DUNGEON_MAX_ASSETS) {
+        dungeon->assets[dungeon->assetCount++] = handle;
+    }
+    return handle;
+}
+
+// Acquire a shared tile model and give it a diffuse texture
+static Model AcquireTileModel(Dungeon* dungeon, const char* key, MeshShape shape, Vector3 size, int detail,
+                              Texture2D texture) {
+    AssetHandle handle = TrackDungeonAsset(dungeon, AcquireMeshModel(key, shape, size, detail));
+    Model* model = GetModelAsset(handle);
+    if (model == NULL) return (Model){0};
+    
+    model->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = texture;
+    return *model;
+}
+
+// Take the theme's assets from the registry and set up the shared tile
+// models (main thread)
+static void AcquireDungeonAssets(void* context) {
+    Dungeon* dungeon = (Dungeon*)context;
+    int theme = dungeon->theme;
+    dungeon->assetCount = 0;
+    
+    if (theme == DUNGEON_THEME_DUNGEON) {
+        // Load actual textures for floor and walls, with flat fallbacks if missing
+        dungeon->wallTexture = GetTextureAsset(TrackDungeonAsset(dungeon, 
+            AcquireTexture(DUNGEON_WALL_TEXTURE, DUNGEON_WALL_FALLBACK)));
+        dungeon->floorTexture = GetTextureAsset(TrackDungeonAsset(dungeon, 
+            AcquireTexture(DUNGEON_FLOOR_TEXTURE, DUNGEON_FLOOR_FALLBACK)));
+    } else {
+        // Generated surfaces - usually warmed up already, else read from
+        // the disk cache or generated now
+        TexGenParams wallAlbedo = GetThemeSurface(theme, true, TEXGEN_ALBEDO);
+        TexGenParams floorAlbedo = GetThemeSurface(theme, false, TEXGEN_ALBEDO);
+        dungeon->wallTexture = GetTextureAsset(TrackDungeonAsset(dungeon, AcquireGeneratedTexture(&wallAlbedo)));
+        dungeon->floorTexture = GetTextureAsset(TrackDungeonAsset(dungeon, AcquireGeneratedTexture(&floorAlbedo)));
     }
     
-    // No need for ceiling texture fallback as we're using wall texture
-    
-    // Create fallback images for other textures
-    Image img;
-    
-    // Door texture (dark brown) - now using wall texture instead
+    // Ceiling and doors reuse the wall texture - aliases, not extra references
+    dungeon->ceilingTexture = dungeon->wallTexture;
     dungeon->doorTexture = dungeon->wallTexture;
     
-    // Stairs texture (white)
-    img = GenImageColor(128, 128, (Color){200, 200, 200, 255});
-    dungeon->stairsTexture = LoadTextureFromImage(img);
-    UnloadImage(img);
-    
-    // Trap texture (red)
-    img = GenImageColor(128, 128, (Color){200, 0, 0, 255});
-    dungeon->trapTexture = LoadTextureFromImage(img);
-    UnloadImage(img);
-    
-    // Chest texture (yellow)
-    img = GenImageColor(128, 128, (Color){218, 165, 32, 255});
-    dungeon->chestTexture = LoadTextureFromImage(img);
-    UnloadImage(img);
-    
-    // Set material for each model
-    dungeon->wallModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->wallTexture;
-    dungeon->floorModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->floorTexture;
-    dungeon->ceilingModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->ceilingTexture;
-    dungeon->doorModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->wallTexture; // Use wall texture for doors
-    dungeon->stairsUpModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->stairsTexture;
-    dungeon->stairsDownModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->stairsTexture;
-    dungeon->trapModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->trapTexture;
-    dungeon->chestModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->chestTexture;
+    // Flat colored textures for the remaining tiles
+    dungeon->stairsTexture = GetTextureAsset(TrackDungeonAsset(dungeon, 
+        AcquireColorTexture(128, (Color){200, 200, 200, 255})));            // White
+    dungeon->trapTexture = GetTextureAsset(TrackDungeonAsset(dungeon, 
+        AcquireColorTexture(128, (Color){200, 0, 0, 255})));                // Red
+    dungeon->chestTexture = GetTextureAsset(TrackDungeonAsset(dungeon, 
+        AcquireColorTexture(128, (Color){218, 165, 32, 255})));             // Yellow
     
     // Configure texture wrapping for proper tiling
     SetTextureWrap(dungeon->wallTexture, TEXTURE_WRAP_REPEAT);
     SetTextureWrap(dungeon->floorTexture, TEXTURE_WRAP_REPEAT);
-    SetTextureWrap(dungeon->ceilingTexture, TEXTURE_WRAP_REPEAT);
-    
-    // Configure texture wrapping mode for proper tiling
-    SetTextureWrap(dungeon->wallTexture, TEXTURE_WRAP_REPEAT);  
-    SetTextureWrap(dungeon->floorTexture, TEXTURE_WRAP_REPEAT);
-    SetTextureWrap(dungeon->ceilingTexture, TEXTURE_WRAP_REPEAT);
     
-    // Make sure textures are properly assigned to models
-    dungeon->wallModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->wallTexture;
-    dungeon->floorModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->floorTexture;
-    dungeon->ceilingModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->ceilingTexture;
-    dungeon->doorModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = dungeon->wallTexture;
-    
-    // Load custom shader for wall texture tiling
-    dungeon->tilingShader = LoadShader(
-        "assets/shaders/custom_tiling.vs",   // Vertex shader
-        "assets/shaders/custom_tiling.fs"    // Fragment shader
-    );
+    // Create models using raylib primitives
+    // Floor and ceiling with 2x2 segments for better texture mapping, walls 1x3x1,
+    // doors increased in height to match walls
+    dungeon->floorModel = AcquireTileModel(dungeon, "dungeon/floor", MESH_SHAPE_PLANE, 
+                                           (Vector3){1.0f, 0.0f, 1.0f}, 2, dungeon->floorTexture);
+    dungeon->wallModel = AcquireTileModel(dungeon, "dungeon/wall", MESH_SHAPE_CUBE, 
+                                          (Vector3){1.0f, 3.0f, 1.0f}, 1, dungeon->wallTexture);
+    dungeon->ceilingModel = AcquireTileModel(dungeon, "dungeon/ceiling", MESH_SHAPE_PLANE, 
+                                             (Vector3){1.0f, 0.0f, 1.0f}, 2, dungeon->ceilingTexture);
+    dungeon->doorModel = AcquireTileModel(dungeon, "dungeon/door", MESH_SHAPE_CUBE, 
+                                          (Vector3){1.0f, 3.0f, 0.2f}, 1, dungeon->doorTexture);
+    dungeon->stairsUpModel = AcquireTileModel(dungeon, "dungeon/stairs_up", MESH_SHAPE_CUBE, 
+                                              (Vector3){1.0f, 0.5f, 1.0f}, 1, dungeon->stairsTexture);
+    dungeon->stairsDownModel = AcquireTileModel(dungeon, "dungeon/stairs_down", MESH_SHAPE_CUBE, 
+                                                (Vector3){1.0f, 0.5f, 1.0f}, 1, dungeon->stairsTexture);
+    dungeon->trapModel = AcquireTileModel(dungeon, "dungeon/trap", MESH_SHAPE_PLANE, 
+                                          (Vector3){0.8f, 0.0f, 0.8f}, 1, dungeon->trapTexture);
+    dungeon->chestModel = AcquireTileModel(dungeon, "dungeon/chest", MESH_SHAPE_CUBE, 
+                                           (Vector3){0.8f, 0.5f, 0.5f}, 1, dungeon->chestTexture);
+    
+    // Load custom shader for wall texture tiling (compiled once per process)
+    dungeon->tilingShader = GetShaderAsset(TrackDungeonAsset(dungeon, 
+        AcquireShader(DUNGEON_TILING_VS, DUNGEON_TILING_FS)));
     
     // Get shader locations for uniforms
     int tilingLoc = GetShaderLocation(dungeon->tilingShader, "tiling");
@@ -479,43 +506,69 @@ void LoadDungeonAssets(Dungeon* dungeon, int theme) {
     dungeon->wallModel.materials[0].shader = dungeon->tilingShader;
 }
 
-// Draw the dungeon
-void DrawDungeon(Dungeon* dungeon) {
+// Load dungeon assets based on theme. Everything comes from the asset
+// registry, so a level change only takes new references to assets that
+// are already resident. The registry and the tile materials belong to the
+// main thread, which does the work while the caller waits.
+void LoadDungeonAssets(Dungeon* dungeon, int theme) {
+    dungeon->theme = theme;
+    RunOnMainThread(AcquireDungeonAssets, dungeon);
+}
+
+// Give the level's asset references back (main thread)
+static void ReleaseDungeonAssets(void* context) {
+    Dungeon* dungeon = (Dungeon*)context;
+    for (int i = 0; i < dungeon->assetCount; i++) {
+        ReleaseAsset(dungeon->assets[i]);
+    }
+    dungeon->assetCount = 0;
+}
+
+// Queue an unrotated tile model at unit scale
+static void QueueTileModel(RenderQueue* queue, const Model* model, Vector3 position, Color tint) {
+    QueueModel(queue, model, position, (Vector3){0.0f, 1.0f, 0.0f}, 0.0f, (Vector3){1.0f, 1.0f, 1.0f}, tint);
+}
+
+// Submit the dungeon's tiles to the render queue
+void DrawDungeon(Dungeon* dungeon, RenderQueue* queue) {
     // Draw each tile
     for (int x = 0; x < dungeon->width; x++) {
         for (int y = 0; y < dungeon->height; y++) {
             TileType tile = dungeon->tiles[x][y];
             
+            // Baked lighting is applied as a tint on the tile's models
+            Color light = GetTileLight(dungeon, x, y);
+            
             switch (tile) {
                 case TILE_FLOOR:
                     // Draw floor
-                    DrawModel(dungeon->floorModel, (Vector3){x, 0.0f, y}, 1.0f, WHITE);
+                    QueueTileModel(queue, &dungeon->floorModel, (Vector3){x, 0.0f, y}, light);
                     
                     // Draw ceiling - rotated 180 degrees around X-axis to face downward
-                    DrawModelEx(dungeon->ceilingModel, 
-                               (Vector3){x, 3.0f, y}, 
-                               (Vector3){1.0f, 0.0f, 0.0f}, 
-                               180.0f, 
-                               (Vector3){1.0f, 1.0f, 1.0f}, 
-                               WHITE);
+                    QueueModel(queue, &dungeon->ceilingModel, 
+                              (Vector3){x, 3.0f, y}, 
+                              (Vector3){1.0f, 0.0f, 0.0f}, 
+                              180.0f, 
+                              (Vector3){1.0f, 1.0f, 1.0f}, 
+                              light);
                     break;
                     
                 case TILE_WALL:
                     // Draw wall - adjusted Y position to account for taller walls
-                    DrawModel(dungeon->wallModel, (Vector3){x, 1.5f, y}, 1.0f, WHITE);
+                    QueueTileModel(queue, &dungeon->wallModel, (Vector3){x, 1.5f, y}, light);
                     break;
                     
                 case TILE_DOOR:
                     // Draw floor under door
-                    DrawModel(dungeon->floorModel, (Vector3){x, 0.0f, y}, 1.0f, WHITE);
+                    QueueTileModel(queue, &dungeon->floorModel, (Vector3){x, 0.0f, y}, light);
                     
                     // Draw ceiling above door
-                    DrawModelEx(dungeon->ceilingModel, 
-                               (Vector3){x, 3.0f, y}, 
-                               (Vector3){1.0f, 0.0f, 0.0f}, 
-                               180.0f, 
-                               (Vector3){1.0f, 1.0f, 1.0f}, 
-                               WHITE);
+                    QueueModel(queue, &dungeon->ceilingModel, 
+                              (Vector3){x, 3.0f, y}, 
+                              (Vector3){1.0f, 0.0f, 0.0f}, 
+                              180.0f, 
+                              (Vector3){1.0f, 1.0f, 1.0f}, 
+                              light);
                     
                     // Determine door orientation
                     bool isHorizontalCorridor = false;
@@ -527,89 +580,89 @@ void DrawDungeon(Dungeon* dungeon) {
                     // Draw door with appropriate rotation
                     if (isHorizontalCorridor) {
                         // Door facing north-south
-                        DrawModelEx(dungeon->doorModel, 
-                                   (Vector3){x, 1.5f, y}, 
-                                   (Vector3){0.0f, 1.0f, 0.0f}, 
-                                   90.0f, 
-                                   (Vector3){1.0f, 1.0f, 1.0f}, 
-                                   WHITE);
+                        QueueModel(queue, &dungeon->doorModel, 
+                                  (Vector3){x, 1.5f, y}, 
+                                  (Vector3){0.0f, 1.0f, 0.0f}, 
+                                  90.0f, 
+                                  (Vector3){1.0f, 1.0f, 1.0f}, 
+                                  light);
                     } else {
                         // Door facing east-west
-                        DrawModelEx(dungeon->doorModel, 
-                                   (Vector3){x, 1.5f, y}, 
-                                   (Vector3){0.0f, 1.0f, 0.0f}, 
-                                   0.0f, 
-                                   (Vector3){1.0f, 1.0f, 1.0f}, 
-                                   WHITE);
+                        QueueModel(queue, &dungeon->doorModel, 
+                                  (Vector3){x, 1.5f, y}, 
+                                  (Vector3){0.0f, 1.0f, 0.0f}, 
+                                  0.0f, 
+                                  (Vector3){1.0f, 1.0f, 1.0f}, 
+                                  light);
                     }
                     break;
                     
                 case TILE_STAIRS_UP:
                     // Draw stairs up
-                    DrawModel(dungeon->floorModel, (Vector3){x, 0.0f, y}, 1.0f, WHITE);
+                    QueueTileModel(queue, &dungeon->floorModel, (Vector3){x, 0.0f, y}, light);
                     
                     // Draw ceiling above stairs
-                    DrawModelEx(dungeon->ceilingModel, 
-                               (Vector3){x, 3.0f, y}, 
-                               (Vector3){1.0f, 0.0f, 0.0f}, 
-                               180.0f, 
-                               (Vector3){1.0f, 1.0f, 1.0f}, 
-                               WHITE);
+                    QueueModel(queue, &dungeon->ceilingModel, 
+                              (Vector3){x, 3.0f, y}, 
+                              (Vector3){1.0f, 0.0f, 0.0f}, 
+                              180.0f, 
+                              (Vector3){1.0f, 1.0f, 1.0f}, 
+                              light);
                     
-                    DrawModelEx(dungeon->stairsUpModel, 
-                               (Vector3){x, 0.25f, y}, 
-                               (Vector3){1.0f, 0.0f, 0.0f}, 
-                               20.0f, 
-                               (Vector3){1.0f, 1.0f, 1.0f}, 
-                               WHITE);
+                    QueueModel(queue, &dungeon->stairsUpModel, 
+                              (Vector3){x, 0.25f, y}, 
+                              (Vector3){1.0f, 0.0f, 0.0f}, 
+                              20.0f, 
+                              (Vector3){1.0f, 1.0f, 1.0f}, 
+                              light);
                     break;
                     
                 case TILE_STAIRS_DOWN:
                     // Draw stairs down
-                    DrawModel(dungeon->floorModel, (Vector3){x, 0.0f, y}, 1.0f, WHITE);
+                    QueueTileModel(queue, &dungeon->floorModel, (Vector3){x, 0.0f, y}, light);
                     
                     // Draw ceiling above stairs
-                    DrawModelEx(dungeon->ceilingModel, 
-                               (Vector3){x, 3.0f, y}, 
-                               (Vector3){1.0f, 0.0f, 0.0f}, 
-                               180.0f, 
-                               (Vector3){1.0f, 1.0f, 1.0f}, 
-                               WHITE);
+                    QueueModel(queue, &dungeon->ceilingModel, 
+                              (Vector3){x, 3.0f, y}, 
+                              (Vector3){1.0f, 0.0f, 0.0f}, 
+                              180.0f, 
+                              (Vector3){1.0f, 1.0f, 1.0f}, 
+                              light);
                     
-                    DrawModelEx(dungeon->stairsDownModel, 
-                               (Vector3){x, 0.25f, y}, 
-                               (Vector3){1.0f, 0.0f, 0.0f}, 
-                               -20.0f, 
-                               (Vector3){1.0f, 1.0f, 1.0f}, 
-                               WHITE);
+                    QueueModel(queue, &dungeon->stairsDownModel, 
+                              (Vector3){x, 0.25f, y}, 
+                              (Vector3){1.0f, 0.0f, 0.0f}, 
+                              -20.0f, 
+                              (Vector3){1.0f, 1.0f, 1.0f}, 
+                              light);
                     break;
                     
                 case TILE_TRAP:
                     // Draw floor with trap
-                    DrawModel(dungeon->floorModel, (Vector3){x, 0.0f, y}, 1.0f, WHITE);
-                    DrawModel(dungeon->trapModel, (Vector3){x, 0.01f, y}, 1.0f, WHITE);
+                    QueueTileModel(queue, &dungeon->floorModel, (Vector3){x, 0.0f, y}, light);
+                    QueueTileModel(queue, &dungeon->trapModel, (Vector3){x, 0.01f, y}, light);
                     
                     // Draw ceiling above trap
-                    DrawModelEx(dungeon->ceilingModel, 
-                               (Vector3){x, 3.0f, y}, 
-                               (Vector3){1.0f, 0.0f, 0.0f}, 
-                               180.0f, 
-                               (Vector3){1.0f, 1.0f, 1.0f}, 
-                               WHITE);
+                    QueueModel(queue, &dungeon->ceilingModel, 
+                              (Vector3){x, 3.0f, y}, 
+                              (Vector3){1.0f, 0.0f, 0.0f}, 
+                              180.0f, 
+                              (Vector3){1.0f, 1.0f, 1.0f}, 
+                              light);
                     break;
                     
                 case TILE_CHEST:
                     // Draw floor with chest
-                    DrawModel(dungeon->floorModel, (Vector3){x, 0.0f, y}, 1.0f, WHITE);
-                    DrawModel(dungeon->chestModel, (Vector3){x, 0.25f, y}, 1.0f, WHITE);
+                    QueueTileModel(queue, &dungeon->floorModel, (Vector3){x, 0.0f, y}, light);
+                    QueueTileModel(queue, &dungeon->chestModel, (Vector3){x, 0.25f, y}, light);
                     
                     // Draw ceiling above chest
-                    DrawModelEx(dungeon->ceilingModel, 
-                               (Vector3){x, 3.0f, y}, 
-                               (Vector3){1.0f, 0.0f, 0.0f}, 
-                               180.0f, 
-                               (Vector3){1.0f, 1.0f, 1.0f}, 
-                               WHITE);
+                    QueueModel(queue, &dungeon->ceilingModel, 
+                              (Vector3){x, 3.0f, y}, 
+                              (Vector3){1.0f, 0.0f, 0.0f}, 
+                              180.0f, 
+                              (Vector3){1.0f, 1.0f, 1.0f}, 
+                              light);
                     break;
                     
                 default:
@@ -636,31 +689,19 @@ void UnloadDungeon(Dungeon* dungeon) {
         dungeon->rooms = NULL;
     }
     
-    // Unload shader before models to avoid referencing freed resources
-    UnloadShader(dungeon->tilingShader);
-    
-    // Unload models
-    UnloadModel(dungeon->wallModel);
-    UnloadModel(dungeon->floorModel);
-    UnloadModel(dungeon->ceilingModel);
-    UnloadModel(dungeon->doorModel);
-    UnloadModel(dungeon->stairsUpModel);
-    UnloadModel(dungeon->stairsDownModel);
-    UnloadModel(dungeon->trapModel);
-    UnloadModel(dungeon->chestModel);
-    
-    // Unload textures
-    UnloadTexture(dungeon->wallTexture);
-    UnloadTexture(dungeon->floorTexture);
-    // Don't unload ceiling texture separately since it's a reference to the wall texture
-    // UnloadTexture(dungeon->ceilingTexture);
-    UnloadTexture(dungeon->doorTexture);
-    UnloadTexture(dungeon->stairsTexture);
-    UnloadTexture(dungeon->trapTexture);
-    UnloadTexture(dungeon->chestTexture);
-    
-    // Unload decorative props
-    UnloadProps();
+    // Free the torch lights and baked lighting
+    if (dungeon->torches != NULL) {
+        free(dungeon->torches);
+        dungeon->torches = NULL;
+    }
+    dungeon->torchCount = 0;
+    UnloadDungeonLighting(dungeon);
+    UnloadTorchShadowMaps(dungeon);
+    UnloadNavGraph(dungeon);
+    
+    // Release the level's references - the assets stay resident in the
+    // registry for the next level
+    RunOnMainThread(ReleaseDungeonAssets, dungeon);
     
     // Reset dungeon properties
     dungeon->width = 0;
@@ -682,104 +723,6 @@ Vector3 GetRandomFloorPosition(Dungeon* dungeon) {
     return (Vector3){x, 0.0f, y};
 }
 
-// Check if a position is walkable considering the player's radius
-bool IsWalkable(Dungeon* dungeon, float x, float z, float radius) {
-    // Quick bounds check for efficiency
-    if (!IsInsideDungeon(dungeon, x, z)) {
-        return false;
-    }
-    
-    // Make the player collider smaller as requested
-    // Using a smaller percentage of the player's radius for collision
-    float collisionRadius = radius * 0.65f;
-    
-    // First check the center tile directly
-    int centerX = (int)floorf(x);
-    int centerZ = (int)floorf(z);
-    
-    // Check if the center tile is a wall
-    if (dungeon->tiles[centerX][centerZ] == TILE_WALL) {
-        return false;
-    }
-    
-    // Define check points using a directionally-aware approach
-    // We'll create more check points in the south/east directions to fix the inconsistency
-    
-    // Create a set of points to check around the player
-    // These points form a collision shape that's slightly larger to the south/east
-    // to address the directional inconsistency
-    
-    // Cardinal directions first (N, E, S, W)
-    float pointsToCheck[12][2] = {
-        // North direction
-        {x, z - collisionRadius},
-        // East direction (slightly extended)
-        {x + collisionRadius * 1.1f, z},
-        // South direction (slightly extended)
-        {x, z + collisionRadius * 1.1f},
-        // West direction
-        {x - collisionRadius, z},
-        // NE corner
-        {x + collisionRadius * 0.7f, z - collisionRadius * 0.7f},
-        // SE corner (extended)
-        {x + collisionRadius * 0.8f, z + collisionRadius * 0.8f},
-        // SW corner (extended)
-        {x - collisionRadius * 0.7f, z + collisionRadius * 0.8f},
-        // NW corner
-        {x - collisionRadius * 0.7f, z - collisionRadius * 0.7f},
-        // Additional south point
-        {x - collisionRadius * 0.3f, z + collisionRadius},
-        {x + collisionRadius * 0.3f, z + collisionRadius},
-        // Additional east point
-        {x + collisionRadius, z - collisionRadius * 0.3f},
-        {x + collisionRadius, z + collisionRadius * 0.3f}
-    };
-    
-    // Check each point for wall collision
-    for (int i = 0; i < 12; i++) {
-        float checkX = pointsToCheck[i][0];
-        float checkZ = pointsToCheck[i][1];
-        
-        // Handle tile coordinate conversion differently based on direction
-        // This is key to fixing the directional inconsistency
-        int tileX, tileZ;
-        
-        // Special handling for positive directions (south/east) to fix the clipping issue
-        // When moving in positive direction, we need to be more strict with collision detection
-        if (checkX > x) { // East direction
-            // For east direction, ceil the value slightly to expand collision boundary
-            tileX = (int)ceilf(checkX - 0.01f);
-        } else {
-            // For west direction, floor the value
-            tileX = (int)floorf(checkX);
-        }
-        
-        if (checkZ > z) { // South direction
-            // For south direction, ceil the value slightly to expand collision boundary
-            tileZ = (int)ceilf(checkZ - 0.01f);
-        } else {
-            // For north direction, floor the value
-            tileZ = (int)floorf(checkZ);
-        }
-        
-        // Verify this point is within dungeon bounds
-        if (tileX >= 0 && tileX < dungeon->width && 
-            tileZ >= 0 && tileZ < dungeon->height) {
-            
-            // If this point is in a wall, the position is not walkable
-            if (dungeon->tiles[tileX][tileZ] == TILE_WALL) {
-                return false;
-            }
-        } else {
-            // Point is outside dungeon bounds
-            return false;
-        }
-    }
-    
-    // All checks passed, the position is walkable
-    return true;
-}
-
 // Check if a position is inside the dungeon bounds
 bool IsInsideDungeon(Dungeon* dungeon, float x, float z) {
     int tileX = (int)x;
@@ -1,4 +1,5 @@
 #include "../include/dungeon.h"
+#include "../include/dungeon_props.h"
 #include "raymath.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -8,6 +9,29 @@
 Model torchModel, barrelModel, crateModel, tableModel;
 Texture2D torchTexture, barrelTexture, crateTexture, tableTexture;
 
+// Registry handles behind the prop models and textures
+#define PROP_ASSET_COUNT 8
+static AssetHandle propAssets[PROP_ASSET_COUNT];
+static int propAssetCount = 0;
+
+// Acquire a shared prop model with a flat colored texture
+static Model AcquirePropModel(const char* key, MeshShape shape, Vector3 size, int detail, Color color,
+                              Texture2D* texture) {
+    AssetHandle textureHandle = AcquireColorTexture(64, color);
+    AssetHandle modelHandle = AcquireMeshModel(key, shape, size, detail);
+    if (propAssetCount + 2 <= PROP_ASSET_COUNT) {
+        propAssets[propAssetCount++] = textureHandle;
+        propAssets[propAssetCount++] = modelHandle;
+    }
+    
+    *texture = GetTextureAsset(textureHandle);
+    Model* model = GetModelAsset(modelHandle);
+    if (model == NULL) return (Model){0};
+    
+    model->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = *texture;
+    return *model;
+}
+
 // Function to clear 90-degree corners for better navigation
 void ClearCornerBlocks(Dungeon* dungeon) {
     // Scan through the dungeon to find and clear 90-degree corners
@@ -48,130 +72,148 @@ void ClearCornerBlocks(Dungeon* dungeon) {
     }
 }
 
+// Create the prop models with basic colored textures. They are shared by
+// every level, so this runs once, on the main thread, before the first.
+void LoadPropModels() {
+    if (propAssetCount > 0) return;
+    
+    torchModel = AcquirePropModel("props/torch", MESH_SHAPE_CYLINDER, (Vector3){0.05f, 0.5f, 0.0f}, 8, 
+                                  (Color){200, 150, 50, 255}, &torchTexture);
+    barrelModel = AcquirePropModel("props/barrel", MESH_SHAPE_CYLINDER, (Vector3){0.3f, 0.6f, 0.0f}, 8, 
+                                   (Color){139, 69, 19, 255}, &barrelTexture);
+    crateModel = AcquirePropModel("props/crate", MESH_SHAPE_CUBE, (Vector3){0.5f, 0.5f, 0.5f}, 1, 
+                                  (Color){160, 120, 80, 255}, &crateTexture);
+    tableModel = AcquirePropModel("props/table", MESH_SHAPE_CUBE, (Vector3){0.8f, 0.5f, 0.5f}, 1, 
+                                  (Color){120, 80, 40, 255}, &tableTexture);
+}
+
 // Function to add decorative props to the dungeon
 void AddDecorativeProps(Dungeon* dungeon) {
-    // Create prop models
-    torchModel = LoadModelFromMesh(GenMeshCylinder(0.05f, 0.5f, 8));
-    barrelModel = LoadModelFromMesh(GenMeshCylinder(0.3f, 0.6f, 8));
-    crateModel = LoadModelFromMesh(GenMeshCube(0.5f, 0.5f, 0.5f));
-    tableModel = LoadModelFromMesh(GenMeshCube(0.8f, 0.5f, 0.5f));
-    
-    // Create basic colored textures for props
-    Image torchImg = GenImageColor(64, 64, (Color){200, 150, 50, 255});
-    Image barrelImg = GenImageColor(64, 64, (Color){139, 69, 19, 255});
-    Image crateImg = GenImageColor(64, 64, (Color){160, 120, 80, 255});
-    Image tableImg = GenImageColor(64, 64, (Color){120, 80, 40, 255});
-    
-    torchTexture = LoadTextureFromImage(torchImg);
-    barrelTexture = LoadTextureFromImage(barrelImg);
-    crateTexture = LoadTextureFromImage(crateImg);
-    tableTexture = LoadTextureFromImage(tableImg);
-    
-    UnloadImage(torchImg);
-    UnloadImage(barrelImg);
-    UnloadImage(crateImg);
-    UnloadImage(tableImg);
-    
-    // Apply textures to models
-    torchModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = torchTexture;
-    barrelModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = barrelTexture;
-    crateModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = crateTexture;
-    tableModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = tableTexture;
-    
     // Place torches along walls
+    int torchCapacity = 0;
+    dungeon->torches = NULL;
+    dungeon->torchCount = 0;
+    
     for (int x = 1; x < dungeon->width - 1; x++) {
         for (int y = 1; y < dungeon->height - 1; y++) {
             // Place torches on walls with floor adjacent to them
             if (dungeon->tiles[x][y] == TILE_WALL) {
-                bool hasAdjacentFloor = false;
-                
-                // Check all four directions for adjacent floor
-                if ((x > 0 && dungeon->tiles[x-1][y] == TILE_FLOOR) ||
-                    (x < dungeon->width-1 && dungeon->tiles[x+1][y] == TILE_FLOOR) ||
-                    (y > 0 && dungeon->tiles[x][y-1] == TILE_FLOOR) ||
-                    (y < dungeon->height-1 && dungeon->tiles[x][y+1] == TILE_FLOOR)) {
-                    hasAdjacentFloor = true;
+                // Find the first adjacent floor tile for the torch to face
+                const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+                int facing = -1;
+                for (int i = 0; i < 4; i++) {
+                    if (dungeon->tiles[x + offsets[i][0]][y + offsets[i][1]] == TILE_FLOOR) {
+                        facing = i;
+                        break;
+                    }
                 }
                 
                 // Add a torch with a 5% chance if there's an adjacent floor
-                if (hasAdjacentFloor && GetRandomValue(0, 19) == 0) {
-                    // Store the torch position (we'll use a custom struct or array for this in a full implementation)
-                    // For this example, we'll just mark it in memory
-                    // In a full implementation, these would be stored in a prop list in the dungeon struct
+                if (facing >= 0 && GetRandomValue(0, 19) == 0) {
+                    // Grow the torch list as needed
+                    if (dungeon->torchCount >= torchCapacity) {
+                        torchCapacity = torchCapacity == 0 ? 32 : torchCapacity * 2;
+                        dungeon->torches = (TorchLight*)realloc(dungeon->torches, torchCapacity * sizeof(TorchLight));
+                    }
                     
-                    // Note: In a production game, you would:
-                    // 1. Create a Props array in the Dungeon struct
-                    // 2. Add each prop with its type, position, and rotation
-                    // 3. Render props in the rendering function
+                    // Mount the torch on the wall face, shining into the floor tile
+                    TorchLight* torch = &dungeon->torches[dungeon->torchCount++];
+                    torch->tileX = x + offsets[facing][0];
+                    torch->tileY = y + offsets[facing][1];
+                    torch->position = (Vector3){
+                        x + offsets[facing][0] * 0.5f,
+                        1.5f,
+                        y + offsets[facing][1] * 0.5f
+                    };
+                    torch->radius = 6.0f;
+                    torch->intensity = 0.9f;
+                    torch->color = (Color){255, 170, 90, 255};
                 }
             }
+        }
+    }
+}
+
+// Props placed on room floors, with their odds in 200 room tiles
+typedef struct {
+    PropKind kind;
+    const Model* model;
+    float height;
+    int chance;
+} PropPlacement;
+
+static const PropPlacement propPlacements[] = {
+    { PROP_BARREL, &barrelModel, 0.3f,  2 },    // 1%
+    { PROP_CRATE,  &crateModel,  0.25f, 2 },    // 1%
+    { PROP_TABLE,  &tableModel,  0.25f, 1 }     // 0.5%
+};
+
+// Pick the prop for a room tile, or NULL to leave it bare
+static const PropPlacement* RollPropPlacement(void) {
+    int roll = GetRandomValue(0, 199);
+    for (size_t i = 0; i < sizeof(propPlacements) / sizeof(propPlacements[0]); i++) {
+        if (roll < propPlacements[i].chance) return &propPlacements[i];
+        roll -= propPlacements[i].chance;
+    }
+    return NULL;
+}
+
+// Place barrels, crates and tables on room floors as prop entities. Their
+// models come from LoadPropModels.
+void SpawnPropEntities(World* world, Dungeon* dungeon) {
+    int spawned = 0;
+    for (int x = 2; x < dungeon->width - 2; x++) {
+        for (int y = 2; y < dungeon->height - 2; y++) {
+            // Simple heuristic: if there are floor tiles in all 4 directions, likely in a room
+            if (dungeon->tiles[x][y] != TILE_FLOOR ||
+                dungeon->tiles[x-1][y] != TILE_FLOOR || dungeon->tiles[x+1][y] != TILE_FLOOR ||
+                dungeon->tiles[x][y-1] != TILE_FLOOR || dungeon->tiles[x][y+1] != TILE_FLOOR) {
+                continue;
+            }
             
-            // Place barrels and crates in rooms (on floor tiles)
-            if (dungeon->tiles[x][y] == TILE_FLOOR) {
-                // Check if we're in a room (not a corridor)
-                bool isInRoom = false;
-                
-                // Simple heuristic: if there are floor tiles in all 4 directions, likely in a room
-                if (x > 1 && x < dungeon->width-2 && y > 1 && y < dungeon->height-2) {
-                    if (dungeon->tiles[x-1][y] == TILE_FLOOR && 
-                        dungeon->tiles[x+1][y] == TILE_FLOOR &&
-                        dungeon->tiles[x][y-1] == TILE_FLOOR && 
-                        dungeon->tiles[x][y+1] == TILE_FLOOR) {
-                        isInRoom = true;
-                    }
-                }
-                
-                // Add props with low probability to avoid cluttering
-                if (isInRoom) {
-                    // 1% chance for a barrel
-                    if (GetRandomValue(0, 99) == 0) {
-                        // Store barrel position for rendering
-                    }
-                    
-                    // 1% chance for a crate
-                    if (GetRandomValue(0, 99) == 0) {
-                        // Store crate position for rendering
-                    }
-                    
-                    // 0.5% chance for a table
-                    if (GetRandomValue(0, 199) == 0) {
-                        // Store table position for rendering
-                    }
-                }
+            // Add props with low probability to avoid cluttering
+            const PropPlacement* placement = RollPropPlacement();
+            if (placement == NULL) continue;
+            
+            Entity entity = CreateEntity(world);
+            WorldTransform* transform = (WorldTransform*)AddComponent(world, entity, COMPONENT_TRANSFORM);
+            Renderable* renderable = (Renderable*)AddComponent(world, entity, COMPONENT_RENDERABLE);
+            Prop* prop = (Prop*)AddComponent(world, entity, COMPONENT_PROP);
+            if (transform == NULL || renderable == NULL || prop == NULL) {
+                DestroyEntity(world, entity);
+                TraceLog(LOG_WARNING, "PROPS: World full after %d props", spawned);
+                return;
             }
+            
+            transform->position = (Vector3){ x + 0.5f, placement->height, y + 0.5f };
+            transform->rotation = GetRandomValue(0, 3) * 90.0f;
+            renderable->model = placement->model;
+            renderable->tint = WHITE;
+            prop->kind = placement->kind;
+            spawned++;
         }
     }
+    TraceLog(LOG_INFO, "PROPS: Placed %d props", spawned);
 }
 
-// Unload prop resources
+// Release prop resources back to the asset registry
 void UnloadProps() {
-    UnloadModel(torchModel);
-    UnloadModel(barrelModel);
-    UnloadModel(crateModel);
-    UnloadModel(tableModel);
-    
-    UnloadTexture(torchTexture);
-    UnloadTexture(barrelTexture);
-    UnloadTexture(crateTexture);
-    UnloadTexture(tableTexture);
+    for (int i = 0; i < propAssetCount; i++) {
+        ReleaseAsset(propAssets[i]);
+    }
+    propAssetCount = 0;
 }
 
-// Draw props - this would be called from the main rendering loop
-void DrawDungeonProps(Dungeon* dungeon) {
-    // In a full implementation, you would iterate through the prop list and draw each one
-    // For now, we'll just demonstrate the concept with placeholder props
-    
-    // Placeholder torch positions (in a real implementation, these would come from the dungeon's prop list)
-    DrawModel(torchModel, (Vector3){5.0f, 1.5f, 5.0f}, 1.0f, WHITE);
-    DrawModel(torchModel, (Vector3){10.0f, 1.5f, 8.0f}, 1.0f, WHITE);
-    
-    // Placeholder barrel positions
-    DrawModel(barrelModel, (Vector3){7.0f, 0.3f, 12.0f}, 1.0f, WHITE);
-    DrawModel(barrelModel, (Vector3){15.0f, 0.3f, 18.0f}, 1.0f, WHITE);
-    
-    // Placeholder crate positions
-    DrawModel(crateModel, (Vector3){9.0f, 0.25f, 7.0f}, 1.0f, WHITE);
-    
-    // Placeholder table position
-    DrawModel(tableModel, (Vector3){12.0f, 0.25f, 15.0f}, 1.0f, WHITE);
+// Queue an unrotated prop at unit scale
+static void QueueProp(RenderQueue* queue, const Model* model, Vector3 position) {
+    QueueModel(queue, model, position, (Vector3){0.0f, 1.0f, 0.0f}, 0.0f, (Vector3){1.0f, 1.0f, 1.0f}, WHITE);
+}
+
+// Submit the wall torches to the render queue - the other props are
+// entities and drawn with the world
+void DrawDungeonProps(Dungeon* dungeon, RenderQueue* queue) {
+    // Draw torches at their wall mounts
+    for (int i = 0; i < dungeon->torchCount; i++) {
+        QueueProp(queue, &torchModel, dungeon->torches[i].position);
+    }
 }
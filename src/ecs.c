@@ -0,0 +1,240 @@
+#include "../include/ecs.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Split a handle into its index and generation
+static int EntityIndex(Entity entity) {
+    return (int)(entity & ENTITY_INDEX_MASK);
+}
+
+static uint16_t EntityGeneration(Entity entity) {
+    return (uint16_t)(entity >> ENTITY_INDEX_BITS);
+}
+
+// Retire an index's current handles. Generations wrap within the bits a
+// handle has for them.
+static void BumpGeneration(World* world, int index) {
+    world->generations[index] = (world->generations[index] + 1) & ENTITY_GENERATION_MASK;
+}
+
+// Allocate entity bookkeeping. Component stores are registered separately,
+// each with its own capacity.
+void InitWorld(World* world, int maxEntities) {
+    memset(world, 0, sizeof(World));
+    if (maxEntities > (int)ENTITY_INDEX_MASK) maxEntities = (int)ENTITY_INDEX_MASK;
+
+    world->generations = (uint16_t*)calloc(maxEntities, sizeof(uint16_t));
+    world->freeIndices = (int*)malloc(maxEntities * sizeof(int));
+    world->pendingDestroy = (Entity*)malloc(maxEntities * sizeof(Entity));
+    if (world->generations == NULL || world->freeIndices == NULL || world->pendingDestroy == NULL) {
+        TraceLog(LOG_WARNING, "ECS: Failed to allocate a world of %d entities", maxEntities);
+        return;
+    }
+    world->capacity = maxEntities;
+}
+
+// Free the world and every component store
+void UnloadWorld(World* world) {
+    for (int i = 0; i < COMPONENT_COUNT; i++) {
+        free(world->stores[i].sparse);
+        free(world->stores[i].dense);
+        free(world->stores[i].data);
+    }
+    free(world->generations);
+    free(world->freeIndices);
+    free(world->pendingDestroy);
+    memset(world, 0, sizeof(World));
+}
+
+// Destroy every entity at once, e.g. on a level change. Systems stay
+// registered and outstanding handles stop resolving.
+void ClearWorld(World* world) {
+    for (int i = 0; i < COMPONENT_COUNT; i++) {
+        ComponentStore* store = &world->stores[i];
+        for (int j = 0; j < store->count; j++) {
+            store->sparse[EntityIndex(store->dense[j])] = -1;
+        }
+        store->count = 0;
+    }
+
+    for (int i = 0; i < world->used; i++) {
+        BumpGeneration(world, i);
+    }
+    world->used = 0;
+    world->freeCount = 0;
+    world->liveCount = 0;
+    world->pendingCount = 0;
+}
+
+// Set up storage for one component type. Capacity bounds how many
+// entities can hold it at once.
+void RegisterComponent(World* world, ComponentType type, size_t size, int capacity) {
+    ComponentStore* store = &world->stores[type];
+    store->sparse = (int*)malloc(world->capacity * sizeof(int));
+    store->dense = (Entity*)malloc(capacity * sizeof(Entity));
+    store->data = (unsigned char*)malloc(capacity * size);
+    store->size = size;
+    store->count = 0;
+    store->capacity = (store->sparse != NULL && store->dense != NULL && store->data != NULL) ? capacity : 0;
+
+    if (store->sparse != NULL) {
+        for (int i = 0; i < world->capacity; i++) store->sparse[i] = -1;
+    }
+}
+
+// Hand out a new entity with no components, or ENTITY_NONE when full
+Entity CreateEntity(World* world) {
+    int index;
+    if (world->freeCount > 0) {
+        index = world->freeIndices[--world->freeCount];
+    } else if (world->used < world->capacity) {
+        index = world->used++;
+    } else {
+        return ENTITY_NONE;
+    }
+
+    world->liveCount++;
+    return ((Entity)world->generations[index] << ENTITY_INDEX_BITS) | (Entity)index;
+}
+
+// Whether a handle still refers to a live entity
+bool IsEntityAlive(const World* world, Entity entity) {
+    int index = EntityIndex(entity);
+    return entity != ENTITY_NONE && index < world->used && world->generations[index] == EntityGeneration(entity);
+}
+
+// Queue an entity for destruction at the end of the running system
+void DestroyEntity(World* world, Entity entity) {
+    if (!IsEntityAlive(world, entity) || world->pendingCount >= world->capacity) return;
+    world->pendingDestroy[world->pendingCount++] = entity;
+}
+
+// Destroy the queued entities: strip their components and retire their
+// handles. An entity queued twice is destroyed once.
+void FlushDestroyedEntities(World* world) {
+    for (int i = 0; i < world->pendingCount; i++) {
+        Entity entity = world->pendingDestroy[i];
+        if (!IsEntityAlive(world, entity)) continue;
+
+        for (int type = 0; type < COMPONENT_COUNT; type++) {
+            RemoveComponent(world, entity, (ComponentType)type);
+        }
+
+        int index = EntityIndex(entity);
+        BumpGeneration(world, index);
+        world->freeIndices[world->freeCount++] = index;
+        world->liveCount--;
+    }
+    world->pendingCount = 0;
+}
+
+// Attach a zeroed component to an entity and return it. Returns the
+// existing one if the entity already has it, or NULL when the store is full.
+void* AddComponent(World* world, Entity entity, ComponentType type) {
+    ComponentStore* store = &world->stores[type];
+    if (store->capacity == 0 || !IsEntityAlive(world, entity)) return NULL;
+
+    int index = EntityIndex(entity);
+    if (store->sparse[index] >= 0) return store->data + store->sparse[index] * store->size;
+    if (store->count >= store->capacity) return NULL;
+
+    int position = store->count++;
+    store->sparse[index] = position;
+    store->dense[position] = entity;
+
+    void* component = store->data + position * store->size;
+    memset(component, 0, store->size);
+    return component;
+}
+
+// Detach a component, moving the last one into its place so the store
+// stays contiguous
+void RemoveComponent(World* world, Entity entity, ComponentType type) {
+    ComponentStore* store = &world->stores[type];
+    if (store->count == 0) return;
+
+    int index = EntityIndex(entity);
+    int position = store->sparse[index];
+    if (position < 0 || store->dense[position] != entity) return;
+
+    int last = --store->count;
+    if (position != last) {
+        store->dense[position] = store->dense[last];
+        memcpy(store->data + position * store->size, store->data + last * store->size, store->size);
+        store->sparse[EntityIndex(store->dense[position])] = position;
+    }
+    store->sparse[index] = -1;
+}
+
+// An entity's component, or NULL if it has none of that type
+void* GetComponent(World* world, Entity entity, ComponentType type) {
+    ComponentStore* store = &world->stores[type];
+    if (store->count == 0 || !IsEntityAlive(world, entity)) return NULL;
+
+    int position = store->sparse[EntityIndex(entity)];
+    return (position >= 0) ? store->data + position * store->size : NULL;
+}
+
+// Dense component data for systems that touch a single component type.
+// Valid for GetComponentCount elements until a component is added or removed.
+void* GetComponentArray(World* world, ComponentType type) {
+    return world->stores[type].data;
+}
+
+int GetComponentCount(const World* world, ComponentType type) {
+    return world->stores[type].count;
+}
+
+// Start iterating the entities that hold every component in the mask
+Query BeginQuery(World* world, unsigned mask) {
+    Query query = { world, mask, NULL, 0, ENTITY_NONE };
+
+    for (int type = 0; type < COMPONENT_COUNT; type++) {
+        if (!(mask & (1u << type))) continue;
+        ComponentStore* store = &world->stores[type];
+        if (query.driver == NULL || store->count < query.driver->count) query.driver = store;
+    }
+    if (query.driver != NULL) query.next = query.driver->count - 1;
+    return query;
+}
+
+// Advance to the next match. The driver is walked from the back, so
+// removing the current entity's components mid-query skips nothing.
+bool QueryNext(Query* query) {
+    if (query->driver == NULL) return false;
+
+    for (; query->next >= 0; query->next--) {
+        if (query->next >= query->driver->count) continue;
+
+        Entity entity = query->driver->dense[query->next];
+        int index = EntityIndex(entity);
+        bool matches = true;
+        for (int type = 0; type < COMPONENT_COUNT && matches; type++) {
+            if (query->mask & (1u << type)) matches = query->world->stores[type].sparse[index] >= 0;
+        }
+        if (matches) {
+            query->entity = entity;
+            query->next--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Append a system. Systems run in the order they were added.
+void AddSystem(World* world, const char* name, SystemFunction update) {
+    if (world->systemCount >= ECS_MAX_SYSTEMS) {
+        TraceLog(LOG_WARNING, "ECS: No room for system %s", name);
+        return;
+    }
+    world->systems[world->systemCount++] = (System){ name, update };
+}
+
+// Run one tick of every system in order, destroying what each one
+// queued before the next starts
+void RunSystems(World* world, void* context, float deltaTime) {
+    for (int i = 0; i < world->systemCount; i++) {
+        world->systems[i].update(world, context, deltaTime);
+        FlushDestroyedEntities(world);
+    }
+}
@@ -1,361 +1,624 @@
 #include "../include/enemy.h"
+#include "../include/nav_graph.h"
+#include "../include/jobs.h"
+#include "../include/collision.h"
 #include "raymath.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
+#if defined(__SSE2__) && !defined(ENEMY_SCALAR_UPDATE)
+#include <emmintrin.h>
+#endif
 
-// Initialize enemy with given type, position, and level
-void InitEnemy(Enemy* enemy, EnemyType type, Vector3 position, int level) {
+// Archetype table, compiled from data/enemies.def
+const EnemyArchetype enemyArchetypes[ENEMY_COUNT] = {
+#define ENEMY_DEF(id, color, width, height, radius, \
+                  speed, speedPerLevel, health, healthPerLevel, damage, damagePerLevel, \
+                  attackRange, detectionRange, patrolRadius, attackCooldown, \
+                  experience, experiencePerLevel, dropChance, dropChancePerLevel, \
+                  minGold, maxGold, maxGoldPerLevel, spawnCost, minLevel, projectileSpeed) \
+    [ENEMY_##id] = { #id, color, width, height, radius, \
+                     speed, speedPerLevel, health, healthPerLevel, damage, damagePerLevel, \
+                     attackRange, detectionRange, patrolRadius, attackCooldown, \
+                     experience, experiencePerLevel, dropChance, dropChancePerLevel, \
+                     minGold, maxGold, maxGoldPerLevel, spawnCost, minLevel, projectileSpeed },
+#include "../data/enemies.def"
+#undef ENEMY_DEF
+};
+
+// Registry models shared by every enemy of an archetype. Enemies point
+// at the copies here, which stay put when the registry grows.
+static AssetHandle archetypeHandles[ENEMY_COUNT];
+static Model archetypeModels[ENEMY_COUNT];
+static bool modelsLoaded = false;
+
+// Acquire the archetype models up front, so spawning never creates any
+void LoadEnemyModels(void) {
+    if (modelsLoaded) return;
+    
+    for (int i = 0; i < ENEMY_COUNT; i++) {
+        const EnemyArchetype* archetype = &enemyArchetypes[i];
+        char key[ASSET_KEY_LENGTH];
+        snprintf(key, sizeof(key), "enemy/%s", archetype->name);
+        
+        archetypeHandles[i] = AcquireMeshModel(key, MESH_SHAPE_CUBE,
+                                               (Vector3){archetype->width, archetype->height, archetype->width}, 0);
+        Model* model = GetModelAsset(archetypeHandles[i]);
+        if (model == NULL) continue;
+        
+        model->materials[0].maps[MATERIAL_MAP_DIFFUSE].color = archetype->color;
+        archetypeModels[i] = *model;
+    }
+    modelsLoaded = true;
+}
+
+// Drop the archetype model references
+void UnloadEnemyModels(void) {
+    if (!modelsLoaded) return;
+    
+    for (int i = 0; i < ENEMY_COUNT; i++) {
+        ReleaseAsset(archetypeHandles[i]);
+        archetypeModels[i] = (Model){0};
+    }
+    modelsLoaded = false;
+}
+
+// Initialize the enemy in a slot with given type, position, and level
+void InitEnemy(EnemyPool* pool, int slot, EnemyType type, Vector3 position, int level) {
+    const EnemyArchetype* archetype = &enemyArchetypes[type];
+    Enemy* enemy = &pool->enemies[slot];
+    
     enemy->type = type;
-    enemy->state = ENEMY_IDLE;
-    enemy->position = position;
-    enemy->velocity = (Vector3){0.0f, 0.0f, 0.0f};
-    enemy->direction = (Vector3){0.0f, 0.0f, 1.0f};
     enemy->spawnPosition = position;
-    enemy->rotationAngle = 0.0f;
     enemy->level = level;
-    enemy->isAlive = true;
-    
-    // Configure enemy properties based on type
-    switch (type) {
-        case ENEMY_SKELETON_BASIC:
-            enemy->speed = 2.0f + (level * 0.1f);
-            enemy->health = 20 + (level * 5);
-            enemy->maxHealth = enemy->health;
-            enemy->attackDamage = 5 + (level * 2);
-            enemy->attackRange = 1.2f;
-            enemy->detectionRange = 8.0f;
-            enemy->patrolRadius = 5.0f;
-            enemy->experienceValue = 10 + (level * 3);
-            enemy->attackCooldown = 1.5f;
-            enemy->height = 1.7f;
-            enemy->radius = 0.4f;
-            enemy->dropChance = 0.2f + (level * 0.03f);
-            enemy->minGold = 1;
-            enemy->maxGold = 5 + level;
-            break;
-            
-        case ENEMY_SKELETON_WARRIOR:
-            enemy->speed = 1.5f + (level * 0.1f);
-            enemy->health = 40 + (level * 8);
-            enemy->maxHealth = enemy->health;
-            enemy->attackDamage = 8 + (level * 3);
-            enemy->attackRange = 1.5f;
-            enemy->detectionRange = 7.0f;
-            enemy->patrolRadius = 4.0f;
-            enemy->experienceValue = 20 + (level * 5);
-            enemy->attackCooldown = 2.0f;
-            enemy->height = 1.8f;
-            enemy->radius = 0.5f;
-            enemy->dropChance = 0.3f + (level * 0.04f);
-            enemy->minGold = 3;
-            enemy->maxGold = 10 + (level * 2);
-            break;
-            
-        case ENEMY_SKELETON_ARCHER:
-            enemy->speed = 2.5f + (level * 0.15f);
-            enemy->health = 15 + (level * 4);
-            enemy->maxHealth = enemy->health;
-            enemy->attackDamage = 6 + (level * 2);
-            enemy->attackRange = 8.0f; // Ranged attack
-            enemy->detectionRange = 12.0f;
-            enemy->patrolRadius = 6.0f;
-            enemy->experienceValue = 15 + (level * 4);
-            enemy->attackCooldown = 3.0f;
-            enemy->height = 1.7f;
-            enemy->radius = 0.4f;
-            enemy->dropChance = 0.25f + (level * 0.03f);
-            enemy->minGold = 2;
-            enemy->maxGold = 8 + level;
-            break;
-            
-        case ENEMY_SKELETON_MAGE:
-            enemy->speed = 1.8f + (level * 0.1f);
-            enemy->health = 12 + (level * 3);
-            enemy->maxHealth = enemy->health;
-            enemy->attackDamage = 10 + (level * 4);
-            enemy->attackRange = 6.0f; // Ranged attack
-            enemy->detectionRange = 10.0f;
-            enemy->patrolRadius = 5.0f;
-            enemy->experienceValue = 25 + (level * 6);
-            enemy->attackCooldown = 4.0f;
-            enemy->height = 1.7f;
-            enemy->radius = 0.4f;
-            enemy->dropChance = 0.4f + (level * 0.05f);
-            enemy->minGold = 5;
-            enemy->maxGold = 15 + (level * 3);
-            break;
-            
-        default:
-            break;
+    
+    // Archetype stats scaled by level
+    enemy->health = archetype->health + level * archetype->healthPerLevel;
+    enemy->maxHealth = enemy->health;
+    enemy->attackDamage = archetype->attackDamage + level * archetype->attackDamagePerLevel;
+    enemy->patrolRadius = archetype->patrolRadius;
+    enemy->experienceValue = archetype->experienceValue + level * archetype->experiencePerLevel;
+    enemy->height = archetype->height;
+    enemy->radius = archetype->radius;
+    enemy->dropChance = archetype->dropChance + level * archetype->dropChancePerLevel;
+    enemy->minGold = archetype->minGold;
+    enemy->maxGold = archetype->maxGold + level * archetype->maxGoldPerLevel;
+    
+    // Placeholder model sized and tinted by the archetype
+    enemy->model = &archetypeModels[type];
+    enemy->navTile = -1;
+    enemy->hasNavStep = false;
+    
+    // Hot state the update kernels run on
+    pool->state[slot] = ENEMY_IDLE;
+    pool->positionX[slot] = position.x;
+    pool->positionY[slot] = position.y;
+    pool->positionZ[slot] = position.z;
+    pool->velocityX[slot] = 0.0f;
+    pool->velocityZ[slot] = 0.0f;
+    pool->directionX[slot] = 0.0f;
+    pool->directionZ[slot] = 1.0f;
+    pool->rotation[slot] = 0.0f;
+    pool->attackTimer[slot] = 0.0f;
+    pool->pathfindTimer[slot] = 0.0f;
+    pool->stateTimer[slot] = 0.0f;
+    pool->animTimer[slot] = 0.0f;
+    pool->attacking[slot] = 0;
+    pool->seesPlayer[slot] = 0;         // Set by the next sight pass
+    pool->stepTime[slot] = 0.0f;
+    pool->lodTime[slot] = 0.0f;
+    pool->lodTier[slot] = ENEMY_LOD_FULL;
+    pool->speed[slot] = archetype->speed + level * archetype->speedPerLevel;
+    pool->attackRange[slot] = archetype->attackRange;
+    pool->detectionRange[slot] = archetype->detectionRange;
+    pool->attackCooldown[slot] = archetype->attackCooldown;
+}
+
+// Choose a random point within the patrol radius and head for it
+static void RetargetPatrol(EnemyPool* pool, int slot) {
+    Enemy* enemy = &pool->enemies[slot];
+    float patrolAngle = GetRandomValue(0, 360) * DEG2RAD;
+    float patrolDistance = GetRandomValue(0, (int)(enemy->patrolRadius * 100)) / 100.0f;
+    
+    // Direction to the patrol target, which lies on the floor
+    float toTargetX = enemy->spawnPosition.x + cosf(patrolAngle) * patrolDistance - pool->positionX[slot];
+    float toTargetY = -pool->positionY[slot];
+    float toTargetZ = enemy->spawnPosition.z + sinf(patrolAngle) * patrolDistance - pool->positionZ[slot];
+    float length = sqrtf(toTargetX * toTargetX + toTargetY * toTargetY + toTargetZ * toTargetZ);
+    if (length > 0.1f) {
+        pool->directionX[slot] = toTargetX / length;
+        pool->directionZ[slot] = toTargetZ / length;
     }
     
-    // Reset timers
-    enemy->attackTimer = 0.0f;
-    enemy->pathfindTimer = 0.0f;
-    enemy->pathfindInterval = 1.0f;
-    enemy->stateTimer = 0.0f;
-    enemy->animTimer = 0.0f;
-    enemy->isAttacking = false;
-    
-    // Create a placeholder model based on enemy type
-    switch (type) {
-        case ENEMY_SKELETON_BASIC:
-            enemy->model = LoadModelFromMesh(GenMeshCube(0.8f, 1.7f, 0.8f));
-            break;
-        case ENEMY_SKELETON_WARRIOR:
-            enemy->model = LoadModelFromMesh(GenMeshCube(1.0f, 1.8f, 1.0f));
-            break;
-        case ENEMY_SKELETON_ARCHER:
-            enemy->model = LoadModelFromMesh(GenMeshCube(0.8f, 1.7f, 0.8f));
-            break;
-        case ENEMY_SKELETON_MAGE:
-            enemy->model = LoadModelFromMesh(GenMeshCube(0.8f, 1.7f, 0.8f));
-            break;
-        default:
-            enemy->model = LoadModelFromMesh(GenMeshCube(0.8f, 1.7f, 0.8f));
-            break;
+    pool->pathfindTimer[slot] = 0.0f;
+}
+
+// Awake enemies are simulated; dormant and dead slots are skipped
+static bool IsEnemyActive(int state) {
+    return state != ENEMY_DORMANT && state != ENEMY_DEAD;
+}
+
+// Point a chaser along its path to the player: the shared flow field near
+// the player, and a hierarchical route from beyond its edge, looked up
+// again each time the chaser enters a new tile. On the player's tile it
+// keeps heading straight for them.
+static void SteerChaser(EnemyPool* pool, Dungeon* dungeon, const FlowField* flowField, int slot,
+                        Vector3 playerPosition) {
+    float x = pool->positionX[slot];
+    float z = pool->positionZ[slot];
+    float directionX;
+    float directionZ;
+    if (SampleFlowField(flowField, x, z, &directionX, &directionZ)) {
+        pool->directionX[slot] = directionX;
+        pool->directionZ[slot] = directionZ;
+        return;
     }
     
-    // Apply different colors to different enemy types
-    Color enemyColor = WHITE;
-    switch (type) {
-        case ENEMY_SKELETON_BASIC:
-            enemyColor = GRAY;
-            break;
-        case ENEMY_SKELETON_WARRIOR:
-            enemyColor = DARKGRAY;
-            break;
-        case ENEMY_SKELETON_ARCHER:
-            enemyColor = BROWN;
-            break;
-        case ENEMY_SKELETON_MAGE:
-            enemyColor = PURPLE;
-            break;
-        default:
-            break;
+    int tileX = (int)floorf(x);
+    int tileZ = (int)floorf(z);
+    if (tileX == (int)floorf(playerPosition.x) && tileZ == (int)floorf(playerPosition.z)) return;
+    
+    Enemy* enemy = &pool->enemies[slot];
+    int tile = tileX * dungeon->height + tileZ;
+    if (tile != enemy->navTile) {
+        enemy->navTile = tile;
+        enemy->hasNavStep = FindNavStep(dungeon, (Vector3){ x, 0.0f, z }, playerPosition, &enemy->navStep);
     }
+    if (!enemy->hasNavStep) return;
     
-    // Set model material color
-    enemy->model.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = enemyColor;
+    float toStepX = enemy->navStep.x - x;
+    float toStepZ = enemy->navStep.z - z;
+    float length = sqrtf(toStepX * toStepX + toStepZ * toStepZ);
+    if (length > 0.0001f) {
+        pool->directionX[slot] = toStepX / length;
+        pool->directionZ[slot] = toStepZ / length;
+    }
+}
+
+#if defined(__SSE2__) && !defined(ENEMY_SCALAR_UPDATE)
+
+// Pick a where mask is set, b elsewhere
+static inline __m128 SelectFloat(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
 }
 
-// Update enemy behavior
-void UpdateEnemy(Enemy* enemy, Vector3 playerPosition, float deltaTime, bool canSeePlayer) {
-    if (!enemy->isAlive) return;
+static inline __m128i SelectInt(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Advance the timers, states and attacks of four consecutive slots at
+// once, each by its own scheduled step. Same rules as the scalar path.
+static void ThinkEnemyBatch(EnemyPool* pool, int base, Vector3 playerPosition) {
+    __m128 dt = _mm_load_ps(&pool->stepTime[base]);
+    __m128 zero = _mm_setzero_ps();
+    __m128 activeMask = _mm_cmpgt_ps(dt, zero);
+    if (_mm_movemask_ps(activeMask) == 0) return;
+    __m128i active = _mm_castps_si128(activeMask);
+    __m128i state = _mm_load_si128((const __m128i*)&pool->state[base]);
     
     // Update timers
-    enemy->attackTimer += deltaTime;
-    enemy->pathfindTimer += deltaTime;
-    enemy->stateTimer += deltaTime;
-    enemy->animTimer += deltaTime;
+    __m128 attackTimer = _mm_load_ps(&pool->attackTimer[base]);
+    __m128 stateTimer = _mm_load_ps(&pool->stateTimer[base]);
+    attackTimer = SelectFloat(activeMask, _mm_add_ps(attackTimer, dt), attackTimer);
+    stateTimer = SelectFloat(activeMask, _mm_add_ps(stateTimer, dt), stateTimer);
+    __m128 pathfindTimer = _mm_load_ps(&pool->pathfindTimer[base]);
+    _mm_store_ps(&pool->pathfindTimer[base], SelectFloat(activeMask, _mm_add_ps(pathfindTimer, dt), pathfindTimer));
+    __m128 animTimer = _mm_load_ps(&pool->animTimer[base]);
+    _mm_store_ps(&pool->animTimer[base], SelectFloat(activeMask, _mm_add_ps(animTimer, dt), animTimer));
     
     // Calculate distance to player
-    Vector3 toPlayer = Vector3Subtract(playerPosition, enemy->position);
-    float distanceToPlayer = Vector3Length(toPlayer);
+    __m128 positionX = _mm_load_ps(&pool->positionX[base]);
+    __m128 positionZ = _mm_load_ps(&pool->positionZ[base]);
+    __m128 toPlayerX = _mm_sub_ps(_mm_set1_ps(playerPosition.x), positionX);
+    __m128 toPlayerY = _mm_sub_ps(_mm_set1_ps(playerPosition.y), _mm_load_ps(&pool->positionY[base]));
+    __m128 toPlayerZ = _mm_sub_ps(_mm_set1_ps(playerPosition.z), positionZ);
+    __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(toPlayerX, toPlayerX), _mm_mul_ps(toPlayerY, toPlayerY)),
+                                             _mm_mul_ps(toPlayerZ, toPlayerZ)));
     
     // Decide state based on player position and visibility
-    if (distanceToPlayer <= enemy->attackRange && canSeePlayer) {
-        // If player is in attack range and visible
-        enemy->state = ENEMY_ATTACKING;
-    } else if (distanceToPlayer <= enemy->detectionRange && canSeePlayer) {
-        // If player is detected but not in attack range
-        enemy->state = ENEMY_CHASING;
-    } else if (enemy->state == ENEMY_CHASING) {
-        // If was chasing but lost sight of player
-        if (enemy->stateTimer > 5.0f) {
-            // After 5 seconds, go back to patrolling
-            enemy->state = ENEMY_PATROLLING;
-            enemy->stateTimer = 0.0f;
-        }
-    } else if (enemy->state == ENEMY_IDLE) {
-        // If idle for too long, start patrolling
-        if (enemy->stateTimer > 3.0f) {
-            enemy->state = ENEMY_PATROLLING;
-            enemy->stateTimer = 0.0f;
-        }
-    } else if (enemy->state == ENEMY_PATROLLING) {
-        // Continue patrolling
-        if (enemy->stateTimer > 10.0f) {
-            // After patrolling for a while, take a rest
-            enemy->state = ENEMY_IDLE;
-            enemy->stateTimer = 0.0f;
+    __m128i sees = _mm_load_si128((const __m128i*)&pool->seesPlayer[base]);
+    __m128i inAttackRange = _mm_and_si128(sees, _mm_castps_si128(_mm_cmple_ps(distance, _mm_load_ps(&pool->attackRange[base]))));
+    __m128i inDetectionRange = _mm_and_si128(sees, _mm_castps_si128(_mm_cmple_ps(distance, _mm_load_ps(&pool->detectionRange[base]))));
+    __m128i undecided = _mm_andnot_si128(_mm_or_si128(inAttackRange, inDetectionRange), _mm_set1_epi32(-1));
+    
+    // Lost sight while chasing, idle or patrolling too long
+    __m128i chaseTimeout = _mm_and_si128(_mm_cmpeq_epi32(state, _mm_set1_epi32(ENEMY_CHASING)),
+                                         _mm_castps_si128(_mm_cmpgt_ps(stateTimer, _mm_set1_ps(5.0f))));
+    __m128i idleTimeout = _mm_and_si128(_mm_cmpeq_epi32(state, _mm_set1_epi32(ENEMY_IDLE)),
+                                        _mm_castps_si128(_mm_cmpgt_ps(stateTimer, _mm_set1_ps(3.0f))));
+    __m128i patrolTimeout = _mm_and_si128(_mm_cmpeq_epi32(state, _mm_set1_epi32(ENEMY_PATROLLING)),
+                                          _mm_castps_si128(_mm_cmpgt_ps(stateTimer, _mm_set1_ps(10.0f))));
+    __m128i toPatrol = _mm_and_si128(undecided, _mm_or_si128(chaseTimeout, idleTimeout));
+    __m128i toIdle = _mm_and_si128(undecided, patrolTimeout);
+    
+    __m128i newState = state;
+    newState = SelectInt(inDetectionRange, _mm_set1_epi32(ENEMY_CHASING), newState);
+    newState = SelectInt(inAttackRange, _mm_set1_epi32(ENEMY_ATTACKING), newState);
+    newState = SelectInt(toPatrol, _mm_set1_epi32(ENEMY_PATROLLING), newState);
+    newState = SelectInt(toIdle, _mm_set1_epi32(ENEMY_IDLE), newState);
+    __m128i resetTimer = _mm_or_si128(toPatrol, toIdle);
+    
+    // Recover from stun after a while
+    __m128i recovered = _mm_and_si128(_mm_cmpeq_epi32(newState, _mm_set1_epi32(ENEMY_STUNNED)),
+                                      _mm_castps_si128(_mm_cmpgt_ps(stateTimer, _mm_set1_ps(1.0f))));
+    newState = SelectInt(recovered, _mm_set1_epi32(ENEMY_IDLE), newState);
+    resetTimer = _mm_or_si128(resetTimer, recovered);
+    stateTimer = SelectFloat(_mm_castsi128_ps(resetTimer), zero, stateTimer);
+    
+    newState = SelectInt(active, newState, state);
+    _mm_store_si128((__m128i*)&pool->state[base], newState);
+    _mm_store_ps(&pool->stateTimer[base], stateTimer);
+    
+    __m128i chasing = _mm_and_si128(active, _mm_cmpeq_epi32(newState, _mm_set1_epi32(ENEMY_CHASING)));
+    __m128i attackingState = _mm_and_si128(active, _mm_cmpeq_epi32(newState, _mm_set1_epi32(ENEMY_ATTACKING)));
+    
+    // Chasers and attackers face the player
+    __m128 facePlayer = _mm_and_ps(_mm_castsi128_ps(_mm_or_si128(chasing, attackingState)),
+                                   _mm_cmpgt_ps(distance, _mm_set1_ps(0.1f)));
+    __m128 inverseDistance = _mm_div_ps(_mm_set1_ps(1.0f), distance);
+    __m128 directionX = SelectFloat(facePlayer, _mm_mul_ps(toPlayerX, inverseDistance), _mm_load_ps(&pool->directionX[base]));
+    __m128 directionZ = SelectFloat(facePlayer, _mm_mul_ps(toPlayerZ, inverseDistance), _mm_load_ps(&pool->directionZ[base]));
+    _mm_store_ps(&pool->directionX[base], directionX);
+    _mm_store_ps(&pool->directionZ[base], directionZ);
+    
+    // Attack if cooldown has passed
+    __m128 ready = _mm_and_ps(_mm_castsi128_ps(attackingState), _mm_cmpge_ps(attackTimer, _mm_load_ps(&pool->attackCooldown[base])));
+    __m128i attacking = _mm_load_si128((const __m128i*)&pool->attacking[base]);
+    _mm_store_si128((__m128i*)&pool->attacking[base], SelectInt(attackingState, _mm_castps_si128(ready), attacking));
+    _mm_store_ps(&pool->attackTimer[base], SelectFloat(ready, zero, attackTimer));
+}
+
+// Move four consecutive slots along their directions once they are
+// steered, sliding along walls, and turn the moving ones to face where
+// they go
+static void MoveEnemyBatch(EnemyPool* pool, Dungeon* dungeon, int base) {
+    __m128 dt = _mm_load_ps(&pool->stepTime[base]);
+    __m128 activeMask = _mm_cmpgt_ps(dt, _mm_setzero_ps());
+    if (_mm_movemask_ps(activeMask) == 0) return;
+    
+    __m128i state = _mm_load_si128((const __m128i*)&pool->state[base]);
+    __m128i chasing = _mm_cmpeq_epi32(state, _mm_set1_epi32(ENEMY_CHASING));
+    __m128i patrolling = _mm_cmpeq_epi32(state, _mm_set1_epi32(ENEMY_PATROLLING));
+    __m128 directionX = _mm_load_ps(&pool->directionX[base]);
+    __m128 directionZ = _mm_load_ps(&pool->directionZ[base]);
+    
+    // Full speed chasing, half speed patrolling, otherwise stand still
+    __m128 speedScale = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(chasing), _mm_set1_ps(1.0f)),
+                                  _mm_and_ps(_mm_castsi128_ps(patrolling), _mm_set1_ps(0.5f)));
+    __m128 speed = _mm_mul_ps(_mm_load_ps(&pool->speed[base]), speedScale);
+    __m128 velocityX = _mm_mul_ps(directionX, speed);
+    __m128 velocityZ = _mm_mul_ps(directionZ, speed);
+    _mm_store_ps(&pool->velocityX[base], SelectFloat(activeMask, velocityX, _mm_load_ps(&pool->velocityX[base])));
+    _mm_store_ps(&pool->velocityZ[base], SelectFloat(activeMask, velocityZ, _mm_load_ps(&pool->velocityZ[base])));
+    
+    // Sweep the lanes' moves through the walls; inactive lanes move by zero
+    velocityX = _mm_and_ps(activeMask, velocityX);
+    velocityZ = _mm_and_ps(activeMask, velocityZ);
+    float moveX[ENEMY_SIMD_WIDTH];
+    float moveZ[ENEMY_SIMD_WIDTH];
+    float radius[ENEMY_SIMD_WIDTH];
+    _mm_storeu_ps(moveX, _mm_mul_ps(velocityX, dt));
+    _mm_storeu_ps(moveZ, _mm_mul_ps(velocityZ, dt));
+    for (int lane = 0; lane < ENEMY_SIMD_WIDTH; lane++) {
+        radius[lane] = pool->enemies[base + lane].radius;
+    }
+    MoveCircles(dungeon, &pool->positionX[base], &pool->positionZ[base], moveX, moveZ, radius, ENEMY_SIMD_WIDTH);
+    
+    // Turn the lanes that are moving to face their direction
+    __m128 speedSquared = _mm_add_ps(_mm_mul_ps(velocityX, velocityX), _mm_mul_ps(velocityZ, velocityZ));
+    int movingLanes = _mm_movemask_ps(_mm_cmpgt_ps(speedSquared, _mm_set1_ps(0.1f * 0.1f)));
+    for (int lane = 0; lane < ENEMY_SIMD_WIDTH; lane++) {
+        if (movingLanes & (1 << lane)) {
+            pool->rotation[base + lane] = atan2f(pool->directionZ[base + lane], pool->directionX[base + lane]) * RAD2DEG;
         }
     }
+}
+
+#else
+
+// Advance one slot's timers, state and attack by its scheduled step
+static void ThinkEnemySlot(EnemyPool* pool, int slot, Vector3 playerPosition) {
+    float deltaTime = pool->stepTime[slot];
+    if (deltaTime <= 0.0f) return;
+    int state = pool->state[slot];
+    
+    // Update timers
+    pool->attackTimer[slot] += deltaTime;
+    pool->pathfindTimer[slot] += deltaTime;
+    pool->stateTimer[slot] += deltaTime;
+    pool->animTimer[slot] += deltaTime;
+    
+    // Calculate distance to player
+    float toPlayerX = playerPosition.x - pool->positionX[slot];
+    float toPlayerY = playerPosition.y - pool->positionY[slot];
+    float toPlayerZ = playerPosition.z - pool->positionZ[slot];
+    float distanceToPlayer = sqrtf(toPlayerX * toPlayerX + toPlayerY * toPlayerY + toPlayerZ * toPlayerZ);
+    bool canSeePlayer = pool->seesPlayer[slot] != 0;
+    
+    // Decide state based on player position and visibility
+    if (distanceToPlayer <= pool->attackRange[slot] && canSeePlayer) {
+        state = ENEMY_ATTACKING;
+    } else if (distanceToPlayer <= pool->detectionRange[slot] && canSeePlayer) {
+        state = ENEMY_CHASING;
+    } else if ((state == ENEMY_CHASING && pool->stateTimer[slot] > 5.0f) ||
+               (state == ENEMY_IDLE && pool->stateTimer[slot] > 3.0f)) {
+        // Lost sight of the player or idle for too long, start patrolling
+        state = ENEMY_PATROLLING;
+        pool->stateTimer[slot] = 0.0f;
+    } else if (state == ENEMY_PATROLLING && pool->stateTimer[slot] > 10.0f) {
+        // After patrolling for a while, take a rest
+        state = ENEMY_IDLE;
+        pool->stateTimer[slot] = 0.0f;
+    }
     
-    // Handle behavior based on state
-    switch (enemy->state) {
-        case ENEMY_IDLE:
-            // No movement in idle state
-            enemy->velocity = (Vector3){0.0f, 0.0f, 0.0f};
-            break;
-            
-        case ENEMY_PATROLLING:
-            // Patrol around spawn position
-            if (enemy->pathfindTimer >= enemy->pathfindInterval) {
-                // Choose a random direction within patrol radius
-                float patrolAngle = GetRandomValue(0, 360) * DEG2RAD;
-                float patrolDistance = GetRandomValue(0, (int)(enemy->patrolRadius * 100)) / 100.0f;
-                
-                Vector3 patrolTarget = {
-                    enemy->spawnPosition.x + cosf(patrolAngle) * patrolDistance,
-                    0.0f,
-                    enemy->spawnPosition.z + sinf(patrolAngle) * patrolDistance
-                };
-                
-                // Calculate direction to patrol target
-                Vector3 toTarget = Vector3Subtract(patrolTarget, enemy->position);
-                if (Vector3Length(toTarget) > 0.1f) {
-                    enemy->direction = Vector3Normalize(toTarget);
-                }
-                
-                enemy->pathfindTimer = 0.0f;
-            }
-            
-            // Move in the patrol direction
-            enemy->velocity.x = enemy->direction.x * enemy->speed * 0.5f;
-            enemy->velocity.z = enemy->direction.z * enemy->speed * 0.5f;
-            break;
-            
-        case ENEMY_CHASING:
-            // Calculate direction to player
-            if (distanceToPlayer > 0.1f) {
-                enemy->direction = Vector3Normalize(toPlayer);
-            }
-            
-            // Move towards player
-            enemy->velocity.x = enemy->direction.x * enemy->speed;
-            enemy->velocity.z = enemy->direction.z * enemy->speed;
-            break;
-            
-        case ENEMY_ATTACKING:
-            // Face the player
-            if (distanceToPlayer > 0.1f) {
-                enemy->direction = Vector3Normalize(toPlayer);
-            }
-            
-            // Stop moving while attacking
-            enemy->velocity = (Vector3){0.0f, 0.0f, 0.0f};
-            
-            // Attempt to attack if cooldown has passed
-            if (enemy->attackTimer >= enemy->attackCooldown) {
-                enemy->isAttacking = true;
-                enemy->attackTimer = 0.0f;
-            } else {
-                enemy->isAttacking = false;
-            }
-            break;
-            
-        case ENEMY_STUNNED:
-            // No movement while stunned
-            enemy->velocity = (Vector3){0.0f, 0.0f, 0.0f};
-            
-            // Recover from stun after a while
-            if (enemy->stateTimer > 1.0f) {
-                enemy->state = ENEMY_IDLE;
-                enemy->stateTimer = 0.0f;
-            }
-            break;
-            
-        case ENEMY_DEAD:
-            // No updates for dead enemies
-            enemy->velocity = (Vector3){0.0f, 0.0f, 0.0f};
-            break;
-            
-        default:
-            break;
+    // Recover from stun after a while
+    if (state == ENEMY_STUNNED && pool->stateTimer[slot] > 1.0f) {
+        state = ENEMY_IDLE;
+        pool->stateTimer[slot] = 0.0f;
     }
+    pool->state[slot] = state;
     
-    // Update position based on velocity
-    enemy->position.x += enemy->velocity.x * deltaTime;
-    enemy->position.z += enemy->velocity.z * deltaTime;
+    // Chasers and attackers face the player
+    if ((state == ENEMY_CHASING || state == ENEMY_ATTACKING) && distanceToPlayer > 0.1f) {
+        pool->directionX[slot] = toPlayerX / distanceToPlayer;
+        pool->directionZ[slot] = toPlayerZ / distanceToPlayer;
+    }
+    
+    // Attack if cooldown has passed
+    if (state == ENEMY_ATTACKING) {
+        bool ready = pool->attackTimer[slot] >= pool->attackCooldown[slot];
+        pool->attacking[slot] = ready ? -1 : 0;
+        if (ready) pool->attackTimer[slot] = 0.0f;
+    }
+}
+
+// Move one slot along its direction once it is steered, sliding along
+// walls, and turn it to face where it goes
+static void MoveEnemySlot(EnemyPool* pool, Dungeon* dungeon, int slot) {
+    float deltaTime = pool->stepTime[slot];
+    if (deltaTime <= 0.0f) return;
+    int state = pool->state[slot];
+    
+    // Full speed chasing, half speed patrolling, otherwise stand still
+    float speed = pool->speed[slot] * (state == ENEMY_CHASING ? 1.0f : state == ENEMY_PATROLLING ? 0.5f : 0.0f);
+    pool->velocityX[slot] = pool->directionX[slot] * speed;
+    pool->velocityZ[slot] = pool->directionZ[slot] * speed;
+    
+    // Sweep the move through the walls
+    float moveX = pool->velocityX[slot] * deltaTime;
+    float moveZ = pool->velocityZ[slot] * deltaTime;
+    MoveCircles(dungeon, &pool->positionX[slot], &pool->positionZ[slot], &moveX, &moveZ, &pool->enemies[slot].radius, 1);
     
     // Update rotation to face direction of movement
-    if (Vector3Length(enemy->velocity) > 0.1f) {
-        enemy->rotationAngle = atan2f(enemy->direction.z, enemy->direction.x) * RAD2DEG;
+    float velocityX = pool->velocityX[slot];
+    float velocityZ = pool->velocityZ[slot];
+    if (velocityX * velocityX + velocityZ * velocityZ > 0.1f * 0.1f) {
+        pool->rotation[slot] = atan2f(pool->directionZ[slot], pool->directionX[slot]) * RAD2DEG;
+    }
+}
+
+#endif
+
+// Let each awake enemy see the player if its tile is in the player's field
+// of view. Shadowcasting is symmetric enough here that the player seeing a
+// tile stands in for the enemy on it seeing the player.
+void UpdateEnemySight(EnemyPool* pool, const FieldOfView* fov) {
+    for (int i = 0; i < pool->used; i++) {
+        if (!IsEnemyActive(pool->state[i])) continue;
+        bool inView = IsTileVisible(fov, (int)floorf(pool->positionX[i]), (int)floorf(pool->positionZ[i]));
+        pool->seesPlayer[i] = inView ? -1 : 0;
+    }
+}
+
+// Give each awake enemy its step for this tick by level of detail. Near
+// enemies step every tick. Mid-range ones bank their time and take turns,
+// at most ENEMY_LOD_SLICE_BUDGET a tick, so a crowded level costs the same
+// as a quiet one. Far ones go back to dormant where they stand, health and
+// all, so they leave the active cap, the scene and the shadow casters until
+// WakeEnemies finds them again.
+static void ScheduleEnemyUpdates(EnemyPool* pool, Vector3 playerPosition, float deltaTime) {
+    const float fullRadiusSquared = ENEMY_LOD_FULL_RADIUS * ENEMY_LOD_FULL_RADIUS;
+    const float reducedRadiusSquared = ENEMY_LOD_REDUCED_RADIUS * ENEMY_LOD_REDUCED_RADIUS;
+    for (int tier = 0; tier < ENEMY_LOD_COUNT; tier++) {
+        pool->tierCounts[tier] = 0;
+    }
+    
+    for (int i = 0; i < pool->used; i++) {
+        pool->stepTime[i] = 0.0f;
+        if (!IsEnemyActive(pool->state[i])) continue;
+        
+        float toPlayerX = playerPosition.x - pool->positionX[i];
+        float toPlayerZ = playerPosition.z - pool->positionZ[i];
+        float distanceSquared = toPlayerX * toPlayerX + toPlayerZ * toPlayerZ;
+        int tier = (distanceSquared <= fullRadiusSquared) ? ENEMY_LOD_FULL :
+                   (distanceSquared <= reducedRadiusSquared) ? ENEMY_LOD_REDUCED : ENEMY_LOD_FROZEN;
+        
+        // Out of reach: dormant again, and woken like a fresh one
+        if (tier == ENEMY_LOD_FROZEN) {
+            pool->state[i] = ENEMY_DORMANT;
+            pool->attacking[i] = 0;
+            pool->seesPlayer[i] = 0;
+            pool->lodTier[i] = ENEMY_LOD_FULL;
+            pool->lodTime[i] = 0.0f;
+            pool->dormantCount++;
+            continue;
+        }
+        
+        // Time banked in another tier is dropped, not paid out in one jump
+        if (tier != pool->lodTier[i]) {
+            pool->lodTier[i] = tier;
+            pool->lodTime[i] = 0.0f;
+        }
+        pool->tierCounts[tier]++;
+        
+        if (tier == ENEMY_LOD_FULL) {
+            pool->stepTime[i] = deltaTime;
+        } else if (tier == ENEMY_LOD_REDUCED) {
+            pool->lodTime[i] = fminf(pool->lodTime[i] + deltaTime, ENEMY_LOD_MAX_STEP);
+        }
+    }
+    
+    pool->tierCounts[ENEMY_LOD_FROZEN] = pool->dormantCount;
+    
+    // Reduced-tier turns, carrying on from where the last tick stopped
+    if (pool->lodCursor >= pool->used) pool->lodCursor = 0;
+    int turns = 0;
+    for (int visited = 0; visited < pool->used && turns < ENEMY_LOD_SLICE_BUDGET; visited++) {
+        int slot = pool->lodCursor;
+        pool->lodCursor = (slot + 1 < pool->used) ? slot + 1 : 0;
+        if (pool->lodTier[slot] != ENEMY_LOD_REDUCED || !IsEnemyActive(pool->state[slot])) continue;
+        
+        pool->stepTime[slot] = pool->lodTime[slot];
+        pool->lodTime[slot] = 0.0f;
+        turns++;
+    }
+}
+
+// Steer this tick's chasers and send patrollers due a new target on their
+// way, in slot order. Route queries share the navigation graph's scratch
+// and retargets draw from the global random sequence, so this pass stays
+// on one thread and the outcome doesn't depend on how the others split.
+static void SteerEnemies(EnemyPool* pool, Dungeon* dungeon, const FlowField* flowField, Vector3 playerPosition) {
+    for (int i = 0; i < pool->used; i++) {
+        if (pool->stepTime[i] <= 0.0f) continue;
+        
+        if (pool->state[i] == ENEMY_CHASING) {
+            SteerChaser(pool, dungeon, flowField, i, playerPosition);
+        } else if (pool->state[i] == ENEMY_PATROLLING && pool->pathfindTimer[i] >= ENEMY_PATHFIND_INTERVAL) {
+            RetargetPatrol(pool, i);
+        }
+    }
+}
+
+// Shared state for the enemy update jobs
+typedef struct {
+    EnemyPool* pool;
+    Dungeon* dungeon;                   // Only read by the jobs
+    Vector3 playerPosition;
+} EnemyUpdateJob;
+
+// Update jobs - a range of kernel batches each. Built with SSE2 a batch
+// runs as one step; define ENEMY_SCALAR_UPDATE to force the scalar path.
+static void ThinkEnemies(void* context, int begin, int end) {
+    EnemyUpdateJob* job = (EnemyUpdateJob*)context;
+#if defined(__SSE2__) && !defined(ENEMY_SCALAR_UPDATE)
+    for (int batch = begin; batch < end; batch++) {
+        ThinkEnemyBatch(job->pool, batch * ENEMY_SIMD_WIDTH, job->playerPosition);
+    }
+#else
+    for (int i = begin * ENEMY_SIMD_WIDTH; i < end * ENEMY_SIMD_WIDTH && i < job->pool->used; i++) {
+        ThinkEnemySlot(job->pool, i, job->playerPosition);
     }
+#endif
+}
+
+static void MoveEnemies(void* context, int begin, int end) {
+    EnemyUpdateJob* job = (EnemyUpdateJob*)context;
+#if defined(__SSE2__) && !defined(ENEMY_SCALAR_UPDATE)
+    for (int batch = begin; batch < end; batch++) {
+        MoveEnemyBatch(job->pool, job->dungeon, batch * ENEMY_SIMD_WIDTH);
+    }
+#else
+    for (int i = begin * ENEMY_SIMD_WIDTH; i < end * ENEMY_SIMD_WIDTH && i < job->pool->used; i++) {
+        MoveEnemySlot(job->pool, job->dungeon, i);
+    }
+#endif
+}
+
+// Update the awake enemies scheduled this tick, chasers steering along
+// the shared flow field or the level's navigation graph. Thinking and
+// moving touch only each slot's own state and run across the job system;
+// steering runs between them on the calling thread. Moves slide along the
+// walls rather than pass through them.
+void UpdateEnemies(EnemyPool* pool, Dungeon* dungeon, const FlowField* flowField, Vector3 playerPosition,
+                   float deltaTime) {
+    ScheduleEnemyUpdates(pool, playerPosition, deltaTime);
+    
+    EnemyUpdateJob job = { pool, dungeon, playerPosition };
+    int batches = (pool->used + ENEMY_SIMD_WIDTH - 1) / ENEMY_SIMD_WIDTH;
+    ParallelFor(batches, ENEMY_JOB_GRAIN, ThinkEnemies, &job);
+    SteerEnemies(pool, dungeon, flowField, playerPosition);
+    ParallelFor(batches, ENEMY_JOB_GRAIN, MoveEnemies, &job);
 }
 
-// Draw enemy
-void DrawEnemy(Enemy* enemy, Camera camera)
+// Record the awake enemies and their health bars for drawing - dormant
+// ones are out of sight
+void RecordEnemies(const EnemyPool* pool, SceneList* scene)
 {
-    if (enemy->isAlive) {
-        // Draw the enemy model with appropriate rotation
-        DrawModelEx(enemy->model, 
-                   enemy->position, 
-                   (Vector3){0.0f, 1.0f, 0.0f}, 
-                   enemy->rotationAngle, 
-                   (Vector3){1.0f, 1.0f, 1.0f}, 
-                   WHITE);
-    
-        // Draw health bar above enemy (if not at full health)
-        if (enemy->health < enemy->maxHealth && enemy->health > 0) {
-            // Convert 3D position to 2D screen space
-            Vector2 screenPos = GetWorldToScreen(
-                (Vector3){enemy->position.x, enemy->position.y + enemy->height + 0.3f, enemy->position.z}, 
-                camera);
-            
-            // Draw health bar
-            float healthRatio = (float)enemy->health / (float)enemy->maxHealth;
-            float barWidth = 30.0f;
-            float barHeight = 5.0f;
-            
-            DrawRectangle(screenPos.x - barWidth/2, screenPos.y, barWidth, barHeight, DARKGRAY);
-            DrawRectangle(screenPos.x - barWidth/2, screenPos.y, barWidth * healthRatio, barHeight, RED);
-            DrawRectangleLines(screenPos.x - barWidth/2, screenPos.y, barWidth, barHeight, BLACK);
+    for (int i = 0; i < pool->used; i++) {
+        if (!IsEnemyActive(pool->state[i])) continue;
+        
+        const Enemy* enemy = &pool->enemies[i];
+        if (enemy->model->meshCount == 0) continue;
+        
+        // Record the enemy model with its facing
+        SceneModel* model = RecordSceneModel(scene, enemy->entity, enemy->model, GetEnemyPosition(pool, i),
+                                             pool->rotation[i], WHITE);
+    
+        // Health bar above enemy (if not at full health), drawn in the overlay pass
+        if (model != NULL && enemy->health < enemy->maxHealth && enemy->health > 0) {
+            model->healthBar = (float)enemy->health / (float)enemy->maxHealth;
+            model->barHeight = enemy->height + 0.3f;
         }
     }
 }
 
 // Enemy takes damage
-void EnemyTakeDamage(Enemy* enemy, int damage) {
+void EnemyTakeDamage(EnemyPool* pool, int slot, int damage) {
+    Enemy* enemy = &pool->enemies[slot];
     enemy->health -= damage;
     
     // Check if enemy died
     if (enemy->health <= 0) {
         enemy->health = 0;
-        enemy->isAlive = false;
-        enemy->state = ENEMY_DEAD;
+        pool->state[slot] = ENEMY_DEAD;
     } else {
         // Enemy is stunned briefly when hit
-        enemy->state = ENEMY_STUNNED;
-        enemy->stateTimer = 0.0f;
+        pool->state[slot] = ENEMY_STUNNED;
+        pool->stateTimer[slot] = 0.0f;
     }
 }
 
 // Enemy attacks player
-bool EnemyAttack(Enemy* enemy, Vector3 playerPosition, float playerRadius, int* damageDealt) {
-    if (!enemy->isAlive || !enemy->isAttacking) {
+bool EnemyAttack(EnemyPool* pool, Dungeon* dungeon, int slot, Vector3 playerPosition, float playerRadius,
+                 int* damageDealt) {
+    if (pool->state[slot] == ENEMY_DEAD || !pool->attacking[slot]) {
         return false;
     }
     
     // Reset attack flag
-    enemy->isAttacking = false;
-    
-    // Calculate distance to player
-    Vector3 toPlayer = Vector3Subtract(playerPosition, enemy->position);
-    float distance = Vector3Length(toPlayer);
+    pool->attacking[slot] = 0;
     
     // Check if player is in attack range
-    if (distance <= enemy->attackRange + playerRadius) {
-        // For ranged enemies (archer, mage), we might want additional checks
-        // like line of sight, but we'll keep it simple for now
+    Vector3 position = GetEnemyPosition(pool, slot);
+    if (Vector3Distance(playerPosition, position) <= pool->attackRange[slot] + playerRadius) {
+        // Ranged enemies (archer, mage) also need a clear straight line for
+        // the bolt, which the field of view alone doesn't promise
+        if (enemyArchetypes[pool->enemies[slot].type].projectileSpeed > 0.0f &&
+            !HasLineOfSight(dungeon, position, playerPosition)) {
+            return false;
+        }
         
         // Attack hits!
-        *damageDealt = enemy->attackDamage;
+        *damageDealt = pool->enemies[slot].attackDamage;
         return true;
     }
     
     return false;
 }
 
+// Gather a slot's position from the hot arrays
+Vector3 GetEnemyPosition(const EnemyPool* pool, int slot) {
+    return (Vector3){ pool->positionX[slot], pool->positionY[slot], pool->positionZ[slot] };
+}
+
+// Whether a slot holds an enemy that is being simulated
+bool IsEnemyAwake(const EnemyPool* pool, int slot) {
+    return IsEnemyActive(pool->state[slot]);
+}
+
 // Get random loot from enemy
 int GetRandomEnemyLoot(Enemy* enemy) {
     // Simple implementation returning gold amount
     return GetRandomValue(enemy->minGold, enemy->maxGold);
 }
-
-// Unload enemy resources
-void UnloadEnemy(Enemy* enemy) {
-    // Unload model
-    UnloadModel(enemy->model);
-}
@@ -0,0 +1,154 @@
+#include "../include/field_of_view.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Transforms from octant-local (column, row) to tile offsets, one column
+// per octant
+static const int octantXX[8] = { 1, 0, 0, -1, -1, 0, 0, 1 };
+static const int octantXZ[8] = { 0, 1, -1, 0, 0, -1, 1, 0 };
+static const int octantZX[8] = { 0, 1, 1, 0, 0, -1, -1, 0 };
+static const int octantZZ[8] = { 1, 0, 0, 1, -1, 0, 0, -1 };
+
+// Check if a tile stops sight. Everything outside the level does.
+static bool IsOpaqueTile(Dungeon* dungeon, int x, int z) {
+    if (x < 0 || x >= dungeon->width || z < 0 || z >= dungeon->height) return true;
+    return dungeon->tiles[x][z] == TILE_WALL || dungeon->tiles[x][z] == TILE_NONE;
+}
+
+static void MarkVisible(FieldOfView* fov, int x, int z) {
+    if (x < 0 || x >= fov->width || z < 0 || z >= fov->height) return;
+    int bit = x * fov->height + z;
+    fov->visible[bit >> 5] |= 1u << (bit & 31);
+}
+
+// Scan one octant row by row from the given row, lighting the tiles whose
+// slopes fall between start and end. A run of opaque tiles narrows the
+// light; the part above it is scanned by a recursive call.
+static void CastLight(FieldOfView* fov, Dungeon* dungeon, int octant, int row, float start, float end) {
+    if (start < end) return;
+
+    float nextStart = start;
+    for (int distance = row; distance <= FOV_RADIUS; distance++) {
+        bool blocked = false;
+
+        for (int column = -distance; column <= 0; column++) {
+            float leftSlope = (column - 0.5f) / (-distance + 0.5f);
+            float rightSlope = (column + 0.5f) / (-distance - 0.5f);
+            if (start < rightSlope) continue;
+            if (end > leftSlope) break;
+
+            int x = fov->originX + column * octantXX[octant] - distance * octantXZ[octant];
+            int z = fov->originZ + column * octantZX[octant] - distance * octantZZ[octant];
+            if (column * column + distance * distance <= FOV_RADIUS * FOV_RADIUS) {
+                MarkVisible(fov, x, z);
+            }
+
+            bool opaque = IsOpaqueTile(dungeon, x, z);
+            if (blocked) {
+                if (opaque) {
+                    nextStart = rightSlope;
+                    continue;
+                }
+                blocked = false;
+                start = nextStart;
+            } else if (opaque && distance < FOV_RADIUS) {
+                blocked = true;
+                CastLight(fov, dungeon, octant, distance + 1, start, leftSlope);
+                nextStart = rightSlope;
+            }
+        }
+        if (blocked) break;
+    }
+}
+
+// Free the bitset
+void UnloadFieldOfView(FieldOfView* fov) {
+    free(fov->visible);
+    memset(fov, 0, sizeof(FieldOfView));
+    fov->originX = -1;
+    fov->originZ = -1;
+}
+
+// Drop the field of view for a new level, so the next update recasts it
+void ResetFieldOfView(FieldOfView* fov) {
+    fov->originX = -1;
+    fov->originZ = -1;
+    fov->width = 0;
+    fov->height = 0;
+}
+
+// Recast the field of view if the origin has moved onto another tile.
+// Returns true when it was recast.
+bool UpdateFieldOfView(FieldOfView* fov, Dungeon* dungeon, Vector3 origin) {
+    int originX = (int)floorf(origin.x);
+    int originZ = (int)floorf(origin.z);
+    if (originX == fov->originX && originZ == fov->originZ) return false;
+
+    int tileCount = dungeon->width * dungeon->height;
+    if (tileCount > fov->capacity) {
+        free(fov->visible);
+        fov->visible = (uint32_t*)malloc(((tileCount + 31) / 32) * sizeof(uint32_t));
+        fov->capacity = (fov->visible != NULL) ? tileCount : 0;
+        if (fov->visible == NULL) {
+            TraceLog(LOG_WARNING, "FOV: Failed to allocate a bitset of %d tiles", tileCount);
+            return false;
+        }
+    }
+
+    fov->width = dungeon->width;
+    fov->height = dungeon->height;
+    fov->originX = originX;
+    fov->originZ = originZ;
+    memset(fov->visible, 0, ((tileCount + 31) / 32) * sizeof(uint32_t));
+
+    MarkVisible(fov, originX, originZ);
+    for (int octant = 0; octant < 8; octant++) {
+        CastLight(fov, dungeon, octant, 1, 1.0f, 0.0f);
+    }
+    return true;
+}
+
+// Check if a tile was in view from the last origin
+bool IsTileVisible(const FieldOfView* fov, int x, int z) {
+    if (x < 0 || x >= fov->width || z < 0 || z >= fov->height || fov->originX < 0) return false;
+    int bit = x * fov->height + z;
+    return (fov->visible[bit >> 5] >> (bit & 31)) & 1u;
+}
+
+// Check if the tile under a position was in view
+bool IsPositionVisible(const FieldOfView* fov, Vector3 position) {
+    return IsTileVisible(fov, (int)floorf(position.x), (int)floorf(position.z));
+}
+
+// Walk the tiles a straight line crosses between two points (grid DDA).
+// Returns false if any tile after the first blocks sight.
+bool HasLineOfSight(Dungeon* dungeon, Vector3 from, Vector3 to) {
+    int x = (int)floorf(from.x);
+    int z = (int)floorf(from.z);
+    int endX = (int)floorf(to.x);
+    int endZ = (int)floorf(to.z);
+    float deltaX = to.x - from.x;
+    float deltaZ = to.z - from.z;
+
+    // Ray parameter at the next column and row border, and between borders
+    int stepX = (deltaX > 0.0f) ? 1 : -1;
+    int stepZ = (deltaZ > 0.0f) ? 1 : -1;
+    float borderDistanceX = (deltaX != 0.0f) ? fabsf(1.0f / deltaX) : INFINITY;
+    float borderDistanceZ = (deltaZ != 0.0f) ? fabsf(1.0f / deltaZ) : INFINITY;
+    float nextBorderX = (deltaX > 0.0f) ? (x + 1 - from.x) * borderDistanceX : (from.x - x) * borderDistanceX;
+    float nextBorderZ = (deltaZ > 0.0f) ? (z + 1 - from.z) * borderDistanceZ : (from.z - z) * borderDistanceZ;
+
+    int steps = abs(endX - x) + abs(endZ - z);
+    for (int i = 0; i < steps; i++) {
+        if (nextBorderX < nextBorderZ) {
+            nextBorderX += borderDistanceX;
+            x += stepX;
+        } else {
+            nextBorderZ += borderDistanceZ;
+            z += stepZ;
+        }
+        if (IsOpaqueTile(dungeon, x, z)) return false;
+    }
+    return true;
+}
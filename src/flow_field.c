@@ -0,0 +1,155 @@
+#include "../include/flow_field.h"
+#include <stdlib.h>
+#include <math.h>
+
+// Orthogonal steps first, so a tie between a straight and a diagonal
+// neighbour goes to the straight one
+static const int stepX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int stepZ[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+// Check if an enemy can walk through a tile
+static bool IsOpenTile(Dungeon* dungeon, int x, int z) {
+    if (x < 0 || x >= dungeon->width || z < 0 || z >= dungeon->height) return false;
+    return dungeon->tiles[x][z] != TILE_WALL && dungeon->tiles[x][z] != TILE_NONE;
+}
+
+// Forget the tiles the last search reached
+static void ClearReachedTiles(FlowField* field) {
+    for (int i = 0; i < field->reachedCount; i++) {
+        field->distance[field->reached[i]] = FLOW_FIELD_UNREACHED;
+        field->next[field->reached[i]] = -1;
+    }
+    field->reachedCount = 0;
+}
+
+// Grow the arrays to hold a level of tileCount tiles
+static bool EnsureFlowFieldSize(FlowField* field, int tileCount) {
+    if (tileCount <= field->capacity) return true;
+
+    UnloadFlowField(field);
+    field->distance = (unsigned short*)malloc(tileCount * sizeof(unsigned short));
+    field->next = (int*)malloc(tileCount * sizeof(int));
+    field->reached = (int*)malloc(tileCount * sizeof(int));
+    if (field->distance == NULL || field->next == NULL || field->reached == NULL) {
+        TraceLog(LOG_WARNING, "FLOW: Failed to allocate a field of %d tiles", tileCount);
+        UnloadFlowField(field);
+        return false;
+    }
+
+    for (int i = 0; i < tileCount; i++) {
+        field->distance[i] = FLOW_FIELD_UNREACHED;
+        field->next[i] = -1;
+    }
+    field->capacity = tileCount;
+    return true;
+}
+
+// Free the field's arrays
+void UnloadFlowField(FlowField* field) {
+    free(field->distance);
+    free(field->next);
+    free(field->reached);
+    field->distance = NULL;
+    field->next = NULL;
+    field->reached = NULL;
+    field->capacity = 0;
+    field->reachedCount = 0;
+    field->targetX = -1;
+    field->targetZ = -1;
+}
+
+// Drop the field for a new level, so the next update rebuilds it
+void ResetFlowField(FlowField* field) {
+    ClearReachedTiles(field);
+    field->targetX = -1;
+    field->targetZ = -1;
+}
+
+// Rebuild the field toward the target's tile if the target has moved onto
+// a different open tile. Returns true when the field was rebuilt.
+bool UpdateFlowField(FlowField* field, Dungeon* dungeon, Vector3 target) {
+    int targetX = (int)floorf(target.x);
+    int targetZ = (int)floorf(target.z);
+    if (targetX == field->targetX && targetZ == field->targetZ) return false;
+    if (!IsOpenTile(dungeon, targetX, targetZ)) return false;
+    if (!EnsureFlowFieldSize(field, dungeon->width * dungeon->height)) return false;
+
+    ClearReachedTiles(field);
+    field->width = dungeon->width;
+    field->height = dungeon->height;
+    field->targetX = targetX;
+    field->targetZ = targetZ;
+
+    // Breadth-first search out from the target, using the reached list as
+    // the queue
+    int height = field->height;
+    int start = targetX * height + targetZ;
+    field->distance[start] = 0;
+    field->reached[field->reachedCount++] = start;
+
+    for (int head = 0; head < field->reachedCount; head++) {
+        int tile = field->reached[head];
+        if (field->distance[tile] >= FLOW_FIELD_RADIUS) continue;
+
+        int x = tile / height;
+        int z = tile % height;
+        for (int i = 0; i < 4; i++) {
+            int neighbour = (x + stepX[i]) * height + (z + stepZ[i]);
+            if (!IsOpenTile(dungeon, x + stepX[i], z + stepZ[i]) ||
+                field->distance[neighbour] != FLOW_FIELD_UNREACHED) {
+                continue;
+            }
+            field->distance[neighbour] = field->distance[tile] + 1;
+            field->reached[field->reachedCount++] = neighbour;
+        }
+    }
+
+    // Point every reached tile at its closest neighbour. Diagonal steps are
+    // only taken past two open tiles, so steering never cuts a wall corner.
+    for (int i = 1; i < field->reachedCount; i++) {
+        int tile = field->reached[i];
+        int x = tile / height;
+        int z = tile % height;
+        int best = -1;
+        unsigned short bestDistance = field->distance[tile];
+
+        for (int step = 0; step < 8; step++) {
+            int neighbourX = x + stepX[step];
+            int neighbourZ = z + stepZ[step];
+            if (!IsOpenTile(dungeon, neighbourX, neighbourZ)) continue;
+            if (step >= 4 && (!IsOpenTile(dungeon, neighbourX, z) || !IsOpenTile(dungeon, x, neighbourZ))) continue;
+
+            int neighbour = neighbourX * height + neighbourZ;
+            if (field->distance[neighbour] < bestDistance) {
+                bestDistance = field->distance[neighbour];
+                best = neighbour;
+            }
+        }
+        field->next[tile] = best;
+    }
+
+    return true;
+}
+
+// Unit direction from a position toward the centre of the next tile on its
+// tile's path to the target. Returns false on the target's tile and off
+// the field, where the caller should head straight for the target.
+bool SampleFlowField(const FlowField* field, float x, float z, float* directionX, float* directionZ) {
+    if (field->targetX < 0) return false;
+
+    int tileX = (int)floorf(x);
+    int tileZ = (int)floorf(z);
+    if (tileX < 0 || tileX >= field->width || tileZ < 0 || tileZ >= field->height) return false;
+
+    int next = field->next[tileX * field->height + tileZ];
+    if (next < 0) return false;
+
+    float toX = (float)(next / field->height) + 0.5f - x;
+    float toZ = (float)(next % field->height) + 0.5f - z;
+    float length = sqrtf(toX * toX + toZ * toZ);
+    if (length < 0.0001f) return false;
+
+    *directionX = toX / length;
+    *directionZ = toZ / length;
+    return true;
+}
@@ -5,6 +5,11 @@
 #include "../include/item.h"
 #include "../include/ui.h"
 #include "../include/dungeon_props.h"
+#include "../include/shadow.h"
+#include "../include/asset_loader.h"
+#include "../include/systems.h"
+#include "../include/collision.h"
+#include "../include/main_thread.h"
 #include "raymath.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -15,10 +20,12 @@
 #define SOUNDS_PATH "assets/sounds/"
 
 // Game constants
-#define MAX_ENEMIES 50
+#define MAX_ENEMIES 4096               // Mostly dormant until the player gets near
 #define MAX_ITEMS 100
 #define MAX_LEVEL 5
 
+// Set up only what the title screen needs. Everything else is deferred to
+// the warm-up, which runs while the title screen is up.
 void LoadGameAssets(GameState* gameState) {
     // Initialize game camera (first person view)
     gameState->camera = (Camera){
@@ -35,41 +42,117 @@ void LoadGameAssets(GameState* gameState) {
     gameState->gameTime = 0.0f;
     gameState->isPaused = false;
     
-    // Allocate memory for enemies and items
-    gameState->enemies = (Enemy*)malloc(MAX_ENEMIES * sizeof(Enemy));
+    // Entity capacities are fixed now; the arrays are allocated on warm-up
     gameState->maxEnemies = MAX_ENEMIES;
-    gameState->enemyCount = 0;
-    
-    gameState->items = (Item*)malloc(MAX_ITEMS * sizeof(Item));
     gameState->maxItems = MAX_ITEMS;
-    gameState->itemCount = 0;
     
-    // Load dungeon assets based on level theme
+    gameState->warmup = WARMUP_START;
+    gameState->currentState = TITLE_SCREEN;
+}
+
+// Allocate entity storage the first time a level is built
+static void EnsureGameStorage(GameState* gameState) {
+    if (gameState->world.capacity == 0) {
+        InitGameWorld(&gameState->world, MAX_ENEMIES, MAX_ITEMS);
+    }
+    if (gameState->enemyPool.enemies == NULL) {
+        InitEnemyPool(&gameState->enemyPool, MAX_ENEMIES, &gameState->world);
+    }
+    if (gameState->spatial.entries == NULL) {
+        InitSpatialHash(&gameState->spatial, MAX_ENEMIES + MAX_ITEMS);
+    }
+}
+
+// Create everything the levels share that needs the GL context: HUD
+// fallback textures, entity storage with the enemy and bolt models, and
+// the item and prop models (main thread)
+static void CreateSharedResources(void* context) {
+    GameState* gameState = (GameState*)context;
+    CreateFallbackTextures(gameState);
+    EnsureGameStorage(gameState);
+    LoadItemModels();
+    LoadPropModels();
+}
+
+// Check whether the loader still has files in flight (main thread)
+static void CheckAssetLoads(void* context) {
+    *(bool*)context = AssetLoadsPending();
+}
+
+// Build the current level and place the player. Deeper levels are larger.
+static void BuildLevel(GameState* gameState) {
     int theme = GetRandomValue(0, 2); // Random theme (can be expanded)
-    LoadDungeonAssets(gameState->dungeon, theme);
+    int level = gameState->currentLevel;
+    int size = (level > 1) ? 30 + level * 5 : 30;
+    int rooms = (level > 1) ? 10 + level : 10;
     
-    // Generate initial dungeon
-    GenerateDungeon(gameState->dungeon, 30, 30, 10, theme);
+    LoadDungeonAssets(gameState->dungeon, theme);
+    GenerateDungeon(gameState->dungeon, size, size, rooms, theme);
     
     // Place player at dungeon start position
     gameState->player->position = gameState->dungeon->startPosition;
     
-    // Create a placeholder for missing UI textures
-    CreateFallbackTextures(gameState);
+    // Furnish the rooms, then fill them with dormant enemies from the
+    // level's budget
+    SpawnPropEntities(&gameState->world, gameState->dungeon);
+    PopulateDungeon(&gameState->enemyPool, gameState->dungeon, level);
+    RebuildSpatialHash(gameState);
+    ResetFlowField(&gameState->flowField);
+    ResetFieldOfView(&gameState->fieldOfView);
+    ResetSpawnDirectorLevel(&gameState->director);
 }
 
-void UnloadGameAssets(GameState* gameState) {
-    // Free enemies
-    for (int i = 0; i < gameState->enemyCount; i++) {
-        UnloadEnemy(&gameState->enemies[i]);
+// Drop the current level's entities before building another
+static void ClearLevelEntities(GameState* gameState) {
+    ClearGameWorld(&gameState->world);
+    ClearEnemyPool(&gameState->enemyPool);
+}
+
+// Advance the warm-up by one stage. Each stage is short, so the title
+// screen keeps drawing while files decode and the level is built. GPU and
+// registry work goes to the main thread; the rest runs here.
+static void UpdateWarmup(GameState* gameState) {
+    switch (gameState->warmup) {
+        case WARMUP_START:
+            // Start reading dungeon files on the loader workers
+            RequestDungeonAssets();
+            gameState->warmup = WARMUP_ASSETS;
+            break;
+            
+        case WARMUP_ASSETS: {
+            bool pending = true;
+            RunOnMainThread(CheckAssetLoads, &pending);
+            if (!pending) gameState->warmup = WARMUP_SHARED;
+            break;
+        }
+            
+        case WARMUP_SHARED:
+            RunOnMainThread(CreateSharedResources, gameState);
+            gameState->warmup = WARMUP_LEVEL;
+            break;
+            
+        case WARMUP_LEVEL:
+            BuildLevel(gameState);
+            gameState->warmup = WARMUP_DONE;
+            TraceLog(LOG_INFO, "STARTUP: Warm-up finished %.1f ms after window creation", GetTime() * 1000.0);
+            break;
+            
+        default:
+            break;
     }
-    free(gameState->enemies);
+}
+
+void UnloadGameAssets(GameState* gameState) {
+    // Free enemies, then the world
+    UnloadEnemyPool(&gameState->enemyPool);
+    UnloadGameWorld(&gameState->world);
+    UnloadSpatialHash(&gameState->spatial);
+    UnloadFlowField(&gameState->flowField);
+    UnloadFieldOfView(&gameState->fieldOfView);
     
-    // Free items
-    for (int i = 0; i < gameState->itemCount; i++) {
-        UnloadItem(&gameState->items[i]);
-    }
-    free(gameState->items);
+    // Models shared by every level
+    UnloadItemModels();
+    UnloadProps();
 }
 
 void UpdateGame(GameState* gameState, float deltaTime) {
@@ -78,17 +161,27 @@ void UpdateGame(GameState* gameState, float deltaTime) {
     
     // Process input based on current state
     switch(gameState->currentState) {
+        case LOADING:
+            // The player pressed start before the warm-up finished
+            UpdateWarmup(gameState);
+            if (gameState->warmup == WARMUP_DONE) {
+                gameState->currentState = GAMEPLAY;
+            }
+            break;
+            
         case TITLE_SCREEN:
+            UpdateWarmup(gameState);
+            
             // Check for game start input
-            if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE)) {
-                gameState->currentState = GAMEPLAY;
+            if (InputPressed(&gameState->input, INPUT_CONFIRM)) {
+                gameState->currentState = (gameState->warmup == WARMUP_DONE) ? GAMEPLAY : LOADING;
             }
             break;
             
         case GAMEPLAY:
             if (!gameState->isPaused) {
                 // Update player
-                UpdatePlayer(gameState->player, deltaTime);
+                UpdatePlayer(gameState->player, &gameState->input, deltaTime);
                 
                 // Store previous position for collision detection
                 Vector3 previousPosition = gameState->player->position;
@@ -99,42 +192,12 @@ void UpdateGame(GameState* gameState, float deltaTime) {
                 newPosition.y += gameState->player->velocity.y * deltaTime;
                 newPosition.z += gameState->player->velocity.z * deltaTime;
                 
-                // Advanced collision detection with sliding along walls
-                // First try to move in both X and Z directions (ideal movement)
-                if (IsWalkable(gameState->dungeon, newPosition.x, newPosition.z, gameState->player->radius)) {
-                    // Full movement is possible
-                    gameState->player->position.x = newPosition.x;
-                    gameState->player->position.z = newPosition.z;
-                } else {
-                    // Try X-axis movement only
-                    if (IsWalkable(gameState->dungeon, newPosition.x, previousPosition.z, gameState->player->radius)) {
-                        gameState->player->position.x = newPosition.x;
-                    }
-                    
-                    // Try Z-axis movement only
-                    if (IsWalkable(gameState->dungeon, gameState->player->position.x, newPosition.z, gameState->player->radius)) {
-                        gameState->player->position.z = newPosition.z;
-                    }
-                    
-                    // If we still couldn't move, try sliding along walls at reduced speed
-                    if (gameState->player->position.x == previousPosition.x && 
-                        gameState->player->position.z == previousPosition.z) {
-                        
-                        // Try with a smaller step (half speed) in each direction
-                        float halfStepX = previousPosition.x + (newPosition.x - previousPosition.x) * 0.5f;
-                        float halfStepZ = previousPosition.z + (newPosition.z - previousPosition.z) * 0.5f;
-                        
-                        // Try X-axis half step
-                        if (IsWalkable(gameState->dungeon, halfStepX, previousPosition.z, gameState->player->radius)) {
-                            gameState->player->position.x = halfStepX;
-                        }
-                        
-                        // Try Z-axis half step
-                        if (IsWalkable(gameState->dungeon, gameState->player->position.x, halfStepZ, gameState->player->radius)) {
-                            gameState->player->position.z = halfStepZ;
-                        }
-                    }
-                }
+                // Sweep the move through the walls, sliding along any it meets
+                Vector2 floorPosition = { previousPosition.x, previousPosition.z };
+                Vector2 floorMove = { newPosition.x - previousPosition.x, newPosition.z - previousPosition.z };
+                MoveCircle(gameState->dungeon, &floorPosition, floorMove, gameState->player->radius);
+                gameState->player->position.x = floorPosition.x;
+                gameState->player->position.z = floorPosition.y;
                 
                 // Handle gravity and ground collision
                 // Note: Player model is effectively a capsule with height and radius
@@ -171,78 +234,9 @@ void UpdateGame(GameState* gameState, float deltaTime) {
                     gameState->player->direction
                 );
                 
-                // Update enemies
-                for (int i = 0; i < gameState->enemyCount; i++) {
-                    if (gameState->enemies[i].isAlive) {
-                        // Check if enemy is visible to player (basic line of sight)
-                        bool canSeePlayer = true; // Simplified, could implement proper raycasting
-                        
-                        // Update enemy behavior
-                        UpdateEnemy(&gameState->enemies[i], gameState->player->position, deltaTime, canSeePlayer);
-                        
-                        // Check for enemy attack on player
-                        int damageDealt = 0;
-                        if (EnemyAttack(&gameState->enemies[i], gameState->player->position, gameState->player->radius, &damageDealt)) {
-                            PlayerTakeDamage(gameState->player, damageDealt);
-                        }
-                        
-                        // Check for player attack on enemy
-                        if (gameState->player->isAttacking) {
-                            // Calculate distance between player and enemy
-                            Vector3 diff = Vector3Subtract(gameState->enemies[i].position, gameState->player->position);
-                            float distance = Vector3Length(diff);
-                            
-                            // Check if enemy is within attack range and in front of player
-                            if (distance <= gameState->player->attackRange) {
-                                // Check if enemy is in player's field of view (simplified)
-                                Vector3 normalizedDiff = Vector3Normalize(diff);
-                                float dotProduct = Vector3DotProduct(gameState->player->direction, normalizedDiff);
-                                
-                                if (dotProduct > 0.5f) { // Within ~60 degree cone in front
-                                    EnemyTakeDamage(&gameState->enemies[i], gameState->player->attackDamage);
-                                    
-                                    // If enemy died, give player experience
-                                    if (!gameState->enemies[i].isAlive) {
-                                        PlayerAddExperience(gameState->player, gameState->enemies[i].experienceValue);
-                                        
-                                        // Chance to drop item
-                                        if (GetRandomValue(0, 100) < gameState->enemies[i].dropChance * 100) {
-                                            if (gameState->itemCount < gameState->maxItems) {
-                                                // Generate random item at enemy position
-                                                InitItem(&gameState->items[gameState->itemCount], 
-                                                         GetRandomValue(1, 6), // Random item type 
-                                                         GetRandomValue(0, 4),  // Random subtype
-                                                         gameState->currentLevel, 
-                                                         gameState->enemies[i].position);
-                                                gameState->itemCount++;
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                
-                // Update items
-                for (int i = 0; i < gameState->itemCount; i++) {
-                    if (gameState->items[i].isOnGround) {
-                        UpdateItem(&gameState->items[i], deltaTime);
-                        
-                        // Check if player is picking up the item
-                        Vector3 diff = Vector3Subtract(gameState->items[i].position, gameState->player->position);
-                        float distance = Vector3Length(diff);
-                        
-                        if (distance < 1.5f) { // Pickup range
-                            if (IsKeyPressed(KEY_E)) { // Pickup key
-                                PlayerAddItem(gameState->player, gameState->items[i]);
-                                
-                                // Remove item from ground (simplified, should use a better removal method)
-                                gameState->items[i].isOnGround = false;
-                            }
-                        }
-                    }
-                }
+                // Run the gameplay systems: director, enemies, spatial hash,
+                // separation, combat, projectiles, items and shadows, in that order
+                RunSystems(&gameState->world, gameState, deltaTime);
                 
                 // Check for level completion (player reached end position)
                 Vector3 diffToEnd = Vector3Subtract(gameState->dungeon->endPosition, gameState->player->position);
@@ -257,18 +251,10 @@ void UpdateGame(GameState* gameState, float deltaTime) {
                         UnloadDungeon(gameState->dungeon);
                         
                         // Clear enemies and items
-                        gameState->enemyCount = 0;
-                        gameState->itemCount = 0;
+                        ClearLevelEntities(gameState);
                         
                         // Generate new dungeon with increasing difficulty
-                        int theme = GetRandomValue(0, 2);
-                        LoadDungeonAssets(gameState->dungeon, theme);
-                        GenerateDungeon(gameState->dungeon, 30 + gameState->currentLevel * 5, 
-                                       30 + gameState->currentLevel * 5, 
-                                       10 + gameState->currentLevel, theme);
-                        
-                        // Place player at dungeon start
-                        gameState->player->position = gameState->dungeon->startPosition;
+                        BuildLevel(gameState);
                     } else {
                         // Player completed all levels
                         gameState->currentState = VICTORY;
@@ -282,37 +268,32 @@ void UpdateGame(GameState* gameState, float deltaTime) {
             }
             
             // Toggle pause
-            if (IsKeyPressed(KEY_P) || IsKeyPressed(KEY_ESCAPE)) {
+            if (InputPressed(&gameState->input, INPUT_PAUSE)) {
                 gameState->isPaused = !gameState->isPaused;
             }
             break;
             
         case GAME_OVER:
             // Check for restart input
-            if (IsKeyPressed(KEY_R)) {
+            if (InputPressed(&gameState->input, INPUT_RESTART)) {
                 // Reset game state for a new game
                 gameState->currentState = TITLE_SCREEN;
                 gameState->currentLevel = 1;
-                gameState->enemyCount = 0;
-                gameState->itemCount = 0;
+                ClearLevelEntities(gameState);
                 
                 // Reset player
-                InitPlayer(gameState->player);
+                ResetPlayer(gameState->player);
                 
-                // Generate new starting dungeon
+                // Build a new starting dungeon while the title screen shows -
+                // the dungeon files and shared models are resident
                 UnloadDungeon(gameState->dungeon);
-                int theme = GetRandomValue(0, 2);
-                LoadDungeonAssets(gameState->dungeon, theme);
-                GenerateDungeon(gameState->dungeon, 30, 30, 10, theme);
-                
-                // Place player at dungeon start
-                gameState->player->position = gameState->dungeon->startPosition;
+                gameState->warmup = WARMUP_LEVEL;
             }
             break;
             
         case VICTORY:
             // Check for new game input
-            if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE)) {
+            if (InputPressed(&gameState->input, INPUT_CONFIRM)) {
                 gameState->currentState = TITLE_SCREEN;
             }
             break;
@@ -322,6 +303,24 @@ void UpdateGame(GameState* gameState, float deltaTime) {
     }
 }
 
+void DrawLoadingScreen(GameState* gameState) {
+    const char* loadingText = "LOADING";
+    int fontSize = 40;
+    Vector2 textSize = MeasureTextEx(GetFontDefault(), loadingText, fontSize, 2);
+    DrawText(loadingText, (gameState->screenWidth - textSize.x) / 2, 
+             gameState->screenHeight / 2 - 60, fontSize, WHITE);
+    
+    // Progress bar over the outstanding asset requests
+    float progress = GetAssetLoadProgress();
+    int barWidth = gameState->screenWidth / 3;
+    int barHeight = 16;
+    int barX = (gameState->screenWidth - barWidth) / 2;
+    int barY = gameState->screenHeight / 2;
+    DrawRectangle(barX, barY, barWidth, barHeight, DARKGRAY);
+    DrawRectangle(barX, barY, (int)(barWidth * progress), barHeight, GOLD);
+    DrawRectangleLines(barX, barY, barWidth, barHeight, LIGHTGRAY);
+}
+
 void DrawTitleScreen(GameState* gameState) {
     // Draw title screen background
     DrawRectangle(0, 0, gameState->screenWidth, gameState->screenHeight, BLACK);
@@ -353,32 +352,8 @@ void DrawTitleScreen(GameState* gameState) {
              gameState->screenHeight * 3/4 + 40, fontSize, LIGHTGRAY);
 }
 
-void DrawGameplay(GameState* gameState) {
-    // Enable 3D mode with the camera
-    BeginMode3D(gameState->camera);
-        
-        // Draw the dungeon
-        DrawDungeon(gameState->dungeon);
-        
-        // Draw decorative props
-        DrawDungeonProps(gameState->dungeon);
-        
-        // Draw enemies
-        for (int i = 0; i < gameState->enemyCount; i++) {
-            if (gameState->enemies[i].isAlive) {
-                DrawEnemy(&gameState->enemies[i], gameState->camera);
-            }
-        }
-        
-        // Draw items on the ground
-        for (int i = 0; i < gameState->itemCount; i++) {
-            if (gameState->items[i].isOnGround) {
-                DrawItem(&gameState->items[i]);
-            }
-        }
-        
-    EndMode3D();
-    
+// Draw the HUD and pause menu at full screen resolution
+void DrawGameplayHUD(GameState* gameState) {
     // Draw 2D UI elements
     DrawUI(gameState);
     
@@ -0,0 +1,73 @@
+#include "../include/input.h"
+
+// Check if the keys bound to an action are held
+static bool IsActionDown(InputAction action) {
+    switch (action) {
+        case INPUT_MOVE_FORWARD: return IsKeyDown(KEY_W);
+        case INPUT_MOVE_BACK:    return IsKeyDown(KEY_S);
+        case INPUT_STRAFE_LEFT:  return IsKeyDown(KEY_A);
+        case INPUT_STRAFE_RIGHT: return IsKeyDown(KEY_D);
+        case INPUT_JUMP:         return IsKeyDown(KEY_SPACE);
+        case INPUT_ATTACK:       return IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+        case INPUT_INTERACT:     return IsKeyDown(KEY_E);
+        case INPUT_PAUSE:        return IsKeyDown(KEY_P) || IsKeyDown(KEY_ESCAPE);
+        case INPUT_CONFIRM:      return IsKeyDown(KEY_ENTER) || IsKeyDown(KEY_SPACE);
+        case INPUT_RESTART:      return IsKeyDown(KEY_R);
+        default:                 return false;
+    }
+}
+
+// Check if the keys bound to an action were pressed this frame
+static bool IsActionPressed(InputAction action) {
+    switch (action) {
+        case INPUT_MOVE_FORWARD: return IsKeyPressed(KEY_W);
+        case INPUT_MOVE_BACK:    return IsKeyPressed(KEY_S);
+        case INPUT_STRAFE_LEFT:  return IsKeyPressed(KEY_A);
+        case INPUT_STRAFE_RIGHT: return IsKeyPressed(KEY_D);
+        case INPUT_JUMP:         return IsKeyPressed(KEY_SPACE);
+        case INPUT_ATTACK:       return IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+        case INPUT_INTERACT:     return IsKeyPressed(KEY_E);
+        case INPUT_PAUSE:        return IsKeyPressed(KEY_P) || IsKeyPressed(KEY_ESCAPE);
+        case INPUT_CONFIRM:      return IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE);
+        case INPUT_RESTART:      return IsKeyPressed(KEY_R);
+        default:                 return false;
+    }
+}
+
+// Sample the devices once per render frame, latching presses and mouse
+// movement into the pending frame until a simulation tick consumes them
+void PollInput(InputFrame* pending) {
+    pending->down = 0;
+
+    for (int action = 0; action < INPUT_ACTION_COUNT; action++) {
+        if (IsActionDown(action)) pending->down |= 1u << action;
+        if (IsActionPressed(action)) pending->pressed |= 1u << action;
+    }
+
+    Vector2 mouseDelta = GetMouseDelta();
+    pending->mouseDelta.x += mouseDelta.x;
+    pending->mouseDelta.y += mouseDelta.y;
+
+    // Make sure mouse stays centered - essential for FPS camera control
+    if (IsWindowFocused()) {
+        SetMousePosition(GetScreenWidth()/2, GetScreenHeight()/2);
+    }
+}
+
+// Take the input for one simulation tick and clear the latched events
+InputFrame ConsumeInput(InputFrame* pending) {
+    InputFrame input = *pending;
+    pending->pressed = 0;
+    pending->mouseDelta = (Vector2){0.0f, 0.0f};
+    return input;
+}
+
+// Check if an action is held during a tick
+bool InputDown(const InputFrame* input, InputAction action) {
+    return (input->down & (1u << action)) != 0;
+}
+
+// Check if an action was pressed for a tick
+bool InputPressed(const InputFrame* input, InputAction action) {
+    return (input->pressed & (1u << action)) != 0;
+}
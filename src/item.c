@@ -4,330 +4,146 @@
 #include <stdio.h>
 #include <string.h>
 
-// Forward declarations of helper functions
-void ConfigureWeapon(Item* item);
-void ConfigureArmor(Item* item);
-void ConfigureAccessory(Item* item);
-void ConfigurePotion(Item* item);
-void ConfigureScroll(Item* item);
-void ConfigureKey(Item* item);
-void ConfigureGold(Item* item);
-void ApplyLevelScaling(Item* item);
-void CreateItemModel(Item* item);
+// Definition table, compiled from data/items.def
+const ItemDef itemDefs[ITEM_DEF_COUNT] = {
+#define ITEM_DEF(id, type, subType, name, description, shape, sizeX, sizeY, sizeZ, \
+                 minDamage, maxDamage, armor, strength, dexterity, intelligence, \
+                 effectValue, effectDuration, value, color) \
+    [ITEM_DEF_##id] = { name, description, shape, { sizeX, sizeY, sizeZ }, \
+                        minDamage, maxDamage, armor, strength, dexterity, intelligence, \
+                        effectValue, effectDuration, value, color },
+#define ITEM_DEFAULT ITEM_DEF
+#include "../data/items.def"
+#undef ITEM_DEF
+#undef ITEM_DEFAULT
+};
 
-// Initialize an item
-void InitItem(Item* item, ItemType type, int subType, int level, Vector3 position) {
-    // Clear item data
-    memset(item, 0, sizeof(Item));
-    
-    // Set basic properties
-    item->type = type;
-    item->subType = subType;
-    item->level = level;
-    item->position = position;
-    item->isOnGround = true;
-    item->rotationAngle = 0.0f;
-    item->bobHeight = 0.0f;
-    item->bobTimer = 0.0f;
-    item->isEquipped = false;
-    item->isIdentified = false;
-    
-    // Set item properties based on type and subtype
-    switch(type) {
-        case ITEM_WEAPON:
-            ConfigureWeapon(item);
-            break;
-        case ITEM_ARMOR:
-            ConfigureArmor(item);
-            break;
-        case ITEM_ACCESSORY:
-            ConfigureAccessory(item);
-            break;
-        case ITEM_POTION:
-            ConfigurePotion(item);
-            break;
-        case ITEM_SCROLL:
-            ConfigureScroll(item);
-            break;
-        case ITEM_KEY:
-            ConfigureKey(item);
-            break;
-        case ITEM_GOLD:
-            ConfigureGold(item);
-            break;
-        default:
-            break;
-    }
-    
-    // Apply level-based scaling to stats
-    ApplyLevelScaling(item);
-    
-    // Create a simple model for the item based on its type
-    CreateItemModel(item);
-}
+// Definition of each type/subtype pair, plus one so zero marks a subtype
+// without a row of its own
+static const unsigned char itemDefSlots[ITEM_TYPE_COUNT][ITEM_MAX_SUBTYPES] = {
+#define ITEM_DEF(id, type, subType, ...) [type][subType] = ITEM_DEF_##id + 1,
+#define ITEM_DEFAULT(...)
+#include "../data/items.def"
+#undef ITEM_DEF
+#undef ITEM_DEFAULT
+};
 
-// Configure weapon properties
-void ConfigureWeapon(Item* item) {
-    switch(item->subType) {
-        case WEAPON_SWORD:
-            strcpy(item->name, "Sword");
-            strcpy(item->description, "A sharp blade for cutting enemies.");
-            item->minDamage = 5;
-            item->maxDamage = 10;
-            item->value = 100;
-            item->color = RED;
-            break;
-        case WEAPON_AXE:
-            strcpy(item->name, "Axe");
-            strcpy(item->description, "A heavy axe that deals crushing blows.");
-            item->minDamage = 7;
-            item->maxDamage = 12;
-            item->value = 120;
-            item->color = DARKGRAY;
-            break;
-        case WEAPON_MACE:
-            strcpy(item->name, "Mace");
-            strcpy(item->description, "A blunt weapon good against armored foes.");
-            item->minDamage = 6;
-            item->maxDamage = 11;
-            item->value = 110;
-            item->color = GRAY;
-            break;
-        case WEAPON_STAFF:
-            strcpy(item->name, "Staff");
-            strcpy(item->description, "A magical staff that boosts intelligence.");
-            item->minDamage = 4;
-            item->maxDamage = 8;
-            item->intelligence = 5;
-            item->value = 150;
-            item->color = PURPLE;
-            break;
-        case WEAPON_BOW:
-            strcpy(item->name, "Bow");
-            strcpy(item->description, "A ranged weapon for attacking from afar.");
-            item->minDamage = 5;
-            item->maxDamage = 9;
-            item->dexterity = 3;
-            item->value = 130;
-            item->color = BROWN;
-            break;
-        default:
-            strcpy(item->name, "Unknown Weapon");
-            strcpy(item->description, "A mysterious weapon.");
-            item->minDamage = 3;
-            item->maxDamage = 7;
-            item->value = 50;
-            item->color = WHITE;
-            break;
-    }
-}
+// Definition each type falls back to
+static const unsigned char itemTypeDefaults[ITEM_TYPE_COUNT] = {
+#define ITEM_DEF(...)
+#define ITEM_DEFAULT(id, type, ...) [type] = ITEM_DEF_##id,
+#include "../data/items.def"
+#undef ITEM_DEF
+#undef ITEM_DEFAULT
+};
 
-// Configure armor properties
-void ConfigureArmor(Item* item) {
-    switch(item->subType) {
-        case ARMOR_HELMET:
-            strcpy(item->name, "Helmet");
-            strcpy(item->description, "Protects your head from damage.");
-            item->armor = 5;
-            item->value = 80;
-            item->color = LIGHTGRAY;
-            break;
-        case ARMOR_CHEST:
-            strcpy(item->name, "Chestplate");
-            strcpy(item->description, "Heavy armor for your torso.");
-            item->armor = 10;
-            item->value = 150;
-            item->color = DARKGRAY;
-            break;
-        case ARMOR_GLOVES:
-            strcpy(item->name, "Gloves");
-            strcpy(item->description, "Protective hand coverings.");
-            item->armor = 3;
-            item->dexterity = 2;
-            item->value = 60;
-            item->color = BROWN;
-            break;
-        case ARMOR_BOOTS:
-            strcpy(item->name, "Boots");
-            strcpy(item->description, "Sturdy footwear for the dungeon.");
-            item->armor = 4;
-            item->value = 70;
-            item->color = DARKBROWN;
-            break;
-        default:
-            strcpy(item->name, "Unknown Armor");
-            strcpy(item->description, "A mysterious piece of armor.");
-            item->armor = 3;
-            item->value = 50;
-            item->color = GRAY;
-            break;
-    }
-}
+// Which stats grow with item level, per type
+typedef struct {
+    bool attributes;                    // Damage, armor, strength, dexterity, intelligence
+    bool effect;
+    bool value;
+} ItemScaling;
 
-// Configure accessory properties
-void ConfigureAccessory(Item* item) {
-    strcpy(item->name, "Magic Amulet");
-    strcpy(item->description, "An accessory with magical properties.");
-    item->intelligence = 3;
-    item->dexterity = 2;
-    item->strength = 2;
-    item->value = 200;
-    item->color = GOLD;
-}
+static const ItemScaling itemScaling[ITEM_TYPE_COUNT] = {
+    [ITEM_NONE]      = { false, false, true },
+    [ITEM_WEAPON]    = { true,  false, true },
+    [ITEM_ARMOR]     = { true,  false, true },
+    [ITEM_ACCESSORY] = { false, false, true },
+    [ITEM_POTION]    = { false, true,  true },
+    [ITEM_SCROLL]    = { false, false, true },
+    [ITEM_KEY]       = { false, false, true },
+    [ITEM_GOLD]      = { false, false, false }   // The amount already grows with level
+};
 
-// Configure potion properties
-void ConfigurePotion(Item* item) {
-    switch(item->subType) {
-        case POTION_HEALTH:
-            strcpy(item->name, "Health Potion");
-            strcpy(item->description, "Restores health when consumed.");
-            item->effectValue = 30;
-            item->value = 40;
-            item->color = RED;
-            break;
-        case POTION_MANA:
-            strcpy(item->name, "Mana Potion");
-            strcpy(item->description, "Restores mana when consumed.");
-            item->effectValue = 30;
-            item->value = 40;
-            item->color = BLUE;
-            break;
-        case POTION_STRENGTH:
-            strcpy(item->name, "Strength Potion");
-            strcpy(item->description, "Temporarily boosts strength.");
-            item->effectValue = 5;
-            item->effectDuration = 60.0f;
-            item->value = 60;
-            item->color = MAROON;
-            break;
-        case POTION_SPEED:
-            strcpy(item->name, "Speed Potion");
-            strcpy(item->description, "Temporarily increases movement speed.");
-            item->effectValue = 2;
-            item->effectDuration = 60.0f;
-            item->value = 60;
-            item->color = LIME;
-            break;
-        case POTION_INVISIBILITY:
-            strcpy(item->name, "Invisibility Potion");
-            strcpy(item->description, "Temporarily makes you harder to detect.");
-            item->effectDuration = 30.0f;
-            item->value = 100;
-            item->color = SKYBLUE;
-            break;
-        default:
-            strcpy(item->name, "Unknown Potion");
-            strcpy(item->description, "A mysterious liquid in a bottle.");
-            item->effectValue = 10;
-            item->value = 20;
-            item->color = PURPLE;
-            break;
-    }
+// Look up the definition for an item type and subtype
+const ItemDef* GetItemDef(ItemType type, int subType) {
+    int slot = (subType >= 0 && subType < ITEM_MAX_SUBTYPES) ? itemDefSlots[type][subType] : 0;
+    return &itemDefs[slot != 0 ? slot - 1 : itemTypeDefaults[type]];
 }
 
-// Configure scroll properties
-void ConfigureScroll(Item* item) {
-    strcpy(item->name, "Magic Scroll");
-    strcpy(item->description, "A scroll with magical properties.");
-    item->effectValue = 50;
-    item->value = 75;
-    item->color = BEIGE;
-}
+// Shared models and icons, one per definition. They are acquired on the
+// main thread before the first level, so making an item never touches
+// the GPU.
+static AssetHandle itemModelHandles[ITEM_DEF_COUNT];
+static AssetHandle itemIconHandles[ITEM_DEF_COUNT];
+static Model itemModels[ITEM_DEF_COUNT];
+static Texture2D itemIcons[ITEM_DEF_COUNT];
+static bool itemModelsLoaded = false;
 
-// Configure key properties
-void ConfigureKey(Item* item) {
-    strcpy(item->name, "Dungeon Key");
-    strcpy(item->description, "A key to unlock doors in the dungeon.");
-    item->value = 50;
-    item->color = GOLD;
+// Acquire every definition's model, in its color, and icon
+void LoadItemModels(void) {
+    if (itemModelsLoaded) return;
+    
+    for (int i = 0; i < ITEM_DEF_COUNT; i++) {
+        const ItemDef* def = &itemDefs[i];
+        char key[ASSET_KEY_LENGTH];
+        snprintf(key, sizeof(key), "item/%s", def->name);
+        
+        itemModelHandles[i] = AcquireMeshModel(key, def->shape, def->shapeSize, 8);
+        Model* model = GetModelAsset(itemModelHandles[i]);
+        if (model != NULL) {
+            model->materials[0].maps[MATERIAL_MAP_DIFFUSE].color = def->color;
+            itemModels[i] = *model;
+        }
+        
+        itemIconHandles[i] = AcquireColorTexture(ITEM_ICON_SIZE, def->color);
+        itemIcons[i] = GetTextureAsset(itemIconHandles[i]);
+    }
+    itemModelsLoaded = true;
 }
 
-// Configure gold properties
-void ConfigureGold(Item* item) {
-    int amount = (item->level * 10) + GetRandomValue(1, 20);
-    sprintf(item->name, "%d Gold", amount);
-    strcpy(item->description, "Shiny gold coins.");
-    item->value = amount;
-    item->color = GOLD;
+// Release the shared models and icons
+void UnloadItemModels(void) {
+    if (!itemModelsLoaded) return;
+    
+    for (int i = 0; i < ITEM_DEF_COUNT; i++) {
+        ReleaseAsset(itemModelHandles[i]);
+        ReleaseAsset(itemIconHandles[i]);
+        itemModels[i] = (Model){0};
+        itemIcons[i] = (Texture2D){0};
+    }
+    itemModelsLoaded = false;
 }
 
-// Apply level scaling to item stats
-void ApplyLevelScaling(Item* item) {
-    // Scale stats based on item level
-    float levelMultiplier = 1.0f + (item->level * 0.2f);
+// Initialize an item from its definition, scaled to its level
+void InitItem(Item* item, ItemType type, int subType, int level, Vector3 position) {
+    const ItemDef* def = GetItemDef(type, subType);
+    const ItemScaling* scaling = &itemScaling[type];
+    float levelMultiplier = 1.0f + (level * 0.2f);
+    float attributeMultiplier = scaling->attributes ? levelMultiplier : 1.0f;
     
-    // Apply scaling based on item type
-    switch(item->type) {
-        case ITEM_WEAPON:
-            item->minDamage = (int)(item->minDamage * levelMultiplier);
-            item->maxDamage = (int)(item->maxDamage * levelMultiplier);
-            item->strength = (int)(item->strength * levelMultiplier);
-            item->dexterity = (int)(item->dexterity * levelMultiplier);
-            item->intelligence = (int)(item->intelligence * levelMultiplier);
-            break;
-        case ITEM_ARMOR:
-            item->armor = (int)(item->armor * levelMultiplier);
-            item->strength = (int)(item->strength * levelMultiplier);
-            item->dexterity = (int)(item->dexterity * levelMultiplier);
-            item->intelligence = (int)(item->intelligence * levelMultiplier);
-            break;
-        case ITEM_POTION:
-            item->effectValue = (int)(item->effectValue * levelMultiplier);
-            break;
-        default:
-            break;
-    }
+    // Clear item data
+    memset(item, 0, sizeof(Item));
     
-    // Scale value with level
-    item->value = (int)(item->value * levelMultiplier);
+    // Set basic properties
+    item->type = type;
+    item->subType = subType;
+    item->level = level;
+    item->position = position;
+    item->isOnGround = true;
     
-    // Add level to name for higher level items
-    if (item->level > 1) {
-        char leveledName[64];
-        sprintf(leveledName, "%s +%d", item->name, item->level);
-        strcpy(item->name, leveledName);
-    }
-}
-
-// Create a model for the item
-void CreateItemModel(Item* item) {
-    // Create different shapes based on item type
-    switch(item->type) {
-        case ITEM_WEAPON:
-            if (item->subType == WEAPON_SWORD) {
-                item->model = LoadModelFromMesh(GenMeshCube(0.1f, 0.8f, 0.1f));
-            } else if (item->subType == WEAPON_AXE) {
-                item->model = LoadModelFromMesh(GenMeshCube(0.3f, 0.6f, 0.1f));
-            } else if (item->subType == WEAPON_STAFF) {
-                item->model = LoadModelFromMesh(GenMeshCylinder(0.05f, 1.0f, 8));
-            } else {
-                item->model = LoadModelFromMesh(GenMeshCube(0.2f, 0.6f, 0.2f));
-            }
-            break;
-        case ITEM_ARMOR:
-            item->model = LoadModelFromMesh(GenMeshCube(0.4f, 0.4f, 0.4f));
-            break;
-        case ITEM_POTION:
-            item->model = LoadModelFromMesh(GenMeshCylinder(0.1f, 0.3f, 8));
-            break;
-        case ITEM_SCROLL:
-            item->model = LoadModelFromMesh(GenMeshCylinder(0.1f, 0.3f, 8));
-            break;
-        case ITEM_GOLD:
-            item->model = LoadModelFromMesh(GenMeshSphere(0.15f, 8, 8));
-            break;
-        default:
-            item->model = LoadModelFromMesh(GenMeshCube(0.3f, 0.3f, 0.3f));
-            break;
-    }
+    // Definition stats with level scaling
+    item->name = def->name;
+    item->description = def->description;
+    item->color = def->color;
+    item->minDamage = (int)(def->minDamage * attributeMultiplier);
+    item->maxDamage = (int)(def->maxDamage * attributeMultiplier);
+    item->armor = (int)(def->armor * attributeMultiplier);
+    item->strength = (int)(def->strength * attributeMultiplier);
+    item->dexterity = (int)(def->dexterity * attributeMultiplier);
+    item->intelligence = (int)(def->intelligence * attributeMultiplier);
+    item->effectValue = (int)(def->effectValue * (scaling->effect ? levelMultiplier : 1.0f));
+    item->effectDuration = def->effectDuration;
+    item->value = (int)(def->value * (scaling->value ? levelMultiplier : 1.0f));
     
-    // Set the model color
-    item->model.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = item->color;
+    // Gold is the one item rolled rather than defined
+    if (type == ITEM_GOLD) {
+        item->value = (level * 10) + GetRandomValue(1, 20);
+    }
     
-    // Create a simple icon for the item
-    Image iconImage = GenImageColor(40, 40, item->color);
-    item->icon = LoadTextureFromImage(iconImage);
-    UnloadImage(iconImage);
+    // The definition's shared model and icon
+    item->model = &itemModels[def - itemDefs];
+    item->icon = itemIcons[def - itemDefs];
 }
 
 // Update item state
@@ -345,24 +161,17 @@ void UpdateItem(Item* item, float deltaTime) {
     }
 }
 
-// Draw item in the world
-void DrawItem(Item* item) {
-    if (item->isOnGround) {
-        // Calculate position with bobbing effect
-        Vector3 drawPosition = {
-            item->position.x,
-            item->position.y + 0.5f + item->bobHeight,
-            item->position.z
-        };
-        
-        // Draw the item with rotation
-        DrawModelEx(item->model, 
-                   drawPosition, 
-                   (Vector3){0.0f, 1.0f, 0.0f}, 
-                   item->rotationAngle, 
-                   (Vector3){1.0f, 1.0f, 1.0f}, 
-                   WHITE);
-    }
+// Record an item lying in the world, with its bob and spin, for drawing
+void RecordItem(const Item* item, unsigned int id, SceneList* scene) {
+    if (!item->isOnGround || item->model->meshCount == 0) return;
+    
+    // Calculate position with bobbing effect
+    Vector3 drawPosition = {
+        item->position.x,
+        item->position.y + 0.5f + item->bobHeight,
+        item->position.z
+    };
+    RecordSceneModel(scene, id, item->model, drawPosition, item->rotationAngle, WHITE);
 }
 
 // Draw item icon in UI
@@ -378,14 +187,6 @@ void DrawItemIcon(Item* item, Rectangle bounds) {
     DrawRectangleLines(bounds.x, bounds.y, bounds.width, bounds.height, GRAY);
 }
 
-// Unload item resources
-void UnloadItem(Item* item) {
-    UnloadModel(item->model);
-    if (item->icon.id != 0) {
-        UnloadTexture(item->icon);
-    }
-}
-
 // Generate a random item appropriate for the given level
 Item GenerateRandomItem(int level) {
     Item item;
@@ -398,15 +199,15 @@ Item GenerateRandomItem(int level) {
     if (typeRoll <= 35) {
         // 35% chance for weapon
         type = ITEM_WEAPON;
-        subType = GetRandomValue(0, 4); // Random weapon type
+        subType = GetRandomValue(0, WEAPON_COUNT - 1);
     } else if (typeRoll <= 65) {
         // 30% chance for armor
         type = ITEM_ARMOR;
-        subType = GetRandomValue(0, 3); // Random armor type
+        subType = GetRandomValue(0, ARMOR_COUNT - 1);
     } else if (typeRoll <= 85) {
         // 20% chance for potion
         type = ITEM_POTION;
-        subType = GetRandomValue(0, 4); // Random potion type
+        subType = GetRandomValue(0, POTION_COUNT - 1);
     } else if (typeRoll <= 90) {
         // 5% chance for accessory
         type = ITEM_ACCESSORY;
@@ -427,8 +228,19 @@ Item GenerateRandomItem(int level) {
     return item;
 }
 
-// Get item name
+// Get item name. Gold and leveled items are labelled on request rather
+// than when created; the label stays valid until the next call.
 const char* GetItemName(Item* item) {
+    static char label[64];
+    
+    if (item->type == ITEM_GOLD) {
+        snprintf(label, sizeof(label), "%d Gold", item->value);
+        return label;
+    }
+    if (item->level > 1) {
+        snprintf(label, sizeof(label), "%s +%d", item->name, item->level);
+        return label;
+    }
     return item->name;
 }
 
@@ -0,0 +1,248 @@
+#include "../include/jobs.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define JOB_IDLE_ATTEMPTS 64            // Empty searches a worker makes before it sleeps
+
+// Chase-Lev deque. The owner pushes and pops at the bottom; thieves take
+// from the top, racing each other and the owner's last pop with a CAS.
+typedef struct {
+    atomic_long top;
+    atomic_long bottom;
+    _Atomic(Job*) slots[JOB_DEQUE_CAPACITY];
+} JobDeque;
+
+// Job system state. Threads find their deque through workerIndex, which
+// is -1 on threads outside the system.
+static JobDeque deques[JOB_MAX_WORKERS];
+static pthread_t workers[JOB_MAX_WORKERS];
+static atomic_int workerCount;          // Grows while InitJobSystem starts the threads
+static _Thread_local int workerIndex = -1;
+
+// Sleeping workers wait for queuedJobs to rise. It is raised before a push
+// and sleepers are counted before they look at it, so a push never misses
+// a worker that is about to sleep.
+static pthread_mutex_t sleepMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobsQueued = PTHREAD_COND_INITIALIZER;
+static atomic_int queuedJobs;
+static atomic_int sleepingWorkers;
+static atomic_bool quitWorkers;
+
+// Add a job at the owner's end. Fails when the deque is full.
+static bool PushJob(JobDeque* deque, Job* job) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) return false;
+
+    atomic_store_explicit(&deque->slots[bottom & (JOB_DEQUE_CAPACITY - 1)], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return true;
+}
+
+// Take the newest job from the owner's end
+static Job* PopJob(JobDeque* deque) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    Job* job = atomic_load_explicit(&deque->slots[bottom & (JOB_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (top == bottom) {
+        // Last job - a thief may be after it too
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            job = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+// Take the oldest job from another thread's deque
+static Job* StealJob(JobDeque* deque) {
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return NULL;
+
+    Job* job = atomic_load_explicit(&deque->slots[top & (JOB_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return NULL;
+    }
+    return job;
+}
+
+// Own jobs first, newest first while they are warm in cache, then the
+// oldest job of each other thread in turn
+static Job* FindJob(int worker) {
+    Job* job = PopJob(&deques[worker]);
+    for (int i = 1; job == NULL && i < workerCount; i++) {
+        job = StealJob(&deques[(worker + i) % workerCount]);
+    }
+    if (job != NULL) atomic_fetch_sub(&queuedJobs, 1);
+    return job;
+}
+
+// Run a job and count it done. The job may be gone once its counter
+// reaches zero, so nothing reads it after that.
+static void ExecuteJob(Job* job) {
+    JobCounter* counter = job->counter;
+    job->function(job->context, job->begin, job->end);
+    atomic_fetch_sub_explicit(&counter->pending, 1, memory_order_release);
+}
+
+// Worker thread - runs and steals jobs, and sleeps while there are none
+static void* JobWorker(void* arg) {
+    workerIndex = (int)(size_t)arg;
+    int idleAttempts = 0;
+
+    while (!atomic_load(&quitWorkers)) {
+        Job* job = FindJob(workerIndex);
+        if (job != NULL) {
+            ExecuteJob(job);
+            idleAttempts = 0;
+            continue;
+        }
+        if (++idleAttempts < JOB_IDLE_ATTEMPTS) {
+            sched_yield();
+            continue;
+        }
+
+        pthread_mutex_lock(&sleepMutex);
+        atomic_fetch_add(&sleepingWorkers, 1);
+        while (atomic_load(&queuedJobs) <= 0 && !atomic_load(&quitWorkers)) {
+            pthread_cond_wait(&jobsQueued, &sleepMutex);
+        }
+        atomic_fetch_sub(&sleepingWorkers, 1);
+        pthread_mutex_unlock(&sleepMutex);
+        idleAttempts = 0;
+    }
+
+    return NULL;
+}
+
+// Start the worker threads. The calling thread becomes worker 0, so
+// workerCount includes it; zero or less means one per core.
+void InitJobSystem(int wanted) {
+    if (workerCount > 0) return;
+
+    if (wanted <= 0) wanted = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (wanted < 1) wanted = 1;
+    if (wanted > JOB_MAX_WORKERS) wanted = JOB_MAX_WORKERS;
+
+    for (int i = 0; i < JOB_MAX_WORKERS; i++) {
+        atomic_store(&deques[i].top, 0);
+        atomic_store(&deques[i].bottom, 0);
+    }
+    atomic_store(&queuedJobs, 0);
+    atomic_store(&sleepingWorkers, 0);
+    atomic_store(&quitWorkers, false);
+
+    workerIndex = 0;
+    workerCount = 1;
+    for (int i = 1; i < wanted; i++) {
+        if (pthread_create(&workers[workerCount], NULL, JobWorker, (void*)(size_t)workerCount) == 0) {
+            workerCount++;
+        }
+    }
+
+    TraceLog(LOG_INFO, "JOBS: Job system started with %d worker(s)", workerCount);
+}
+
+// Stop the worker threads. Jobs must all have been waited on.
+void UnloadJobSystem(void) {
+    if (workerCount == 0) return;
+
+    pthread_mutex_lock(&sleepMutex);
+    atomic_store(&quitWorkers, true);
+    pthread_cond_broadcast(&jobsQueued);
+    pthread_mutex_unlock(&sleepMutex);
+
+    for (int i = 1; i < workerCount; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    workerCount = 0;
+    workerIndex = -1;
+}
+
+// Threads that run jobs, the starting thread included; 1 when the system
+// is not running
+int GetJobWorkerCount(void) {
+    return (workerCount > 0) ? workerCount : 1;
+}
+
+// Queue jobs on the calling thread's deque for any worker to run. The
+// counter is raised by count and falls as they finish. Jobs that don't
+// fit, or are run from outside the system, run here and now.
+void RunJobs(Job* jobs, int count, JobCounter* counter) {
+    atomic_fetch_add(&counter->pending, count);
+
+    int queued = 0;
+    for (int i = 0; i < count; i++) {
+        jobs[i].counter = counter;
+        if (workerIndex >= 0 && workerCount > 1) {
+            atomic_fetch_add(&queuedJobs, 1);
+            if (PushJob(&deques[workerIndex], &jobs[i])) {
+                queued++;
+                continue;
+            }
+            atomic_fetch_sub(&queuedJobs, 1);
+        }
+        ExecuteJob(&jobs[i]);
+    }
+
+    if (queued > 0 && atomic_load(&sleepingWorkers) > 0) {
+        pthread_mutex_lock(&sleepMutex);
+        pthread_cond_broadcast(&jobsQueued);
+        pthread_mutex_unlock(&sleepMutex);
+    }
+}
+
+// Return once every job run with the counter has finished, running queued
+// jobs meanwhile instead of blocking
+void WaitForJobs(JobCounter* counter) {
+    while (atomic_load_explicit(&counter->pending, memory_order_acquire) > 0) {
+        Job* job = (workerIndex >= 0) ? FindJob(workerIndex) : NULL;
+        if (job != NULL) {
+            ExecuteJob(job);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+// Split [0, count) into ranges of at least grain indices, spread them over
+// the workers and wait for all of them. Each range is handed to the
+// function once; results stay deterministic as long as ranges only write
+// their own indices, or the caller merges per-range output in range order.
+void ParallelFor(int count, int grain, JobFunction function, void* context) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+
+    // A few ranges per worker so stealing can even out uneven ones
+    int splits = (count + grain - 1) / grain;
+    int maxSplits = GetJobWorkerCount() * 4;
+    if (splits > maxSplits) splits = maxSplits;
+    if (splits > JOB_MAX_SPLITS) splits = JOB_MAX_SPLITS;
+    if (splits <= 1 || GetJobWorkerCount() == 1) {
+        function(context, 0, count);
+        return;
+    }
+
+    Job jobs[JOB_MAX_SPLITS];
+    for (int i = 0; i < splits; i++) {
+        jobs[i] = (Job){ function, context, (int)((long)count * i / splits), (int)((long)count * (i + 1) / splits), NULL };
+    }
+
+    JobCounter counter = { 0 };
+    RunJobs(jobs, splits, &counter);
+    WaitForJobs(&counter);
+}
@@ -0,0 +1,185 @@
+#include "../include/lightmap.h"
+#include "../include/jobs.h"
+#include "raymath.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+// Bake passes - walls are lit from their neighbouring open tiles,
+// so they can only be baked once every open tile is done
+typedef enum {
+    BAKE_PASS_OPEN_TILES,
+    BAKE_PASS_WALLS
+} BakePass;
+
+// Shared state for the bake jobs
+typedef struct {
+    Dungeon* dungeon;
+    BakePass pass;
+} BakeJob;
+
+// Check if a tile lets light through
+static bool IsOpenTile(Dungeon* dungeon, int x, int y) {
+    if (x < 0 || x >= dungeon->width || y < 0 || y >= dungeon->height) return false;
+    return dungeon->tiles[x][y] != TILE_WALL && dungeon->tiles[x][y] != TILE_NONE;
+}
+
+// Pack a linear light value into a tint colour
+static Color LightToColor(float r, float g, float b) {
+    return (Color){
+        (unsigned char)(Clamp(r, 0.0f, 1.0f) * 255.0f),
+        (unsigned char)(Clamp(g, 0.0f, 1.0f) * 255.0f),
+        (unsigned char)(Clamp(b, 0.0f, 1.0f) * 255.0f),
+        255
+    };
+}
+
+// Bake a single open (floor-like) tile
+static Color BakeOpenTile(Dungeon* dungeon, int x, int y) {
+    // Ambient occlusion from the surrounding 8 tiles
+    int wallCount = 0;
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            if ((dx != 0 || dy != 0) && !IsOpenTile(dungeon, x + dx, y + dy)) {
+                wallCount++;
+            }
+        }
+    }
+    float ambient = LIGHTMAP_AMBIENT * (1.0f - wallCount * LIGHTMAP_AO_STRENGTH);
+
+    float r = ambient;
+    float g = ambient;
+    float b = ambient;
+
+    // Accumulate every torch that can see this tile
+    for (int i = 0; i < dungeon->torchCount; i++) {
+        TorchLight* torch = &dungeon->torches[i];
+        float amount = TorchLightAmount(torch, x, y);
+
+        if (amount <= 0.0f) continue;
+        if (!TileLineOfSight(dungeon, torch->tileX, torch->tileY, x, y)) continue;
+
+        r += amount * torch->color.r / 255.0f;
+        g += amount * torch->color.g / 255.0f;
+        b += amount * torch->color.b / 255.0f;
+    }
+
+    return LightToColor(r, g, b);
+}
+
+// Bake a wall tile from the brightest open tile next to it
+static Color BakeWallTile(Dungeon* dungeon, int x, int y) {
+    const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    Color brightest = LightToColor(LIGHTMAP_AMBIENT * 0.5f, LIGHTMAP_AMBIENT * 0.5f, LIGHTMAP_AMBIENT * 0.5f);
+
+    for (int i = 0; i < 4; i++) {
+        int nx = x + offsets[i][0];
+        int ny = y + offsets[i][1];
+        if (!IsOpenTile(dungeon, nx, ny)) continue;
+
+        Color neighbour = dungeon->bakedLight[nx * dungeon->height + ny];
+        if (neighbour.r + neighbour.g + neighbour.b > brightest.r + brightest.g + brightest.b) {
+            brightest = neighbour;
+        }
+    }
+
+    return brightest;
+}
+
+// Bake job - one pass over a range of whole columns
+static void BakeColumns(void* context, int begin, int end) {
+    BakeJob* job = (BakeJob*)context;
+    Dungeon* dungeon = job->dungeon;
+
+    for (int x = begin; x < end; x++) {
+        for (int y = 0; y < dungeon->height; y++) {
+            bool open = IsOpenTile(dungeon, x, y);
+
+            if (job->pass == BAKE_PASS_OPEN_TILES && open) {
+                dungeon->bakedLight[x * dungeon->height + y] = BakeOpenTile(dungeon, x, y);
+            } else if (job->pass == BAKE_PASS_WALLS && !open) {
+                dungeon->bakedLight[x * dungeon->height + y] = BakeWallTile(dungeon, x, y);
+            }
+        }
+    }
+}
+
+// Bake ambient occlusion and static torch light for the whole dungeon
+void BakeDungeonLighting(Dungeon* dungeon) {
+    double startTime = GetTime();
+
+    UnloadDungeonLighting(dungeon);
+    dungeon->bakedLight = (Color*)malloc(dungeon->width * dungeon->height * sizeof(Color));
+    if (dungeon->bakedLight == NULL) return;
+
+    // The grid is split by columns across the job system. Each tile is
+    // written by one job only, so the result doesn't depend on the split.
+    BakeJob job = { .dungeon = dungeon, .pass = BAKE_PASS_OPEN_TILES };
+    ParallelFor(dungeon->width, LIGHTMAP_COLUMN_GRAIN, BakeColumns, &job);
+    job.pass = BAKE_PASS_WALLS;
+    ParallelFor(dungeon->width, LIGHTMAP_COLUMN_GRAIN, BakeColumns, &job);
+
+    TraceLog(LOG_INFO, "LIGHTMAP: Baked %dx%d tiles with %d torches on %d workers in %.2f ms",
+             dungeon->width, dungeon->height, dungeon->torchCount, GetJobWorkerCount(),
+             (GetTime() - startTime) * 1000.0);
+}
+
+// Free the baked lighting buffer
+void UnloadDungeonLighting(Dungeon* dungeon) {
+    if (dungeon->bakedLight != NULL) {
+        free(dungeon->bakedLight);
+        dungeon->bakedLight = NULL;
+    }
+}
+
+// Get the baked light colour for a tile
+Color GetTileLight(Dungeon* dungeon, int x, int y) {
+    if (dungeon->bakedLight == NULL || x < 0 || x >= dungeon->width || y < 0 || y >= dungeon->height) {
+        return WHITE;
+    }
+
+    Color light = dungeon->bakedLight[x * dungeon->height + y];
+
+    // Remove torch light blocked by moving casters this frame
+    if (dungeon->dynamicShadow != NULL) {
+        Vector3 shadow = dungeon->dynamicShadow[x * dungeon->height + y];
+        light.r = (unsigned char)Clamp(light.r - shadow.x * 255.0f, 0.0f, 255.0f);
+        light.g = (unsigned char)Clamp(light.g - shadow.y * 255.0f, 0.0f, 255.0f);
+        light.b = (unsigned char)Clamp(light.b - shadow.z * 255.0f, 0.0f, 255.0f);
+    }
+
+    return light;
+}
+
+// Light a torch casts on a tile, ignoring walls
+float TorchLightAmount(const TorchLight* torch, int x, int y) {
+    float dx = (float)(x - torch->tileX);
+    float dy = (float)(y - torch->tileY);
+    float distSq = dx*dx + dy*dy;
+
+    if (distSq >= torch->radius * torch->radius) return 0.0f;
+
+    // Smooth quadratic falloff to zero at the light radius
+    float falloff = 1.0f - sqrtf(distSq) / torch->radius;
+    return torch->intensity * falloff * falloff;
+}
+
+// Bresenham walk between two tiles, blocked by any wall in between
+bool TileLineOfSight(Dungeon* dungeon, int x0, int y0, int x1, int y1) {
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    while (x0 != x1 || y0 != y1) {
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+
+        // The end tile itself never blocks
+        if (x0 == x1 && y0 == y1) break;
+        if (!IsOpenTile(dungeon, x0, y0)) return false;
+    }
+
+    return true;
+}
@@ -6,28 +6,183 @@
 #include "../include/enemy.h"
 #include "../include/item.h"
 #include "../include/ui.h"
+#include "../include/input.h"
+#include "../include/sim.h"
+#include "../include/resolution.h"
+#include "../include/assets.h"
+#include "../include/asset_loader.h"
+#include "../include/pak.h"
+#include "../include/shader_cache.h"
+#include "../include/audio.h"
+#include "../include/jobs.h"
+#include "../include/replay.h"
+#include "../include/main_thread.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #define SCREEN_WIDTH 1280
 #define SCREEN_HEIGHT 720
+#define TARGET_FPS 60
+#define ASSET_UPLOAD_BUDGET 0.004     // Seconds per frame spent on GPU uploads
+#define RENDER_QUEUE_CAPACITY 4096
 #define GAME_TITLE "Craven Caverns"
 
-int main(void) {
+// Seconds on the monotonic clock - GetTime only starts at InitWindow, so
+// startup is timed with this instead
+static double GetLaunchClock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// Take a recorded session's input in place of the devices', or record
+// the live input. Both start on the first gameplay tick; before that a
+// replay only presses start. Returns false once a replay runs out.
+static bool ApplyReplay(Replay* replay, GameState* gameState, bool* started) {
+    if (replay->mode == REPLAY_OFF) return true;
+    
+    if (!*started && gameState->currentState != GAMEPLAY) {
+        if (replay->mode == REPLAY_PLAYING) {
+            gameState->input = (InputFrame){ .pressed = 1u << INPUT_CONFIRM };
+        }
+        return true;
+    }
+    *started = true;
+    
+    if (replay->mode == REPLAY_RECORDING) {
+        RecordReplayTick(replay, &gameState->input);
+        return true;
+    }
+    return NextReplayTick(replay, &gameState->input);
+}
+
+// Sleep for a number of seconds, if any
+static void SleepSeconds(double seconds) {
+    if (seconds <= 0.0) return;
+    struct timespec duration = { (time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9) };
+    nanosleep(&duration, NULL);
+}
+
+// The simulation thread and what it shares with the main thread
+typedef struct {
+    GameState* gameState;
+    SimClock* clock;
+    Replay* replay;
+    atomic_bool stop;                   // Set to end the simulation
+    atomic_bool finished;               // Set by the simulation as its thread exits
+    int exitCode;                       // Read once the thread has been joined
+} Simulation;
+
+// Simulation thread: runs UpdateGame at the fixed tick and publishes a
+// snapshot after each batch of ticks. It owns the game state until it is
+// joined, and hands anything needing the GL context to the main thread.
+static void* RunSimulation(void* argument) {
+    Simulation* simulation = (Simulation*)argument;
+    GameState* gameState = simulation->gameState;
+    SimClock* clock = simulation->clock;
+    Replay* replay = simulation->replay;
+    bool replaying = (replay->mode == REPLAY_PLAYING);
+    
+    // Worker threads for simulation and generation. This thread is one of
+    // them; the last core is left to the renderer.
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    InitJobSystem(cores > 1 ? (int)cores - 1 : 1);
+    
+    bool replayStarted = false;
+    int ticksSinceReport = 0;
+    double lastTime = GetTime();
+    while (!atomic_load(&simulation->stop)) {
+        // Let the director weigh the last scene the renderer drew
+        float sceneTime;
+        int sceneEnemies;
+        if (TakeSceneCost(clock, &sceneTime, &sceneEnemies)) {
+            RecordEnemyRenderCost(&gameState->director, sceneTime, sceneEnemies, ticksSinceReport);
+            ticksSinceReport = 0;
+        }
+        
+        // Run the ticks that are due. A replay runs a batch at a time as
+        // fast as it will go instead.
+        double now = GetTime();
+        int ticks = replaying ? REPLAY_TICKS_PER_FRAME : AdvanceSimClock(clock, (float)(now - lastTime));
+        lastTime = now;
+        for (int i = 0; i < ticks; i++) {
+            gameState->input = ConsumeSimInput(clock);
+            if (!ApplyReplay(replay, gameState, &replayStarted)) {
+                if (!FinishReplay(replay, HashGameState(gameState))) simulation->exitCode = 1;
+                atomic_store(&simulation->stop, true);
+                break;
+            }
+            UpdateGame(gameState, SIM_TICK_TIME);
+            ticksSinceReport++;
+        }
+        
+        // Hand the renderer the last tick, stamped with when it was due
+        if (ticks > 0) {
+            PublishSimSnapshot(clock, gameState, replaying ? GetTime() : now - clock->accumulator);
+        }
+        
+        // Sleep until the next tick is due
+        if (!replaying) SleepSeconds(SIM_TICK_TIME - clock->accumulator);
+    }
+    
+    UnloadJobSystem();
+    atomic_store(&simulation->finished, true);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    double launchTime = GetLaunchClock();
+    
+    // --record <file> saves the session's input; --replay <file> plays one
+    // back as fast as it will run and checks it ends in the recorded state
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            replayPath = argv[++i];
+        }
+    }
+    
     // Initialize window and rendering
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, GAME_TITLE);
-    SetTargetFPS(60);
+    double windowTime = GetLaunchClock();
+    SetTargetFPS(TARGET_FPS);
     
     // Disable cursor for FPS camera control
     DisableCursor();
     
-    // Initialize 3D audio
-    InitAudioDevice();
+    // This thread keeps the window and GL context; the simulation hands
+    // GPU work to it
+    InitMainThread();
+    
+    // Textures, models and shaders shared across levels
+    InitAssetRegistry();
+    InitAssetLoader();
+    InitShaderCache();
     
-    // Initialize random seed for procedural generation
-    SetRandomSeed(GetTime());
+    // Baked archive from `make bake`, if present - loose files otherwise
+    OpenAssetPak(PAK_DEFAULT_PATH);
+    
+    // Seed procedural generation once per session. Nothing reseeds it, so
+    // the seed and the input decide the whole game; a replay reuses the
+    // recorded seed.
+    Replay replay = {0};
+    unsigned int seed = (unsigned int)time(NULL);
+    if (replayPath != NULL && LoadReplay(&replay, replayPath)) {
+        seed = replay.header.seed;
+        SetTargetFPS(0);
+    } else if (recordPath != NULL) {
+        StartRecording(&replay, recordPath, seed);
+    }
+    SetRandomSeed(seed);
     
     // Initialize game state
     GameState gameState = {0};
-    gameState.currentState = TITLE_SCREEN;
     gameState.screenWidth = SCREEN_WIDTH;
     gameState.screenHeight = SCREEN_HEIGHT;
     
@@ -41,51 +196,159 @@ int main(void) {
     InitDungeon(&dungeon);
     gameState.dungeon = &dungeon;
     
-    // Load game assets
+    // Set up the title screen - the rest warms up behind it
     LoadGameAssets(&gameState);
     
+    // Fixed-timestep simulation clock and the snapshots passed to the renderer
+    SimClock simClock;
+    InitSimClock(&simClock);
+    
+    // Offscreen scene target, scaled to hold the frame rate
+    DynamicResolution resolution;
+    InitDynamicResolution(&resolution, SCREEN_WIDTH, SCREEN_HEIGHT, TARGET_FPS);
+    
+    // Sorted draw submission for the gameplay scene - grows if a level submits more
+    RenderQueue renderQueue = {0};
+    InitRenderQueue(&renderQueue, RENDER_QUEUE_CAPACITY);
+    
+    // Enemy activation, held to a share of the same frame budget
+    InitSpawnDirector(&gameState.director, TARGET_FPS);
+    gameState.director.capHeld = (replay.mode != REPLAY_OFF);
+    
+    // Run the simulation on its own thread from here on; this thread only
+    // draws snapshots and runs the GPU work the simulation hands over
+    bool replaying = (replay.mode == REPLAY_PLAYING);
+    int exitCode = 0;
+    Simulation simulation = { .gameState = &gameState, .clock = &simClock, .replay = &replay };
+    atomic_init(&simulation.stop, false);
+    atomic_init(&simulation.finished, false);
+    pthread_t simThread;
+    bool simStarted = (pthread_create(&simThread, NULL, RunSimulation, &simulation) == 0);
+    if (!simStarted) {
+        TraceLog(LOG_ERROR, "SIM: Failed to start the simulation thread");
+        atomic_store(&simulation.finished, true);
+        exitCode = 1;
+    }
+    
     // Game loop
-    while (!WindowShouldClose()) {
-        // Update game state
-        float deltaTime = GetFrameTime();
-        UpdateGame(&gameState, deltaTime);
+    bool firstFrame = true;
+    while (!WindowShouldClose() && !atomic_load(&simulation.finished)) {
+        double frameStart = GetTime();
+        
+        // Create whatever the simulation is waiting on, then upload assets
+        // decoded in the background, within the frame budget
+        RunMainThreadWork();
+        UpdateAssetLoader(ASSET_UPLOAD_BUDGET);
+        
+        // Latch this frame's input for the simulation; a replay brings its own
+        if (!replaying) PollSimInput(&simClock);
+        
+        // Draw the newest snapshots, blended a tick behind the simulation
+        SimView view;
+        bool hasView = TakeSimView(&simClock, GetTime(), &view);
+        GameState* shown = hasView ? &view.latest->view : NULL;
+        
+        // Render the 3D scene offscreen at the current resolution scale
+        bool sceneRendered = hasView && shown->currentState == GAMEPLAY;
+        if (sceneRendered) {
+            double sceneStart = GetTime();
+            BeginSceneRender(&resolution);
+                ClearBackground(BLACK);
+                DrawInterpolatedScene(&view, &renderQueue);
+            EndSceneRender(&resolution);
+            ReportSceneCost(&simClock, (float)(GetTime() - sceneStart), view.latest->awakeEnemies);
+        }
         
-        // Draw frame
         BeginDrawing();
             ClearBackground(BLACK);
             
-            // Draw game based on current state
-            switch(gameState.currentState) {
-                case TITLE_SCREEN:
-                    DrawTitleScreen(&gameState);
-                    break;
-                case GAMEPLAY:
-                    DrawGameplay(&gameState);
-                    break;
-                case GAME_OVER:
-                    DrawGameOver(&gameState);
-                    break;
-                case VICTORY:
-                    DrawVictory(&gameState);
-                    break;
-                default:
-                    break;
+            // Draw game based on current state - nothing before the first snapshot
+            if (hasView) {
+                switch(shown->currentState) {
+                    case LOADING:
+                        DrawLoadingScreen(shown);
+                        break;
+                    case TITLE_SCREEN:
+                        DrawTitleScreen(shown);
+                        break;
+                    case GAMEPLAY:
+                        DrawSceneUpscaled(&resolution);
+                        DrawGameplayHUD(shown);
+                        break;
+                    case GAME_OVER:
+                        DrawGameOver(shown);
+                        break;
+                    case VICTORY:
+                        DrawVictory(shown);
+                        break;
+                    default:
+                        break;
+                }
             }
             
             // Draw FPS counter
             DrawFPS(10, 10);
+            if (sceneRendered) {
+                DrawText(TextFormat("RES %i%%", (int)(resolution.scale * 100.0f)), 10, 32, 10, LIME);
+                SpawnDirector* director = &shown->director;
+                DrawText(TextFormat("ENEMIES %i/%i  WAKE %.0f  %.0f us/enemy  WAVES %i (%i held)  %s",
+                                    director->activeEnemies, director->maxActive, director->wakeRadius,
+                                    (director->simCostPerEnemy + director->renderCostPerEnemy) * 1e6f,
+                                    director->wavesSpawned, director->wavesDeferred,
+                                    GetDirectorLimitName(director->limit)), 10, 44, 10, LIME);
+                const int* tierCounts = view.latest->enemyTiers;
+                DrawText(TextFormat("AI LOD  FULL %i  REDUCED %i  DORMANT %i", tierCounts[ENEMY_LOD_FULL],
+                                    tierCounts[ENEMY_LOD_REDUCED], tierCounts[ENEMY_LOD_FROZEN]), 10, 56, 10, LIME);
+            }
             
+            float busyTime = (float)(GetTime() - frameStart);
         EndDrawing();
+        
+        if (firstFrame) {
+            double now = GetLaunchClock();
+            TraceLog(LOG_INFO, "STARTUP: First frame %.1f ms after launch (window %.1f ms, setup %.1f ms)",
+                     (now - launchTime) * 1000.0, (windowTime - launchTime) * 1000.0, (now - windowTime) * 1000.0);
+            firstFrame = false;
+        }
+        
+        // Adjust the next frame's resolution from this frame's cost
+        if (sceneRendered) {
+            UpdateDynamicResolution(&resolution, GetFrameTime(), busyTime);
+        }
+    }
+    
+    // Stop the simulation, running any GPU work it waits on meanwhile. The
+    // game state is this thread's again once it is joined.
+    atomic_store(&simulation.stop, true);
+    if (simStarted) {
+        while (!atomic_load(&simulation.finished)) {
+            if (RunMainThreadWork() == 0) SleepSeconds(0.001);
+        }
+        pthread_join(simThread, NULL);
+        if (simulation.exitCode != 0) exitCode = simulation.exitCode;
+    }
+    
+    // Save the recording, or report a replay cut short
+    if (replay.mode == REPLAY_RECORDING || replay.mode == REPLAY_PLAYING) {
+        if (!FinishReplay(&replay, HashGameState(&gameState))) exitCode = 1;
     }
+    UnloadReplay(&replay);
     
     // Clean up resources
+    UnloadDynamicResolution(&resolution);
+    UnloadRenderQueue(&renderQueue);
+    UnloadSimClock(&simClock);
     UnloadGameAssets(&gameState);
     UnloadDungeon(&dungeon);
     UnloadPlayer(&player);
+    UnloadAssetLoader();
+    UnloadAssetRegistry();
+    UnloadShaderCache();
+    CloseAssetPak();
     
     // Close window and audio
-    CloseAudioDevice();
+    CloseGameAudio();
     CloseWindow();
     
-    return 0;
+    return exitCode;
 }
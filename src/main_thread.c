@@ -0,0 +1,73 @@
+#include "../include/main_thread.h"
+#include <pthread.h>
+
+// A request waiting to run, on the stack of the thread that made it
+typedef struct {
+    MainThreadFunction function;
+    void* context;
+    bool done;
+} MainThreadRequest;
+
+// Requests are queued and completed under one mutex; callers wait on the
+// condition until theirs is marked done, or for room in the queue
+static pthread_t mainThread;
+static bool mainThreadKnown = false;
+static pthread_mutex_t requestMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t requestsChanged = PTHREAD_COND_INITIALIZER;
+static MainThreadRequest* waiting[MAIN_THREAD_MAX_WAITING];
+static int waitingCount = 0;
+
+// Remember the calling thread as the main thread. Call it before starting
+// any thread that hands work over.
+void InitMainThread(void) {
+    mainThread = pthread_self();
+    mainThreadKnown = true;
+}
+
+bool IsMainThread(void) {
+    return !mainThreadKnown || pthread_equal(pthread_self(), mainThread);
+}
+
+// Run a function on the main thread and wait for it to finish
+void RunOnMainThread(MainThreadFunction function, void* context) {
+    if (IsMainThread()) {
+        function(context);
+        return;
+    }
+
+    MainThreadRequest request = { function, context, false };
+    pthread_mutex_lock(&requestMutex);
+    while (waitingCount == MAIN_THREAD_MAX_WAITING) {
+        pthread_cond_wait(&requestsChanged, &requestMutex);
+    }
+    waiting[waitingCount++] = &request;
+    while (!request.done) {
+        pthread_cond_wait(&requestsChanged, &requestMutex);
+    }
+    pthread_mutex_unlock(&requestMutex);
+}
+
+// Run the requests queued so far and wake their callers. Called by the
+// main thread once a frame, and in a loop while it waits for a thread
+// that may still hand work over. Returns how many ran.
+int RunMainThreadWork(void) {
+    MainThreadRequest* batch[MAIN_THREAD_MAX_WAITING];
+
+    pthread_mutex_lock(&requestMutex);
+    int count = waitingCount;
+    for (int i = 0; i < count; i++) batch[i] = waiting[i];
+    waitingCount = 0;
+    pthread_mutex_unlock(&requestMutex);
+
+    if (count == 0) return 0;
+
+    for (int i = 0; i < count; i++) {
+        batch[i]->function(batch[i]->context);
+    }
+
+    pthread_mutex_lock(&requestMutex);
+    for (int i = 0; i < count; i++) batch[i]->done = true;
+    pthread_cond_broadcast(&requestsChanged);
+    pthread_mutex_unlock(&requestMutex);
+    return count;
+}
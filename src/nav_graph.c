@@ -0,0 +1,696 @@
+#include "../include/nav_graph.h"
+#include "../include/jobs.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#define NAV_NO_ROUTE INT_MAX
+
+// Steps to the eight neighbours, straight ones first, and the step back
+static const int stepX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int stepZ[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+static const unsigned char oppositeStep[8] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+
+// Pair of neighbouring tiles in different clusters, before the entrances
+// are numbered
+typedef struct {
+    int from;
+    int to;
+} NavCrossing;
+
+// Check if an enemy can walk through a tile
+static bool IsOpenTile(Dungeon* dungeon, int x, int z) {
+    if (x < 0 || x >= dungeon->width || z < 0 || z >= dungeon->height) return false;
+    return dungeon->tiles[x][z] != TILE_WALL && dungeon->tiles[x][z] != TILE_NONE;
+}
+
+// Check if a tile belongs to a cluster
+static bool IsInCluster(const NavGraph* nav, int cluster, int x, int z) {
+    if (x < 0 || x >= nav->width || z < 0 || z >= nav->height) return false;
+    return nav->clusterOfTile[x * nav->height + z] == cluster;
+}
+
+// Index of a tile within its cluster's bounding box
+static int CellOfTile(const NavGraph* nav, const NavCluster* cluster, int tile) {
+    return (tile / nav->height - cluster->minX) * cluster->height + (tile % nav->height - cluster->minZ);
+}
+
+// Tile one step from another, or -1 for no step
+static int StepFromTile(const NavGraph* nav, int tile, unsigned char step) {
+    if (step == NAV_NO_STEP) return -1;
+    return (tile / nav->height + stepX[step]) * nav->height + (tile % nav->height + stepZ[step]);
+}
+
+// Lower bound on the cost between two tiles: the octile distance
+static int EstimateCost(const NavGraph* nav, int tile, int goalX, int goalZ) {
+    int dx = abs(tile / nav->height - goalX);
+    int dz = abs(tile % nav->height - goalZ);
+    int diagonal = (dx < dz) ? dx : dz;
+    return NAV_STRAIGHT_COST * (dx + dz) + (NAV_DIAGONAL_COST - 2 * NAV_STRAIGHT_COST) * diagonal;
+}
+
+// Lower bound on an entrance's cost to the goal: the octile distance, or
+// the triangle inequality through any landmark when that is tighter.
+// Returns NAV_NO_ROUTE when a landmark reaches only one of them, as they
+// then lie in separate parts of the level.
+static int EstimateRouteCost(const NavGraph* nav, int node, int goalX, int goalZ, const int* goalLandmarkCost) {
+    int estimate = EstimateCost(nav, nav->nodes[node].tile, goalX, goalZ);
+    const int* landmarkCost = &nav->landmarkCost[node * NAV_LANDMARKS];
+
+    for (int i = 0; i < NAV_LANDMARKS; i++) {
+        if (landmarkCost[i] == NAV_NO_ROUTE || goalLandmarkCost[i] == NAV_NO_ROUTE) {
+            if (landmarkCost[i] != goalLandmarkCost[i]) return NAV_NO_ROUTE;
+            continue;
+        }
+        int bound = abs(goalLandmarkCost[i] - landmarkCost[i]);
+        if (bound > estimate) estimate = bound;
+    }
+    return estimate;
+}
+
+// Binary min-heap on priority
+static void PushHeap(NavHeapEntry* heap, int* count, int capacity, int priority, int node) {
+    if (*count >= capacity) return;
+
+    int i = (*count)++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap[parent].priority <= priority) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = (NavHeapEntry){ priority, node };
+}
+
+static NavHeapEntry PopHeap(NavHeapEntry* heap, int* count) {
+    NavHeapEntry top = heap[0];
+    NavHeapEntry last = heap[--(*count)];
+
+    int i = 0;
+    while (2 * i + 1 < *count) {
+        int child = 2 * i + 1;
+        if (child + 1 < *count && heap[child + 1].priority < heap[child].priority) child++;
+        if (heap[child].priority >= last.priority) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+// Dijkstra from a source tile over its cluster. Fills the cost of every
+// cell of the cluster's bounding box and the direction of each cell's
+// first step toward the source. Stops once stopCell is settled, if given.
+static void SearchCluster(const NavGraph* nav, int clusterIndex, int sourceTile, unsigned short* distance,
+                          unsigned char* step, NavHeapEntry* heap, int stopCell) {
+    const NavCluster* cluster = &nav->clusters[clusterIndex];
+    int area = cluster->width * cluster->height;
+    for (int i = 0; i < area; i++) {
+        distance[i] = NAV_UNREACHED;
+        step[i] = NAV_NO_STEP;
+    }
+
+    int sourceCell = CellOfTile(nav, cluster, sourceTile);
+    int heapCount = 0;
+    distance[sourceCell] = 0;
+    PushHeap(heap, &heapCount, area * 8, 0, sourceCell);
+
+    while (heapCount > 0) {
+        NavHeapEntry entry = PopHeap(heap, &heapCount);
+        int cell = entry.node;
+        if (entry.priority > distance[cell]) continue;
+        if (cell == stopCell) return;
+
+        int x = cluster->minX + cell / cluster->height;
+        int z = cluster->minZ + cell % cluster->height;
+        for (int i = 0; i < 8; i++) {
+            int neighbourX = x + stepX[i];
+            int neighbourZ = z + stepZ[i];
+            if (!IsInCluster(nav, clusterIndex, neighbourX, neighbourZ)) continue;
+
+            // Diagonal steps only past two tiles of the cluster, so paths never
+            // cut a wall corner or leave the cluster
+            if (i >= 4 && (!IsInCluster(nav, clusterIndex, neighbourX, z) ||
+                           !IsInCluster(nav, clusterIndex, x, neighbourZ))) {
+                continue;
+            }
+
+            int cost = distance[cell] + ((i < 4) ? NAV_STRAIGHT_COST : NAV_DIAGONAL_COST);
+            int neighbourCell = (neighbourX - cluster->minX) * cluster->height + (neighbourZ - cluster->minZ);
+            if (cost >= distance[neighbourCell]) continue;
+
+            distance[neighbourCell] = (unsigned short)cost;
+            step[neighbourCell] = oppositeStep[i];
+            PushHeap(heap, &heapCount, area * 8, cost, neighbourCell);
+        }
+    }
+}
+
+// Append a cluster with an empty bounding box, growing the array as needed.
+// Returns its index, or -1 if memory ran out.
+static int AddCluster(NavGraph* nav, int* capacity) {
+    if (nav->clusterCount >= *capacity) {
+        int newCapacity = *capacity * 2;
+        NavCluster* clusters = (NavCluster*)realloc(nav->clusters, newCapacity * sizeof(NavCluster));
+        if (clusters == NULL) return -1;
+        nav->clusters = clusters;
+        *capacity = newCapacity;
+    }
+
+    nav->clusters[nav->clusterCount] = (NavCluster){ INT_MAX, INT_MAX, 0, 0, 0, 0 };
+    return nav->clusterCount++;
+}
+
+// Grow a cluster's bounding box, kept as min and max corners until all its
+// tiles are in
+static void ExtendCluster(NavCluster* cluster, int x, int z) {
+    if (x < cluster->minX) cluster->minX = x;
+    if (z < cluster->minZ) cluster->minZ = z;
+    if (x > cluster->width) cluster->width = x;
+    if (z > cluster->height) cluster->height = z;
+}
+
+// Group the open tiles into clusters: the rooms first, then the remaining
+// corridor tiles, flood filled without crossing a NAV_CLUSTER_SIZE block
+// border so no piece outgrows the per-entrance caches
+static bool BuildClusters(NavGraph* nav, Dungeon* dungeon) {
+    int capacity = dungeon->roomCount + 64;
+    nav->clusters = (NavCluster*)malloc(capacity * sizeof(NavCluster));
+    if (nav->clusters == NULL) return false;
+
+    for (int i = 0; i < dungeon->roomCount; i++) {
+        Room* room = &dungeon->rooms[i];
+        if (room->width * room->height > NAV_MAX_CLUSTER_AREA) continue;
+
+        int cluster = AddCluster(nav, &capacity);
+        if (cluster < 0) return false;
+        for (int x = room->x; x < room->x + room->width; x++) {
+            for (int z = room->y; z < room->y + room->height; z++) {
+                if (!IsOpenTile(dungeon, x, z)) continue;
+                nav->clusterOfTile[x * nav->height + z] = cluster;
+                ExtendCluster(&nav->clusters[cluster], x, z);
+            }
+        }
+    }
+
+    int queue[NAV_MAX_CLUSTER_AREA];
+    for (int x = 0; x < nav->width; x++) {
+        for (int z = 0; z < nav->height; z++) {
+            if (!IsOpenTile(dungeon, x, z) || nav->clusterOfTile[x * nav->height + z] >= 0) continue;
+
+            int cluster = AddCluster(nav, &capacity);
+            if (cluster < 0) return false;
+            int blockX = x / NAV_CLUSTER_SIZE;
+            int blockZ = z / NAV_CLUSTER_SIZE;
+            int queueCount = 0;
+            nav->clusterOfTile[x * nav->height + z] = cluster;
+            queue[queueCount++] = x * nav->height + z;
+
+            for (int head = 0; head < queueCount; head++) {
+                int tileX = queue[head] / nav->height;
+                int tileZ = queue[head] % nav->height;
+                ExtendCluster(&nav->clusters[cluster], tileX, tileZ);
+
+                for (int i = 0; i < 4; i++) {
+                    int neighbourX = tileX + stepX[i];
+                    int neighbourZ = tileZ + stepZ[i];
+                    if (neighbourX / NAV_CLUSTER_SIZE != blockX || neighbourZ / NAV_CLUSTER_SIZE != blockZ ||
+                        !IsOpenTile(dungeon, neighbourX, neighbourZ) ||
+                        nav->clusterOfTile[neighbourX * nav->height + neighbourZ] >= 0) {
+                        continue;
+                    }
+                    nav->clusterOfTile[neighbourX * nav->height + neighbourZ] = cluster;
+                    queue[queueCount++] = neighbourX * nav->height + neighbourZ;
+                }
+            }
+        }
+    }
+
+    // Turn the max corners into sizes
+    for (int i = 0; i < nav->clusterCount; i++) {
+        NavCluster* cluster = &nav->clusters[i];
+        cluster->width = cluster->width - cluster->minX + 1;
+        cluster->height = cluster->height - cluster->minZ + 1;
+    }
+    return true;
+}
+
+// Record the entrances of one run of crossings between the same two
+// clusters: the middle of a short run, both ends of a long one
+static bool AddCrossingRun(NavCrossing** crossings, int* count, int* capacity, int fromStart, int toStart,
+                           int stride, int length) {
+    int offsets[2] = { (length - 1) / 2, 0 };
+    int offsetCount = 1;
+    if (length >= NAV_LONG_ENTRANCE) {
+        offsets[0] = 0;
+        offsets[1] = length - 1;
+        offsetCount = 2;
+    }
+
+    for (int i = 0; i < offsetCount; i++) {
+        if (*count >= *capacity) {
+            int newCapacity = *capacity * 2;
+            NavCrossing* grown = (NavCrossing*)realloc(*crossings, newCapacity * sizeof(NavCrossing));
+            if (grown == NULL) return false;
+            *crossings = grown;
+            *capacity = newCapacity;
+        }
+        (*crossings)[(*count)++] = (NavCrossing){ fromStart + offsets[i] * stride, toStart + offsets[i] * stride };
+    }
+    return true;
+}
+
+// Find the crossings along every line of tile borders facing one way.
+// With acrossX the borders lie between columns x and x + 1, otherwise
+// between rows z and z + 1.
+static bool FindCrossings(const NavGraph* nav, bool acrossX, NavCrossing** crossings, int* count, int* capacity) {
+    int lines = acrossX ? nav->width - 1 : nav->height - 1;
+    int length = acrossX ? nav->height : nav->width;
+    int stride = acrossX ? 1 : nav->height;             // Tile index step along a line
+    int across = acrossX ? nav->height : 1;             // Tile index step across it
+
+    for (int line = 0; line < lines; line++) {
+        int lineStart = acrossX ? line * nav->height : line;
+        int runStart = -1;
+        int runFrom = -1;
+        int runTo = -1;
+
+        for (int i = 0; i <= length; i++) {
+            int from = -1;
+            int to = -1;
+            if (i < length) {
+                from = nav->clusterOfTile[lineStart + i * stride];
+                to = nav->clusterOfTile[lineStart + i * stride + across];
+            }
+            bool crossing = from >= 0 && to >= 0 && from != to;
+
+            if (runStart >= 0 && (!crossing || from != runFrom || to != runTo)) {
+                int tile = lineStart + runStart * stride;
+                if (!AddCrossingRun(crossings, count, capacity, tile, tile + across, stride, i - runStart)) {
+                    return false;
+                }
+                runStart = -1;
+            }
+            if (crossing && runStart < 0) {
+                runStart = i;
+                runFrom = from;
+                runTo = to;
+            }
+        }
+    }
+    return true;
+}
+
+// Number the entrance tiles cluster by cluster, so each cluster's
+// entrances are contiguous
+static bool BuildNodes(NavGraph* nav, const NavCrossing* crossings, int crossingCount, int* nodeOfTile) {
+    for (int i = 0; i < crossingCount * 2; i++) {
+        int tile = (i % 2 == 0) ? crossings[i / 2].from : crossings[i / 2].to;
+        if (nodeOfTile[tile] != -1) continue;
+        nodeOfTile[tile] = -2;
+        nav->clusters[nav->clusterOfTile[tile]].nodeCount++;
+        nav->nodeCount++;
+    }
+
+    nav->nodes = (NavNode*)malloc((nav->nodeCount > 0 ? nav->nodeCount : 1) * sizeof(NavNode));
+    if (nav->nodes == NULL) return false;
+
+    int first = 0;
+    for (int i = 0; i < nav->clusterCount; i++) {
+        nav->clusters[i].firstNode = first;
+        first += nav->clusters[i].nodeCount;
+        nav->clusters[i].nodeCount = 0;
+    }
+
+    for (int i = 0; i < crossingCount * 2; i++) {
+        int tile = (i % 2 == 0) ? crossings[i / 2].from : crossings[i / 2].to;
+        if (nodeOfTile[tile] != -2) continue;
+
+        NavCluster* cluster = &nav->clusters[nav->clusterOfTile[tile]];
+        int node = cluster->firstNode + cluster->nodeCount++;
+        nodeOfTile[tile] = node;
+        nav->nodes[node] = (NavNode){ tile, nav->clusterOfTile[tile], 0, 0, 0 };
+    }
+    return true;
+}
+
+// Shared state for the cache jobs
+typedef struct {
+    NavGraph* nav;
+    atomic_bool failed;
+} NavCacheJob;
+
+// Cache job - search a range of entrances' clusters, on a heap of the
+// job's own. Each entrance fills its own slice of the cache.
+static void SearchEntrances(void* context, int begin, int end) {
+    NavCacheJob* job = (NavCacheJob*)context;
+    NavGraph* nav = job->nav;
+    NavHeapEntry* heap = (NavHeapEntry*)malloc(NAV_MAX_CLUSTER_AREA * 8 * sizeof(NavHeapEntry));
+    if (heap == NULL) {
+        atomic_store(&job->failed, true);
+        return;
+    }
+
+    for (int i = begin; i < end; i++) {
+        NavNode* node = &nav->nodes[i];
+        SearchCluster(nav, node->cluster, node->tile, nav->cacheDistance + node->cacheOffset,
+                      nav->cacheStep + node->cacheOffset, heap, -1);
+    }
+    free(heap);
+}
+
+// Cache each entrance's costs and first steps over its cluster
+static bool BuildCaches(NavGraph* nav) {
+    nav->cacheSize = 0;
+    for (int i = 0; i < nav->nodeCount; i++) {
+        NavCluster* cluster = &nav->clusters[nav->nodes[i].cluster];
+        nav->nodes[i].cacheOffset = nav->cacheSize;
+        nav->cacheSize += cluster->width * cluster->height;
+    }
+
+    nav->cacheDistance = (unsigned short*)malloc((nav->cacheSize > 0 ? nav->cacheSize : 1) * sizeof(unsigned short));
+    nav->cacheStep = (unsigned char*)malloc(nav->cacheSize > 0 ? nav->cacheSize : 1);
+    if (nav->cacheDistance == NULL || nav->cacheStep == NULL) return false;
+
+    NavCacheJob job = { .nav = nav };
+    atomic_init(&job.failed, false);
+    ParallelFor(nav->nodeCount, NAV_CACHE_GRAIN, SearchEntrances, &job);
+    return !atomic_load(&job.failed);
+}
+
+// Link each entrance to its partners across borders, at one step, and to
+// the other entrances of its cluster, at their cached costs
+static bool BuildEdges(NavGraph* nav, const NavCrossing* crossings, int crossingCount, const int* nodeOfTile) {
+    for (int i = 0; i < crossingCount; i++) {
+        nav->nodes[nodeOfTile[crossings[i].from]].edgeCount++;
+        nav->nodes[nodeOfTile[crossings[i].to]].edgeCount++;
+    }
+    for (int i = 0; i < nav->nodeCount; i++) {
+        nav->nodes[i].edgeCount += nav->clusters[nav->nodes[i].cluster].nodeCount - 1;
+    }
+
+    for (int i = 0; i < nav->nodeCount; i++) {
+        nav->nodes[i].firstEdge = nav->edgeCount;
+        nav->edgeCount += nav->nodes[i].edgeCount;
+        nav->nodes[i].edgeCount = 0;
+    }
+    nav->edges = (NavEdge*)malloc((nav->edgeCount > 0 ? nav->edgeCount : 1) * sizeof(NavEdge));
+    if (nav->edges == NULL) return false;
+
+    for (int i = 0; i < crossingCount; i++) {
+        NavNode* from = &nav->nodes[nodeOfTile[crossings[i].from]];
+        NavNode* to = &nav->nodes[nodeOfTile[crossings[i].to]];
+        nav->edges[from->firstEdge + from->edgeCount++] = (NavEdge){ nodeOfTile[crossings[i].to], NAV_STRAIGHT_COST };
+        nav->edges[to->firstEdge + to->edgeCount++] = (NavEdge){ nodeOfTile[crossings[i].from], NAV_STRAIGHT_COST };
+    }
+
+    for (int i = 0; i < nav->nodeCount; i++) {
+        NavNode* node = &nav->nodes[i];
+        const NavCluster* cluster = &nav->clusters[node->cluster];
+        int cell = CellOfTile(nav, cluster, node->tile);
+
+        for (int j = cluster->firstNode; j < cluster->firstNode + cluster->nodeCount; j++) {
+            int cost = nav->cacheDistance[nav->nodes[j].cacheOffset + cell];
+            if (j == i || cost == NAV_UNREACHED) continue;
+            nav->edges[node->firstEdge + node->edgeCount++] = (NavEdge){ j, cost };
+        }
+    }
+    return true;
+}
+
+// Dijkstra over the entrances from one of them, filling a landmark's
+// column of costs
+static void SearchLandmark(NavGraph* nav, int landmark, int source) {
+    for (int i = 0; i < nav->nodeCount; i++) {
+        nav->landmarkCost[i * NAV_LANDMARKS + landmark] = NAV_NO_ROUTE;
+    }
+
+    int heapCount = 0;
+    nav->landmarkCost[source * NAV_LANDMARKS + landmark] = 0;
+    PushHeap(nav->heap, &heapCount, nav->heapCapacity, 0, source);
+
+    while (heapCount > 0) {
+        NavHeapEntry entry = PopHeap(nav->heap, &heapCount);
+        if (entry.priority > nav->landmarkCost[entry.node * NAV_LANDMARKS + landmark]) continue;
+
+        const NavNode* node = &nav->nodes[entry.node];
+        for (int i = node->firstEdge; i < node->firstEdge + node->edgeCount; i++) {
+            int cost = entry.priority + nav->edges[i].cost;
+            int* neighbourCost = &nav->landmarkCost[nav->edges[i].to * NAV_LANDMARKS + landmark];
+            if (cost >= *neighbourCost) continue;
+
+            *neighbourCost = cost;
+            PushHeap(nav->heap, &heapCount, nav->heapCapacity, cost, nav->edges[i].to);
+        }
+    }
+}
+
+// Spread the landmarks out: each is the entrance farthest from the ones
+// already placed
+static void PlaceLandmarks(NavGraph* nav) {
+    int source = 0;
+    for (int landmark = 0; landmark < NAV_LANDMARKS; landmark++) {
+        SearchLandmark(nav, landmark, source);
+
+        int farthestCost = -1;
+        for (int i = 0; i < nav->nodeCount; i++) {
+            int nearest = NAV_NO_ROUTE;
+            for (int placed = 0; placed <= landmark; placed++) {
+                int cost = nav->landmarkCost[i * NAV_LANDMARKS + placed];
+                if (cost < nearest) nearest = cost;
+            }
+            if (nearest != NAV_NO_ROUTE && nearest > farthestCost) {
+                farthestCost = nearest;
+                source = i;
+            }
+        }
+    }
+}
+
+// Build the level's navigation graph once its layout is final
+void BuildNavGraph(Dungeon* dungeon) {
+    UnloadNavGraph(dungeon);
+
+    NavGraph* nav = (NavGraph*)calloc(1, sizeof(NavGraph));
+    if (nav == NULL) {
+        TraceLog(LOG_WARNING, "NAV: Failed to allocate the navigation graph");
+        return;
+    }
+    dungeon->navGraph = nav;
+    nav->width = dungeon->width;
+    nav->height = dungeon->height;
+
+    int tileCount = nav->width * nav->height;
+    int crossingCount = 0;
+    int crossingCapacity = 256;
+    NavCrossing* crossings = (NavCrossing*)malloc(crossingCapacity * sizeof(NavCrossing));
+    int* nodeOfTile = (int*)malloc(tileCount * sizeof(int));
+    nav->clusterOfTile = (int*)malloc(tileCount * sizeof(int));
+
+    bool built = crossings != NULL && nodeOfTile != NULL && nav->clusterOfTile != NULL;
+    if (built) {
+        for (int i = 0; i < tileCount; i++) {
+            nav->clusterOfTile[i] = -1;
+            nodeOfTile[i] = -1;
+        }
+
+        built = BuildClusters(nav, dungeon) &&
+                FindCrossings(nav, true, &crossings, &crossingCount, &crossingCapacity) &&
+                FindCrossings(nav, false, &crossings, &crossingCount, &crossingCapacity) &&
+                BuildNodes(nav, crossings, crossingCount, nodeOfTile) &&
+                BuildCaches(nav) &&
+                BuildEdges(nav, crossings, crossingCount, nodeOfTile);
+    }
+    free(crossings);
+    free(nodeOfTile);
+
+    // Scratch for the route searches
+    if (built) {
+        int nodeSlots = (nav->nodeCount > 0) ? nav->nodeCount : 1;
+        nav->cost = (int*)malloc(nodeSlots * sizeof(int));
+        nav->estimate = (int*)malloc(nodeSlots * sizeof(int));
+        nav->landmarkCost = (int*)malloc(nodeSlots * NAV_LANDMARKS * sizeof(int));
+        nav->parent = (int*)malloc(nodeSlots * sizeof(int));
+        nav->visited = (unsigned*)calloc(nodeSlots, sizeof(unsigned));
+        nav->route = (int*)malloc(nodeSlots * sizeof(int));
+        nav->heapCapacity = nav->edgeCount + nav->nodeCount + 1;
+        nav->heap = (NavHeapEntry*)malloc(nav->heapCapacity * sizeof(NavHeapEntry));
+        built = nav->cost != NULL && nav->estimate != NULL && nav->landmarkCost != NULL && nav->parent != NULL &&
+                nav->visited != NULL && nav->route != NULL && nav->heap != NULL;
+    }
+    if (built && nav->nodeCount > 0) {
+        PlaceLandmarks(nav);
+    }
+
+    if (!built) {
+        TraceLog(LOG_WARNING, "NAV: Failed to build the navigation graph");
+        UnloadNavGraph(dungeon);
+        return;
+    }
+    TraceLog(LOG_INFO, "NAV: %d clusters, %d entrances, %d edges, %d cached cells",
+             nav->clusterCount, nav->nodeCount, nav->edgeCount, nav->cacheSize);
+}
+
+// Free the navigation graph
+void UnloadNavGraph(Dungeon* dungeon) {
+    NavGraph* nav = dungeon->navGraph;
+    if (nav == NULL) return;
+
+    free(nav->clusterOfTile);
+    free(nav->clusters);
+    free(nav->nodes);
+    free(nav->edges);
+    free(nav->cacheDistance);
+    free(nav->cacheStep);
+    free(nav->landmarkCost);
+    free(nav->cost);
+    free(nav->estimate);
+    free(nav->parent);
+    free(nav->visited);
+    free(nav->heap);
+    free(nav->route);
+    free(nav);
+    dungeon->navGraph = NULL;
+}
+
+// A* over the entrances between a start and goal tile in different
+// clusters. The start cluster's entrances are seeded with their cached
+// costs from the start, and the goal cluster's close the route with their
+// cached costs to the goal. Returns the first entrance on the route that
+// is not the start tile itself, or -1 when there is no route.
+static int SearchRoute(NavGraph* nav, int startTile, int goalTile) {
+    if (++nav->searchId == 0) {
+        memset(nav->visited, 0, nav->nodeCount * sizeof(unsigned));
+        nav->searchId = 1;
+    }
+    unsigned searchId = nav->searchId;
+
+    const NavCluster* startCluster = &nav->clusters[nav->clusterOfTile[startTile]];
+    const NavCluster* goalCluster = &nav->clusters[nav->clusterOfTile[goalTile]];
+    int startCell = CellOfTile(nav, startCluster, startTile);
+    int goalCell = CellOfTile(nav, goalCluster, goalTile);
+    int goalX = goalTile / nav->height;
+    int goalZ = goalTile % nav->height;
+
+    // Landmark costs to the goal itself, through its cluster's entrances
+    int goalLandmarkCost[NAV_LANDMARKS];
+    for (int i = 0; i < NAV_LANDMARKS; i++) {
+        goalLandmarkCost[i] = NAV_NO_ROUTE;
+        for (int node = goalCluster->firstNode; node < goalCluster->firstNode + goalCluster->nodeCount; node++) {
+            int toGoal = nav->cacheDistance[nav->nodes[node].cacheOffset + goalCell];
+            int cost = nav->landmarkCost[node * NAV_LANDMARKS + i];
+            if (toGoal == NAV_UNREACHED || cost == NAV_NO_ROUTE) continue;
+            if (cost + toGoal < goalLandmarkCost[i]) goalLandmarkCost[i] = cost + toGoal;
+        }
+    }
+
+    int heapCount = 0;
+    for (int i = startCluster->firstNode; i < startCluster->firstNode + startCluster->nodeCount; i++) {
+        int cost = nav->cacheDistance[nav->nodes[i].cacheOffset + startCell];
+        int estimate = EstimateRouteCost(nav, i, goalX, goalZ, goalLandmarkCost);
+        if (cost == NAV_UNREACHED || estimate == NAV_NO_ROUTE) continue;
+
+        nav->visited[i] = searchId;
+        nav->cost[i] = cost;
+        nav->estimate[i] = estimate;
+        nav->parent[i] = -1;
+        PushHeap(nav->heap, &heapCount, nav->heapCapacity, cost + estimate, i);
+    }
+
+    int bestCost = NAV_NO_ROUTE;
+    int bestNode = -1;
+    while (heapCount > 0) {
+        NavHeapEntry entry = PopHeap(nav->heap, &heapCount);
+        if (entry.priority >= bestCost) break;
+
+        int current = entry.node;
+        if (entry.priority > nav->cost[current] + nav->estimate[current]) continue;
+
+        const NavNode* node = &nav->nodes[current];
+        if (node->cluster == nav->clusterOfTile[goalTile]) {
+            int toGoal = nav->cacheDistance[node->cacheOffset + goalCell];
+            if (toGoal != NAV_UNREACHED && nav->cost[current] + toGoal < bestCost) {
+                bestCost = nav->cost[current] + toGoal;
+                bestNode = current;
+            }
+        }
+
+        for (int i = node->firstEdge; i < node->firstEdge + node->edgeCount; i++) {
+            const NavEdge* edge = &nav->edges[i];
+            int cost = nav->cost[current] + edge->cost;
+            if (nav->visited[edge->to] == searchId) {
+                if (cost >= nav->cost[edge->to]) continue;
+            } else {
+                nav->visited[edge->to] = searchId;
+                nav->estimate[edge->to] = EstimateRouteCost(nav, edge->to, goalX, goalZ, goalLandmarkCost);
+            }
+
+            nav->cost[edge->to] = cost;
+            nav->parent[edge->to] = current;
+            if (nav->estimate[edge->to] == NAV_NO_ROUTE) continue;
+            PushHeap(nav->heap, &heapCount, nav->heapCapacity, cost + nav->estimate[edge->to], edge->to);
+        }
+    }
+    if (bestNode < 0) return -1;
+
+    // Walk back to the seed, then forward to the first entrance off the start
+    int length = 0;
+    for (int current = bestNode; current >= 0 && length < nav->nodeCount; current = nav->parent[current]) {
+        nav->route[length++] = current;
+    }
+    for (int i = length - 1; i >= 0; i--) {
+        if (nav->nodes[nav->route[i]].tile != startTile) return nav->route[i];
+    }
+    return -1;
+}
+
+// Tile index of a position, or -1 outside the level
+static int TileAtPosition(const NavGraph* nav, Vector3 position) {
+    int x = (int)floorf(position.x);
+    int z = (int)floorf(position.z);
+    if (x < 0 || x >= nav->width || z < 0 || z >= nav->height) return -1;
+    return x * nav->height + z;
+}
+
+// Centre of the next tile on the shortest route between two positions,
+// searching the abstract graph and refining only the first segment
+bool FindNavStep(Dungeon* dungeon, Vector3 from, Vector3 to, Vector3* step) {
+    NavGraph* nav = dungeon->navGraph;
+    if (nav == NULL) return false;
+
+    int startTile = TileAtPosition(nav, from);
+    int goalTile = TileAtPosition(nav, to);
+    if (startTile < 0 || goalTile < 0 || startTile == goalTile) return false;
+
+    int startCluster = nav->clusterOfTile[startTile];
+    int goalCluster = nav->clusterOfTile[goalTile];
+    if (startCluster < 0 || goalCluster < 0) return false;
+
+    const NavCluster* cluster = &nav->clusters[startCluster];
+    int startCell = CellOfTile(nav, cluster, startTile);
+    int next = -1;
+
+    if (startCluster == goalCluster) {
+        // Same cluster: search it directly, from the goal until the start
+        // is settled
+        SearchCluster(nav, startCluster, goalTile, nav->localDistance, nav->localStep, nav->localHeap, startCell);
+        next = StepFromTile(nav, startTile, nav->localStep[startCell]);
+    } else {
+        int target = SearchRoute(nav, startTile, goalTile);
+        if (target < 0) return false;
+
+        // Step toward the entrance through the cache, or across the border
+        // when the start is the entrance on this side
+        const NavNode* node = &nav->nodes[target];
+        if (node->cluster == startCluster) {
+            next = StepFromTile(nav, startTile, nav->cacheStep[node->cacheOffset + startCell]);
+        } else {
+            next = node->tile;
+        }
+    }
+    if (next < 0) return false;
+
+    *step = (Vector3){ (float)(next / nav->height) + 0.5f, from.y, (float)(next % nav->height) + 0.5f };
+    return true;
+}
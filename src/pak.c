@@ -0,0 +1,287 @@
+#include "../include/pak.h"
+#include "../include/assets.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// The mapped archive
+static const unsigned char* pakData = NULL;
+static size_t pakSize = 0;
+static const PakEntry* pakEntries = NULL;
+static uint32_t pakEntryCount = 0;
+
+// Check that an entry's data lies inside the mapping
+static bool IsEntryInBounds(const PakEntry* entry) {
+    return (size_t)entry->offset + entry->size <= pakSize;
+}
+
+// Map the archive and validate its header and table of contents.
+// Returns false (and the game falls back to loose files) if it is missing.
+bool OpenAssetPak(const char* path) {
+    CloseAssetPak();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        TraceLog(LOG_INFO, "PAK: No archive at %s, loading loose files", path);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(PakHeader)) {
+        close(fd);
+        TraceLog(LOG_WARNING, "PAK: [%s] Archive is empty or unreadable", path);
+        return false;
+    }
+
+    void* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        TraceLog(LOG_WARNING, "PAK: [%s] Failed to map archive", path);
+        return false;
+    }
+
+    const PakHeader* header = (const PakHeader*)mapping;
+    size_t tocEnd = (size_t)header->tocOffset + (size_t)header->entryCount * sizeof(PakEntry);
+    if (header->magic != PAK_MAGIC || header->version != PAK_VERSION || tocEnd > (size_t)info.st_size) {
+        munmap(mapping, info.st_size);
+        TraceLog(LOG_WARNING, "PAK: [%s] Archive is invalid or from another version, rebake it", path);
+        return false;
+    }
+
+    pakData = (const unsigned char*)mapping;
+    pakSize = info.st_size;
+    pakEntries = (const PakEntry*)(pakData + header->tocOffset);
+    pakEntryCount = header->entryCount;
+
+    TraceLog(LOG_INFO, "PAK: [%s] Mapped %u entries (%zu KB)", path, pakEntryCount, pakSize / 1024);
+    return true;
+}
+
+// Unmap the archive. Assets already uploaded stay valid.
+void CloseAssetPak(void) {
+    if (pakData != NULL) munmap((void*)pakData, pakSize);
+    pakData = NULL;
+    pakSize = 0;
+    pakEntries = NULL;
+    pakEntryCount = 0;
+}
+
+// Find an entry by name - the table of contents is sorted, so bisect it
+const PakEntry* FindPakEntry(const char* name, PakEntryType type) {
+    int low = 0;
+    int high = (int)pakEntryCount - 1;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        int order = strncmp(name, pakEntries[middle].name, PAK_NAME_LENGTH);
+        if (order == 0) {
+            const PakEntry* entry = &pakEntries[middle];
+            return (entry->type == type && IsEntryInBounds(entry)) ? entry : NULL;
+        }
+        if (order < 0) high = middle - 1;
+        else low = middle + 1;
+    }
+    return NULL;
+}
+
+// Fault an entry's pages in ahead of the upload - called from loader
+// workers so the main thread does not stall on disk reads
+void PrefetchPakEntry(const PakEntry* entry) {
+    if (entry == NULL) return;
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)(pakData + entry->offset) & ~(uintptr_t)(pageSize - 1);
+    uintptr_t end = (uintptr_t)(pakData + entry->offset + entry->size);
+    madvise((void*)start, end - start, MADV_WILLNEED);
+
+    // Touch one byte per page so the reads happen here, not on upload
+    volatile unsigned char sink = 0;
+    for (uintptr_t page = start; page < end; page += pageSize) {
+        sink ^= *(const unsigned char*)page;
+    }
+    (void)sink;
+}
+
+// Upload a baked texture, mip chain included, straight from the mapping
+Texture2D LoadPakTexture(const PakEntry* entry) {
+    Texture2D texture = { 0 };
+    if (entry == NULL || entry->type != PAK_ENTRY_TEXTURE) return texture;
+
+    texture.id = rlLoadTexture(pakData + entry->offset, entry->texture.width, entry->texture.height,
+                               entry->texture.format, entry->texture.mipmaps);
+    texture.width = entry->texture.width;
+    texture.height = entry->texture.height;
+    texture.mipmaps = entry->texture.mipmaps;
+    texture.format = entry->texture.format;
+
+    if (texture.mipmaps > 1) {
+        SetTextureFilter(texture, TEXTURE_FILTER_TRILINEAR);
+    }
+    return texture;
+}
+
+// rlgl may not name every GL type the quantized streams use
+#ifndef RL_BYTE
+#define RL_BYTE 0x1400
+#endif
+#ifndef RL_UNSIGNED_SHORT
+#define RL_UNSIGNED_SHORT 0x1403
+#endif
+#ifndef RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES
+#define RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES 6
+#endif
+
+// Room for raylib's vertex buffer slots, so UnloadMesh can walk the array
+#define PAK_MESH_BUFFER_SLOTS 16
+
+// Copy a mesh's indices into memory the model owns. DrawMesh picks the
+// indexed draw call by checking for them.
+static unsigned short* CopyPakIndices(const PakMesh* pakMesh, const unsigned char* data) {
+    if (pakMesh->indexCount == 0) return NULL;
+
+    unsigned short* indices = (unsigned short*)MemAlloc(pakMesh->indexCount * sizeof(unsigned short));
+    memcpy(indices, data + pakMesh->indexOffset, pakMesh->indexCount * sizeof(unsigned short));
+    return indices;
+}
+
+// Upload the quantized streams as they are, letting the GPU normalize
+// them. The model transform maps the unit positions back to the bounds,
+// and its normal matrix undoes the stretch baked into the normals.
+// Returns false if vertex arrays are unavailable.
+static bool UploadPackedMesh(Mesh* mesh, const PakMesh* pakMesh, const unsigned char* data) {
+    mesh->vaoId = rlLoadVertexArray();
+    if (mesh->vaoId == 0) return false;
+
+    rlEnableVertexArray(mesh->vaoId);
+    mesh->vboId = (unsigned int*)MemAlloc(PAK_MESH_BUFFER_SLOTS * sizeof(unsigned int));
+    int count = pakMesh->vertexCount;
+
+    mesh->vboId[0] = rlLoadVertexBuffer(data + pakMesh->positionOffset, count * 4 * sizeof(uint16_t), false);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_UNSIGNED_SHORT, true, 4 * sizeof(uint16_t), 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+
+    if (pakMesh->flags & PAK_MESH_FLOAT_TEXCOORDS) {
+        mesh->vboId[1] = rlLoadVertexBuffer(data + pakMesh->texcoordOffset, count * 2 * sizeof(float), false);
+        rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, false, 0, 0);
+    } else {
+        mesh->vboId[1] = rlLoadVertexBuffer(data + pakMesh->texcoordOffset, count * 2 * sizeof(uint16_t), false);
+        rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_UNSIGNED_SHORT, true, 0, 0);
+    }
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+
+    mesh->vboId[2] = rlLoadVertexBuffer(data + pakMesh->normalOffset, count * 4, false);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 3, RL_BYTE, true, 4, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+
+    // No vertex colors - shaders read white, as UploadMesh sets it up
+    float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, white, SHADER_ATTRIB_VEC4, 4);
+    rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+
+    if (pakMesh->indexCount > 0) {
+        mesh->vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] =
+            rlLoadVertexBufferElement(data + pakMesh->indexOffset, pakMesh->indexCount * sizeof(uint16_t), false);
+    }
+    mesh->indices = CopyPakIndices(pakMesh, data);
+
+    rlDisableVertexArray();
+    return true;
+}
+
+// Expand the quantized streams to floats and upload them the usual way,
+// for contexts without vertex arrays
+static void UploadDequantizedMesh(Mesh* mesh, const PakMesh* pakMesh, const unsigned char* data,
+                                  const PakModel* header) {
+    int count = pakMesh->vertexCount;
+    const uint16_t* positions = (const uint16_t*)(data + pakMesh->positionOffset);
+    const signed char* normals = (const signed char*)(data + pakMesh->normalOffset);
+
+    mesh->vertices = (float*)MemAlloc(count * 3 * sizeof(float));
+    mesh->texcoords = (float*)MemAlloc(count * 2 * sizeof(float));
+    mesh->normals = (float*)MemAlloc(count * 3 * sizeof(float));
+
+    // Positions come out in model space, so the normals are unstretched here
+    for (int i = 0; i < count; i++) {
+        float* normal = &mesh->normals[i * 3];
+        for (int c = 0; c < 3; c++) {
+            mesh->vertices[i * 3 + c] = header->boundsMin[c] + positions[i * 4 + c] / 65535.0f * header->boundsSize[c];
+            normal[c] = fmaxf(normals[i * 4 + c] / 127.0f, -1.0f) / header->boundsSize[c];
+        }
+        float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float scale = (length > 0.0f) ? 1.0f / length : 0.0f;
+        for (int c = 0; c < 3; c++) normal[c] *= scale;
+    }
+
+    if (pakMesh->flags & PAK_MESH_FLOAT_TEXCOORDS) {
+        memcpy(mesh->texcoords, data + pakMesh->texcoordOffset, count * 2 * sizeof(float));
+    } else {
+        const uint16_t* texcoords = (const uint16_t*)(data + pakMesh->texcoordOffset);
+        for (int i = 0; i < count * 2; i++) mesh->texcoords[i] = texcoords[i] / 65535.0f;
+    }
+
+    mesh->indices = CopyPakIndices(pakMesh, data);
+    UploadMesh(mesh, false);
+
+    // Only the indices are needed after the upload
+    MemFree(mesh->vertices);
+    MemFree(mesh->texcoords);
+    MemFree(mesh->normals);
+    mesh->vertices = NULL;
+    mesh->texcoords = NULL;
+    mesh->normals = NULL;
+}
+
+// Upload a baked model straight from the mapping. The diffuse texture is
+// shared through the asset registry; texture receives the reference taken
+// on it, or ASSET_INVALID, for the caller to release with the model.
+Model LoadPakModel(const PakEntry* entry, AssetHandle* texture) {
+    Model model = { 0 };
+    *texture = ASSET_INVALID;
+    if (entry == NULL || entry->type != PAK_ENTRY_MODEL) return model;
+
+    const unsigned char* data = pakData + entry->offset;
+    const PakModel* header = (const PakModel*)data;
+    const PakMesh* pakMeshes = (const PakMesh*)(data + sizeof(PakModel));
+
+    model.meshCount = entry->model.meshCount;
+    model.meshes = (Mesh*)MemAlloc(model.meshCount * sizeof(Mesh));
+    model.meshMaterial = (int*)MemAlloc(model.meshCount * sizeof(int));
+
+    bool packed = true;
+    for (int i = 0; i < model.meshCount; i++) {
+        const PakMesh* pakMesh = &pakMeshes[i];
+        Mesh* mesh = &model.meshes[i];
+
+        mesh->vertexCount = pakMesh->vertexCount;
+        mesh->triangleCount = (pakMesh->indexCount > 0) ? pakMesh->indexCount / 3 : pakMesh->vertexCount / 3;
+
+        if (packed) packed = UploadPackedMesh(mesh, pakMesh, data);
+        if (!packed) UploadDequantizedMesh(mesh, pakMesh, data, header);
+    }
+
+    // Packed positions are unit fractions of the bounds
+    model.transform = MatrixIdentity();
+    if (packed) {
+        Matrix scale = MatrixScale(header->boundsSize[0], header->boundsSize[1], header->boundsSize[2]);
+        Matrix translate = MatrixTranslate(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+        model.transform = MatrixMultiply(scale, translate);
+    }
+
+    model.materialCount = 1;
+    model.materials = (Material*)MemAlloc(sizeof(Material));
+    model.materials[0] = LoadMaterialDefault();
+
+    if (entry->model.textureEntry < pakEntryCount) {
+        const PakEntry* textureEntry = &pakEntries[entry->model.textureEntry];
+        *texture = AcquireTexture(textureEntry->name, WHITE);
+        model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = GetTextureAsset(*texture);
+    }
+
+    return model;
+}
@@ -4,8 +4,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 
-// Initialize player
-void InitPlayer(Player* player) {
+// Put the player back at the start of a game: position, stats, combat
+// and an empty inventory. The model, HUD textures and inventory storage
+// are kept, so this needs no GPU work.
+void ResetPlayer(Player* player) {
     // Set default position
     player->position = (Vector3){0.0f, 0.0f, 0.0f};
     player->velocity = (Vector3){0.0f, 0.0f, 0.0f};
@@ -43,13 +45,20 @@ void InitPlayer(Player* player) {
     player->attackRange = 2.0f;
     player->attackDamage = 10;
     
-    // Initialize inventory
-    player->inventory.maxItems = 20;
-    player->inventory.items = (Item*)malloc(sizeof(Item) * player->inventory.maxItems);
+    // Empty the inventory
     player->inventory.itemCount = 0;
     player->inventory.equippedWeapon = -1;
     player->inventory.equippedArmor = -1;
     player->inventory.equippedAccessory = -1;
+}
+
+// Initialize player
+void InitPlayer(Player* player) {
+    ResetPlayer(player);
+    
+    // Initialize inventory
+    player->inventory.maxItems = 20;
+    player->inventory.items = (Item*)malloc(sizeof(Item) * player->inventory.maxItems);
     
     // Create a fallback model using a cube primitive for now
     player->model = LoadModelFromMesh(GenMeshCube(0.8f, 1.8f, 0.8f));
@@ -63,12 +72,12 @@ void InitPlayer(Player* player) {
 }
 
 // Update player state
-void UpdatePlayer(Player* player, float deltaTime) {
+void UpdatePlayer(Player* player, const InputFrame* input, float deltaTime) {
     // Store previous position for collision checks
     Vector3 previousPosition = player->position;
     
-    // Handle rotation with mouse
-    Vector2 mouseDelta = GetMouseDelta();
+    // Handle rotation with mouse movement latched for this tick
+    Vector2 mouseDelta = input->mouseDelta;
     
     // Apply mouse sensitivity - increased for better responsiveness
     float mouseSensitivity = 0.003f;
@@ -76,11 +85,6 @@ void UpdatePlayer(Player* player, float deltaTime) {
     // Adjust sensitivity to make it more responsive
     mouseSensitivity *= 2.5f;
     
-    // Make sure mouse stays centered - essential for FPS camera control
-    if (IsWindowFocused()) {
-        SetMousePosition(GetScreenWidth()/2, GetScreenHeight()/2);
-    }
-    
     // Update rotation angle based on mouse X movement
     player->rotationAngle -= mouseDelta.x * mouseSensitivity;
     
@@ -109,12 +113,12 @@ void UpdatePlayer(Player* player, float deltaTime) {
     player->velocity.z = 0;
     
     // Get player input
-    if (IsKeyDown(KEY_W)) {
+    if (InputDown(input, INPUT_MOVE_FORWARD)) {
         // Move forward
         player->velocity.x += player->direction.x * player->speed;
         player->velocity.z += player->direction.z * player->speed;
     }
-    if (IsKeyDown(KEY_S)) {
+    if (InputDown(input, INPUT_MOVE_BACK)) {
         // Move backward
         player->velocity.x -= player->direction.x * player->speed;
         player->velocity.z -= player->direction.z * player->speed;
@@ -124,12 +128,12 @@ void UpdatePlayer(Player* player, float deltaTime) {
     Vector3 right = Vector3CrossProduct(player->direction, (Vector3){0, 1, 0});
     right = Vector3Normalize(right);
     
-    if (IsKeyDown(KEY_A)) {
+    if (InputDown(input, INPUT_STRAFE_LEFT)) {
         // Strafe left
         player->velocity.x -= right.x * player->speed;
         player->velocity.z -= right.z * player->speed;
     }
-    if (IsKeyDown(KEY_D)) {
+    if (InputDown(input, INPUT_STRAFE_RIGHT)) {
         // Strafe right
         player->velocity.x += right.x * player->speed;
         player->velocity.z += right.z * player->speed;
@@ -148,7 +152,7 @@ void UpdatePlayer(Player* player, float deltaTime) {
         player->velocity.y = 0;
         
         // Jump if space is pressed
-        if (IsKeyPressed(KEY_SPACE)) {
+        if (InputPressed(input, INPUT_JUMP)) {
             player->velocity.y = player->jumpForce;
             player->isGrounded = false;
             player->isJumping = true;
@@ -178,7 +182,7 @@ void UpdatePlayer(Player* player, float deltaTime) {
     }
     
     // Initiate attack with left mouse button
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !player->isAttacking) {
+    if (InputPressed(input, INPUT_ATTACK) && !player->isAttacking) {
         PlayerAttack(player);
     }
     
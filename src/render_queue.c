@@ -0,0 +1,456 @@
+#include "../include/render_queue.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RENDER_KEY_DEPTH_MAX ((1ULL << RENDER_KEY_DEPTH_BITS) - 1)
+#define RENDER_MATERIAL_MAPS 12     // raylib's MAX_MATERIAL_MAPS, which its header does not export
+
+// GL state the opaque pass keeps bound from one draw to the next. Sorted
+// runs share a material and mesh, so most draws only set their matrices
+// and tint.
+typedef struct {
+    Matrix view;
+    Matrix projection;
+    Matrix transform;               // rlgl's current transform, applied after each model's
+    const Material* material;       // Bound shader and textures, NULL for none
+    unsigned int vaoId;             // Bound vertex array, 0 for none
+} BoundState;
+
+#define RENDER_MATERIAL_INITIAL_SLOTS 256
+
+// Slot of a (shader, texture) pair in the material table, by Fibonacci hashing
+static int GetMaterialSlot(unsigned long long pair, int slots) {
+    return (int)((pair * 0x9E3779B97F4A7C15ULL) >> 32) & (slots - 1);
+}
+
+// Rebuild the material table at a new size, keeping every id
+static bool ResizeMaterialTable(RenderQueue* queue, int slots) {
+    unsigned long long* pairs = (unsigned long long*)calloc(slots, sizeof(unsigned long long));
+    unsigned short* ids = (unsigned short*)malloc(slots * sizeof(unsigned short));
+    if (pairs == NULL || ids == NULL) {
+        free(pairs);
+        free(ids);
+        return false;
+    }
+
+    for (int i = 0; i < queue->materialSlots; i++) {
+        if (queue->materialPairs[i] == 0) continue;
+        int slot = GetMaterialSlot(queue->materialPairs[i], slots);
+        while (pairs[slot] != 0) slot = (slot + 1) & (slots - 1);
+        pairs[slot] = queue->materialPairs[i];
+        ids[slot] = queue->materialIds[i];
+    }
+
+    free(queue->materialPairs);
+    free(queue->materialIds);
+    queue->materialPairs = pairs;
+    queue->materialIds = ids;
+    queue->materialSlots = slots;
+    return true;
+}
+
+// Material bucket of a model - a dense id for its shader and diffuse
+// texture, handed out the first time the pair is queued. GL names are
+// not small enough to pack into the key as they are. Once the ids run
+// out, new pairs share bucket 0, which only costs sort order.
+static unsigned int GetMaterialId(RenderQueue* queue, const Model* model) {
+    if (model->materialCount == 0) return 0;
+    const Material* material = &model->materials[0];
+    unsigned long long pair = ((unsigned long long)material->shader.id << 32) |
+                              material->maps[MATERIAL_MAP_DIFFUSE].texture.id;
+    if (pair == 0) return 0;
+
+    // Linear probing, with the table kept at most half full
+    if (queue->materialSlots > 0) {
+        int slot = GetMaterialSlot(pair, queue->materialSlots);
+        for (; queue->materialPairs[slot] != 0; slot = (slot + 1) & (queue->materialSlots - 1)) {
+            if (queue->materialPairs[slot] == pair) return queue->materialIds[slot];
+        }
+    }
+
+    if (queue->materialCount == RENDER_MATERIAL_MAX) return 0;
+    if ((queue->materialCount + 1) * 2 > queue->materialSlots) {
+        int slots = (queue->materialSlots > 0) ? queue->materialSlots * 2 : RENDER_MATERIAL_INITIAL_SLOTS;
+        if (!ResizeMaterialTable(queue, slots)) return 0;
+    }
+
+    int slot = GetMaterialSlot(pair, queue->materialSlots);
+    while (queue->materialPairs[slot] != 0) slot = (slot + 1) & (queue->materialSlots - 1);
+    queue->materialPairs[slot] = pair;
+    queue->materialIds[slot] = (unsigned short)++queue->materialCount;
+    return queue->materialIds[slot];
+}
+
+// Mesh bucket of a model - its first vertex array
+static unsigned int GetMeshId(const Model* model) {
+    if (model->meshCount == 0) return 0;
+    return model->meshes[0].vaoId & 0xFFFF;
+}
+
+// Quantise the distance from the camera into the depth bits
+static unsigned long long GetDepthBits(RenderQueue* queue, Vector3 position) {
+    float depth = Vector3Distance(queue->camera.position, position) * RENDER_DEPTH_SCALE;
+    if (depth >= (float)RENDER_KEY_DEPTH_MAX) return RENDER_KEY_DEPTH_MAX;
+    return (unsigned long long)depth;
+}
+
+// Reallocate the queue's arrays for a new capacity
+static bool ResizeRenderQueue(RenderQueue* queue, int capacity) {
+    RenderCommand* commands = (RenderCommand*)realloc(queue->commands, capacity * sizeof(RenderCommand));
+    if (commands == NULL) return false;
+    queue->commands = commands;
+
+    unsigned long long* keys = (unsigned long long*)realloc(queue->keys, capacity * sizeof(unsigned long long));
+    if (keys == NULL) return false;
+    queue->keys = keys;
+
+    // Sort buffers never hold state between frames, so they can be replaced outright
+    free(queue->order);
+    free(queue->sortKeys);
+    free(queue->sortScratch);
+    free(queue->sortKeysScratch);
+    queue->order = (int*)malloc(capacity * sizeof(int));
+    queue->sortKeys = (unsigned long long*)malloc(capacity * sizeof(unsigned long long));
+    queue->sortScratch = (int*)malloc(capacity * sizeof(int));
+    queue->sortKeysScratch = (unsigned long long*)malloc(capacity * sizeof(unsigned long long));
+
+    queue->capacity = capacity;
+    return true;
+}
+
+// Make room for one more command, doubling the queue when it is full
+static bool ReserveCommand(RenderQueue* queue) {
+    if (queue->count < queue->capacity) return true;
+    return ResizeRenderQueue(queue, queue->capacity > 0 ? queue->capacity * 2 : 1024);
+}
+
+// LSD radix sort of the command indices by key, 8 bits per pass.
+// Passes where every key shares the same byte are skipped.
+static void RadixSortCommands(RenderQueue* queue) {
+    int count = queue->count;
+    unsigned long long* keys = queue->sortKeys;
+    unsigned long long* keysOut = queue->sortKeysScratch;
+    int* order = queue->order;
+    int* orderOut = queue->sortScratch;
+
+    for (int i = 0; i < count; i++) {
+        keys[i] = queue->keys[i];
+        order[i] = i;
+    }
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        int histogram[256] = {0};
+        for (int i = 0; i < count; i++) {
+            histogram[(keys[i] >> shift) & 0xFF]++;
+        }
+
+        // All keys share this byte, nothing to reorder
+        if (histogram[(keys[0] >> shift) & 0xFF] == count) continue;
+
+        int offset = 0;
+        for (int b = 0; b < 256; b++) {
+            int bucketSize = histogram[b];
+            histogram[b] = offset;
+            offset += bucketSize;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int slot = histogram[(keys[i] >> shift) & 0xFF]++;
+            keysOut[slot] = keys[i];
+            orderOut[slot] = order[i];
+        }
+
+        unsigned long long* tempKeys = keys;
+        keys = keysOut;
+        keysOut = tempKeys;
+        int* tempOrder = order;
+        order = orderOut;
+        orderOut = tempOrder;
+    }
+
+    // Make sure the sorted order ends up in queue->order
+    if (order != queue->order) {
+        memcpy(queue->order, order, count * sizeof(int));
+    }
+}
+
+// Draw a health bar above a world position in screen space
+static void DrawHealthBarOverlay(RenderQueue* queue, RenderCommand* command) {
+    // Skip bars behind the camera
+    Vector3 forward = Vector3Subtract(queue->camera.target, queue->camera.position);
+    Vector3 toBar = Vector3Subtract(command->position, queue->camera.position);
+    if (Vector3DotProduct(forward, toBar) <= 0.0f) return;
+
+    Vector2 screenPos = GetWorldToScreen(command->position, queue->camera);
+    float barWidth = 30.0f;
+    float barHeight = 5.0f;
+
+    DrawRectangle(screenPos.x - barWidth/2, screenPos.y, barWidth, barHeight, DARKGRAY);
+    DrawRectangle(screenPos.x - barWidth/2, screenPos.y, barWidth * command->value, barHeight, RED);
+    DrawRectangleLines(screenPos.x - barWidth/2, screenPos.y, barWidth, barHeight, BLACK);
+}
+
+// Check whether a map slot holds a cubemap rather than a 2D texture
+static bool IsCubemapMap(int map) {
+    return map == MATERIAL_MAP_CUBEMAP || map == MATERIAL_MAP_IRRADIANCE || map == MATERIAL_MAP_PREFILTER;
+}
+
+// Check whether two materials bind the same shader and textures
+static bool SameMaterialBinding(const Material* a, const Material* b) {
+    if (a == b) return true;
+    if (a->shader.id != b->shader.id) return false;
+    for (int i = 0; i < RENDER_MATERIAL_MAPS; i++) {
+        if (a->maps[i].texture.id != b->maps[i].texture.id) return false;
+    }
+    return true;
+}
+
+// Release the bound shader and textures. A bound vertex array does not
+// depend on them and stays.
+static void UnbindMaterial(BoundState* state) {
+    if (state->material == NULL) return;
+
+    for (int i = 0; i < RENDER_MATERIAL_MAPS; i++) {
+        if (state->material->maps[i].texture.id == 0) continue;
+        rlActiveTextureSlot(i);
+        if (IsCubemapMap(i)) rlDisableTextureCubemap();
+        else rlDisableTexture();
+    }
+    rlActiveTextureSlot(0);
+    rlDisableShader();
+    state->material = NULL;
+}
+
+// Release whatever the pass has bound
+static void UnbindState(BoundState* state) {
+    if (state->vaoId != 0) {
+        rlDisableVertexArray();
+        state->vaoId = 0;
+    }
+    UnbindMaterial(state);
+}
+
+// Bind a material's shader and textures, with the pass's camera matrices
+static void BindMaterial(BoundState* state, const Material* material) {
+    UnbindMaterial(state);
+
+    const int* locs = material->shader.locs;
+    rlEnableShader(material->shader.id);
+    if (locs[SHADER_LOC_MATRIX_VIEW] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_VIEW], state->view);
+    if (locs[SHADER_LOC_MATRIX_PROJECTION] != -1) {
+        rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_PROJECTION], state->projection);
+    }
+
+    for (int i = 0; i < RENDER_MATERIAL_MAPS; i++) {
+        unsigned int texture = material->maps[i].texture.id;
+        if (texture == 0) continue;
+        rlActiveTextureSlot(i);
+        if (IsCubemapMap(i)) rlEnableTextureCubemap(texture);
+        else rlEnableTexture(texture);
+        rlSetUniform(locs[SHADER_LOC_MAP_DIFFUSE + i], &i, SHADER_UNIFORM_INT, 1);
+    }
+    state->material = material;
+}
+
+// Set a color uniform from an 8-bit color, if the shader has it
+static void SetColorUniform(int location, Color color) {
+    if (location == -1) return;
+    float values[4] = { color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f };
+    rlSetUniform(location, values, SHADER_UNIFORM_VEC4, 1);
+}
+
+// Draw a single-mesh model, binding its material and vertex array only
+// when they differ from what the previous draw left bound. Does what
+// DrawModelEx and DrawMesh do for it, minus the rebinding.
+static void DrawBoundModel(RenderQueue* queue, BoundState* state, const RenderCommand* command) {
+    const Model* model = command->model;
+    const Mesh* mesh = &model->meshes[0];
+    const Material* material = &model->materials[(model->meshMaterial != NULL) ? model->meshMaterial[0] : 0];
+
+    if (state->material != NULL && SameMaterialBinding(state->material, material)) {
+        queue->stats.materialBindsSkipped++;
+    } else {
+        BindMaterial(state, material);
+        queue->stats.materialBinds++;
+    }
+    if (state->vaoId == mesh->vaoId) {
+        queue->stats.meshBindsSkipped++;
+    } else {
+        rlEnableVertexArray(mesh->vaoId);
+        state->vaoId = mesh->vaoId;
+        queue->stats.meshBinds++;
+    }
+
+    // Diffuse color tinted as DrawModelEx does; specular as the material has it
+    const int* locs = material->shader.locs;
+    Color diffuse = material->maps[MATERIAL_MAP_DIFFUSE].color;
+    Color tint = command->tint;
+    SetColorUniform(locs[SHADER_LOC_COLOR_DIFFUSE], (Color){
+        (unsigned char)((diffuse.r * tint.r) / 255), (unsigned char)((diffuse.g * tint.g) / 255),
+        (unsigned char)((diffuse.b * tint.b) / 255), (unsigned char)((diffuse.a * tint.a) / 255) });
+    SetColorUniform(locs[SHADER_LOC_COLOR_SPECULAR], material->maps[MATERIAL_MAP_SPECULAR].color);
+
+    // Scale, rotate, then place the model, after its own transform
+    Matrix scale = MatrixScale(command->scale.x, command->scale.y, command->scale.z);
+    Matrix rotation = MatrixRotate(command->rotationAxis, command->rotationAngle * DEG2RAD);
+    Matrix translation = MatrixTranslate(command->position.x, command->position.y, command->position.z);
+    Matrix placement = MatrixMultiply(MatrixMultiply(scale, rotation), translation);
+    Matrix matModel = MatrixMultiply(MatrixMultiply(model->transform, placement), state->transform);
+    if (locs[SHADER_LOC_MATRIX_MODEL] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MODEL], matModel);
+    if (locs[SHADER_LOC_MATRIX_NORMAL] != -1) {
+        rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_NORMAL], MatrixTranspose(MatrixInvert(matModel)));
+    }
+    Matrix matModelView = MatrixMultiply(matModel, state->view);
+    rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matModelView, state->projection));
+
+    if (mesh->indices != NULL) rlDrawVertexArrayElements(0, mesh->triangleCount * 3, 0);
+    else rlDrawVertexArray(0, mesh->vertexCount);
+}
+
+// Check whether a model can be drawn with the pass's bound state: one
+// mesh with a vertex array, and a material
+static bool CanDrawBound(const Model* model) {
+    return model->meshCount == 1 && model->materialCount > 0 && model->meshes[0].vaoId != 0;
+}
+
+// Initialize a render queue with an initial command capacity
+void InitRenderQueue(RenderQueue* queue, int capacity) {
+    memset(queue, 0, sizeof(RenderQueue));
+    ResizeRenderQueue(queue, capacity);
+}
+
+// Free the queue's arrays
+void UnloadRenderQueue(RenderQueue* queue) {
+    free(queue->commands);
+    free(queue->keys);
+    free(queue->order);
+    free(queue->sortKeys);
+    free(queue->sortScratch);
+    free(queue->sortKeysScratch);
+    free(queue->materialPairs);
+    free(queue->materialIds);
+    memset(queue, 0, sizeof(RenderQueue));
+}
+
+// Start a new frame of submissions from the given camera
+void BeginRenderQueue(RenderQueue* queue, Camera camera) {
+    queue->count = 0;
+    queue->camera = camera;
+    memset(&queue->stats, 0, sizeof(RenderStats));
+}
+
+// Queue a model draw in the opaque pass
+void QueueModel(RenderQueue* queue, const Model* model, Vector3 position, Vector3 rotationAxis,
+                float rotationAngle, Vector3 scale, Color tint) {
+    if (!ReserveCommand(queue)) return;
+
+    RenderCommand* command = &queue->commands[queue->count];
+    command->type = RENDER_CMD_MODEL;
+    command->model = model;
+    command->position = position;
+    command->rotationAxis = rotationAxis;
+    command->rotationAngle = rotationAngle;
+    command->scale = scale;
+    command->tint = tint;
+    command->value = 0.0f;
+
+    // Group by material then mesh, nearest first within a group
+    queue->keys[queue->count] = ((unsigned long long)RENDER_PASS_OPAQUE << RENDER_KEY_PASS_SHIFT) |
+                                ((unsigned long long)GetMaterialId(queue, model) << RENDER_KEY_MATERIAL_SHIFT) |
+                                ((unsigned long long)GetMeshId(model) << RENDER_KEY_MESH_SHIFT) |
+                                GetDepthBits(queue, position);
+    queue->count++;
+}
+
+// Queue a health bar in the overlay pass
+void QueueHealthBar(RenderQueue* queue, Vector3 position, float ratio) {
+    if (!ReserveCommand(queue)) return;
+
+    RenderCommand* command = &queue->commands[queue->count];
+    memset(command, 0, sizeof(RenderCommand));
+    command->type = RENDER_CMD_HEALTH_BAR;
+    command->position = position;
+    command->value = Clamp(ratio, 0.0f, 1.0f);
+
+    // Overlays go back-to-front so nearer bars end up on top
+    queue->keys[queue->count] = ((unsigned long long)RENDER_PASS_OVERLAY << RENDER_KEY_PASS_SHIFT) |
+                                (RENDER_KEY_DEPTH_MAX - GetDepthBits(queue, position));
+    queue->count++;
+}
+
+// Sort the frame's commands and draw them: the 3D pass, then overlays
+void FlushRenderQueue(RenderQueue* queue) {
+    double startTime = GetTime();
+    queue->stats.commands = queue->count;
+
+    if (queue->count > 0) {
+        RadixSortCommands(queue);
+    }
+
+    double sortedTime = GetTime();
+    queue->stats.sortTime = sortedTime - startTime;
+
+    // Opaque pass - sorted so commands sharing a material and mesh are
+    // adjacent, and each run binds them once
+    int index = 0;
+
+    BeginMode3D(queue->camera);
+    BoundState state = { rlGetMatrixModelview(), rlGetMatrixProjection(), rlGetMatrixTransform(), NULL, 0 };
+    for (; index < queue->count; index++) {
+        RenderCommand* command = &queue->commands[queue->order[index]];
+        if (command->type != RENDER_CMD_MODEL) break;
+
+        if (CanDrawBound(command->model)) {
+            DrawBoundModel(queue, &state, command);
+        } else {
+            // Multi-mesh models go through raylib, which binds for itself
+            UnbindState(&state);
+            DrawModelEx(*command->model, command->position, command->rotationAxis,
+                        command->rotationAngle, command->scale, command->tint);
+        }
+        queue->stats.modelDraws++;
+    }
+    UnbindState(&state);
+    EndMode3D();
+
+    // Overlay pass - screen-space elements anchored to world positions
+    for (; index < queue->count; index++) {
+        RenderCommand* command = &queue->commands[queue->order[index]];
+        if (command->type == RENDER_CMD_HEALTH_BAR) {
+            DrawHealthBarOverlay(queue, command);
+            queue->stats.overlayDraws++;
+        }
+    }
+
+    queue->stats.flushTime = GetTime() - sortedTime;
+}
+
+// Empty a scene list, keeping its storage for the next recording
+void ClearSceneList(SceneList* scene) {
+    scene->count = 0;
+}
+
+// Record a model, doubling the list when it is full. Returns the entry so
+// a health bar can be added, or NULL when out of memory.
+SceneModel* RecordSceneModel(SceneList* scene, unsigned int id, const Model* model, Vector3 position,
+                             float rotation, Color tint) {
+    if (scene->count == scene->capacity) {
+        int capacity = scene->capacity > 0 ? scene->capacity * 2 : 256;
+        SceneModel* models = (SceneModel*)realloc(scene->models, capacity * sizeof(SceneModel));
+        if (models == NULL) return NULL;
+        scene->models = models;
+        scene->capacity = capacity;
+    }
+
+    SceneModel* entry = &scene->models[scene->count++];
+    *entry = (SceneModel){ id, model, position, rotation, tint, 0.0f, 0.0f };
+    return entry;
+}
+
+// Free a scene list's storage
+void UnloadSceneList(SceneList* scene) {
+    free(scene->models);
+    memset(scene, 0, sizeof(SceneList));
+}
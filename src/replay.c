@@ -0,0 +1,300 @@
+#include "../include/replay.h"
+#include "../include/sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Make room for another tick's bytes. A tick is at most a mask and four
+// 32-bit varints.
+static bool ReserveReplayData(Replay* replay, int bytes) {
+    if (replay->size + bytes <= replay->capacity) return true;
+
+    int capacity = (replay->capacity > 0) ? replay->capacity * 2 : REPLAY_INITIAL_CAPACITY;
+    while (capacity < replay->size + bytes) capacity *= 2;
+    unsigned char* data = (unsigned char*)realloc(replay->data, capacity);
+    if (data == NULL) return false;
+
+    replay->data = data;
+    replay->capacity = capacity;
+    return true;
+}
+
+// Append seven bits at a time, low bits first, with the top bit set on
+// every byte but the last
+static void WriteVarint(Replay* replay, uint32_t value) {
+    while (value >= 0x80u) {
+        replay->data[replay->size++] = (unsigned char)(value | 0x80u);
+        value >>= 7;
+    }
+    replay->data[replay->size++] = (unsigned char)value;
+}
+
+// Read a varint back. Fails on data that ends inside one.
+static bool ReadVarint(Replay* replay, uint32_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (replay->cursor >= replay->size) return false;
+        unsigned char byte = replay->data[replay->cursor++];
+        *value |= (uint32_t)(byte & 0x7Fu) << shift;
+        if (!(byte & 0x80u)) return true;
+    }
+    return false;
+}
+
+// Signed values as unsigned, small magnitudes first: 0, -1, 1, -2, ...
+static uint32_t ZigzagEncode(int value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int ZigzagDecode(uint32_t value) {
+    return (int)(value >> 1) ^ -(int)(value & 1u);
+}
+
+// Start recording a session that was seeded with seed. Nothing is written
+// until FinishReplay.
+bool StartRecording(Replay* replay, const char* path, unsigned int seed) {
+    memset(replay, 0, sizeof(Replay));
+    if (!ReserveReplayData(replay, REPLAY_INITIAL_CAPACITY)) {
+        TraceLog(LOG_WARNING, "REPLAY: Failed to allocate recording buffer");
+        return false;
+    }
+
+    replay->mode = REPLAY_RECORDING;
+    replay->path = path;
+    replay->header.magic = REPLAY_MAGIC;
+    replay->header.version = REPLAY_VERSION;
+    replay->header.seed = seed;
+    TraceLog(LOG_INFO, "REPLAY: Recording to %s (seed %u)", path, seed);
+    return true;
+}
+
+// Read a recording for playback. The caller seeds the game from its
+// header before building anything.
+bool LoadReplay(Replay* replay, const char* path) {
+    memset(replay, 0, sizeof(Replay));
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "REPLAY: Failed to open %s", path);
+        return false;
+    }
+
+    ReplayHeader header;
+    bool valid = fread(&header, sizeof(ReplayHeader), 1, file) == 1 && header.magic == REPLAY_MAGIC &&
+                 header.version == REPLAY_VERSION;
+    if (valid) {
+        replay->data = (unsigned char*)malloc(header.dataSize > 0 ? header.dataSize : 1);
+        valid = replay->data != NULL && fread(replay->data, 1, header.dataSize, file) == header.dataSize;
+    }
+    fclose(file);
+
+    if (!valid) {
+        TraceLog(LOG_WARNING, "REPLAY: %s is not a version %d recording", path, REPLAY_VERSION);
+        UnloadReplay(replay);
+        return false;
+    }
+
+    replay->mode = REPLAY_PLAYING;
+    replay->path = path;
+    replay->header = header;
+    replay->size = (int)header.dataSize;
+    replay->capacity = replay->size;
+    TraceLog(LOG_INFO, "REPLAY: Playing %s (%u ticks, %.1f s, %d bytes, seed %u)", path, header.tickCount,
+             (float)header.tickCount / SIM_TICK_RATE, replay->size, header.seed);
+    return true;
+}
+
+// Append one tick's input. The mouse delta is rounded to the stored
+// precision in place, so the live session simulates exactly what the
+// replay will. A tick that can't be stored fails the whole recording,
+// since the ticks after it would replay out of step.
+void RecordReplayTick(Replay* replay, InputFrame* input) {
+    if (replay->mode != REPLAY_RECORDING || replay->failed) return;
+    if (!ReserveReplayData(replay, 1 + 4 * 5)) {
+        TraceLog(LOG_WARNING, "REPLAY: Out of memory at tick %d, recording abandoned", replay->ticks);
+        replay->failed = true;
+        return;
+    }
+
+    int mouseX = (int)lroundf(input->mouseDelta.x * REPLAY_MOUSE_STEPS);
+    int mouseY = (int)lroundf(input->mouseDelta.y * REPLAY_MOUSE_STEPS);
+    input->mouseDelta = (Vector2){ mouseX / REPLAY_MOUSE_STEPS, mouseY / REPLAY_MOUSE_STEPS };
+
+    unsigned int downChanges = input->down ^ replay->previousDown;
+    unsigned int fields = 0;
+    if (downChanges != 0) fields |= REPLAY_FIELD_DOWN;
+    if (input->pressed != 0) fields |= REPLAY_FIELD_PRESSED;
+    if (mouseX != replay->previousMouseX) fields |= REPLAY_FIELD_MOUSE_X;
+    if (mouseY != replay->previousMouseY) fields |= REPLAY_FIELD_MOUSE_Y;
+
+    WriteVarint(replay, fields);
+    if (fields & REPLAY_FIELD_DOWN) WriteVarint(replay, downChanges);
+    if (fields & REPLAY_FIELD_PRESSED) WriteVarint(replay, input->pressed);
+    if (fields & REPLAY_FIELD_MOUSE_X) WriteVarint(replay, ZigzagEncode(mouseX - replay->previousMouseX));
+    if (fields & REPLAY_FIELD_MOUSE_Y) WriteVarint(replay, ZigzagEncode(mouseY - replay->previousMouseY));
+
+    replay->previousDown = input->down;
+    replay->previousMouseX = mouseX;
+    replay->previousMouseY = mouseY;
+    replay->ticks++;
+}
+
+// Decode the next tick's input. Returns false once the recording is used
+// up, or if it is truncated.
+bool NextReplayTick(Replay* replay, InputFrame* input) {
+    if (replay->mode != REPLAY_PLAYING || replay->ticks >= (int)replay->header.tickCount) return false;
+    if (replay->ticks == 0) replay->startTime = GetTime();
+
+    uint32_t fields;
+    uint32_t value = 0;
+    if (!ReadVarint(replay, &fields)) return false;
+
+    if (fields & REPLAY_FIELD_DOWN) {
+        if (!ReadVarint(replay, &value)) return false;
+        replay->previousDown ^= value;
+    }
+    input->down = replay->previousDown;
+
+    input->pressed = 0;
+    if (fields & REPLAY_FIELD_PRESSED) {
+        if (!ReadVarint(replay, &value)) return false;
+        input->pressed = value;
+    }
+
+    if (fields & REPLAY_FIELD_MOUSE_X) {
+        if (!ReadVarint(replay, &value)) return false;
+        replay->previousMouseX += ZigzagDecode(value);
+    }
+    if (fields & REPLAY_FIELD_MOUSE_Y) {
+        if (!ReadVarint(replay, &value)) return false;
+        replay->previousMouseY += ZigzagDecode(value);
+    }
+    input->mouseDelta = (Vector2){ replay->previousMouseX / REPLAY_MOUSE_STEPS,
+                                   replay->previousMouseY / REPLAY_MOUSE_STEPS };
+
+    replay->ticks++;
+    return true;
+}
+
+// End the session. A recording is written out with the final state hash;
+// a playback reports its speed and whether it ended in the recorded
+// state. Returns false on a failed recording, a write failure or a
+// mismatch.
+bool FinishReplay(Replay* replay, unsigned int stateHash) {
+    bool success = true;
+
+    if (replay->mode == REPLAY_RECORDING && replay->failed) {
+        TraceLog(LOG_WARNING, "REPLAY: Recording incomplete, %s not written", replay->path);
+        success = false;
+    } else if (replay->mode == REPLAY_RECORDING) {
+        replay->header.tickCount = (uint32_t)replay->ticks;
+        replay->header.stateHash = stateHash;
+        replay->header.dataSize = (uint32_t)replay->size;
+
+        FILE* file = fopen(replay->path, "wb");
+        success = file != NULL && fwrite(&replay->header, sizeof(ReplayHeader), 1, file) == 1 &&
+                  fwrite(replay->data, 1, replay->size, file) == (size_t)replay->size;
+        if (file != NULL) success = (fclose(file) == 0) && success;
+
+        if (success) {
+            TraceLog(LOG_INFO, "REPLAY: Wrote %d ticks to %s (%d bytes, %.2f per tick, state %08x)", replay->ticks,
+                     replay->path, replay->size, replay->ticks > 0 ? (float)replay->size / replay->ticks : 0.0f,
+                     stateHash);
+        } else {
+            TraceLog(LOG_WARNING, "REPLAY: Failed to write %s", replay->path);
+        }
+    } else if (replay->mode == REPLAY_PLAYING) {
+        double seconds = GetTime() - replay->startTime;
+        double simulated = (double)replay->ticks / SIM_TICK_RATE;
+        success = replay->ticks == (int)replay->header.tickCount && stateHash == replay->header.stateHash;
+
+        TraceLog(LOG_INFO, "REPLAY: Played %d/%u ticks in %.2f s (%.0f ticks/s, %.1fx real time)", replay->ticks,
+                 replay->header.tickCount, seconds, seconds > 0.0 ? replay->ticks / seconds : 0.0,
+                 seconds > 0.0 ? simulated / seconds : 0.0);
+        TraceLog(success ? LOG_INFO : LOG_WARNING, "REPLAY: Final state %08x, recorded %08x - %s", stateHash,
+                 replay->header.stateHash, success ? "match" : "DIVERGED");
+    }
+
+    replay->mode = REPLAY_FINISHED;
+    return success;
+}
+
+// Free the tick data
+void UnloadReplay(Replay* replay) {
+    free(replay->data);
+    memset(replay, 0, sizeof(Replay));
+}
+
+// FNV-1a over a run of bytes
+static uint32_t HashBytes(uint32_t hash, const void* bytes, size_t size) {
+    const unsigned char* data = (const unsigned char*)bytes;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Hash the simulated fields of an item, leaving out its GPU resources and
+// the name pointers
+static uint32_t HashItem(uint32_t hash, const Item* item) {
+    int fields[] = { item->type, item->subType, item->level, item->value, item->isEquipped, item->isIdentified,
+                     item->minDamage, item->maxDamage, item->armor, item->strength, item->dexterity,
+                     item->intelligence, item->effectValue, item->isOnGround };
+    hash = HashBytes(hash, fields, sizeof(fields));
+    hash = HashBytes(hash, &item->effectDuration, sizeof(item->effectDuration));
+    hash = HashBytes(hash, &item->position, sizeof(item->position));
+    hash = HashBytes(hash, &item->rotationAngle, sizeof(item->rotationAngle));
+    return HashBytes(hash, &item->bobTimer, sizeof(item->bobTimer));
+}
+
+// Fingerprint of the simulation state a replay must reproduce: the game
+// state machine, the player and their inventory, every enemy slot in use,
+// and the ground items and projectiles in store order. Floats are hashed
+// by their bits, so any drift at all shows up.
+unsigned int HashGameState(GameState* gameState) {
+    uint32_t hash = 2166136261u;
+    hash = HashBytes(hash, &gameState->currentState, sizeof(gameState->currentState));
+    hash = HashBytes(hash, &gameState->currentLevel, sizeof(gameState->currentLevel));
+    hash = HashBytes(hash, &gameState->isPaused, sizeof(gameState->isPaused));
+    hash = HashBytes(hash, &gameState->world.liveCount, sizeof(gameState->world.liveCount));
+
+    const Player* player = gameState->player;
+    hash = HashBytes(hash, &player->position, sizeof(player->position));
+    hash = HashBytes(hash, &player->velocity, sizeof(player->velocity));
+    hash = HashBytes(hash, &player->direction, sizeof(player->direction));
+    hash = HashBytes(hash, &player->stats, sizeof(player->stats));
+
+    const EnemyPool* pool = &gameState->enemyPool;
+    hash = HashBytes(hash, &pool->used, sizeof(pool->used));
+    hash = HashBytes(hash, &pool->liveCount, sizeof(pool->liveCount));
+    if (pool->used > 0) {
+        hash = HashBytes(hash, pool->positionX, pool->used * sizeof(float));
+        hash = HashBytes(hash, pool->positionZ, pool->used * sizeof(float));
+        hash = HashBytes(hash, pool->state, pool->used * sizeof(int));
+    }
+
+    const Inventory* inventory = &player->inventory;
+    int equipped[] = { inventory->itemCount, inventory->equippedWeapon, inventory->equippedArmor,
+                       inventory->equippedAccessory };
+    hash = HashBytes(hash, equipped, sizeof(equipped));
+    for (int i = 0; i < inventory->itemCount; i++) {
+        hash = HashItem(hash, &inventory->items[i]);
+    }
+
+    World* world = &gameState->world;
+    const ItemComponent* items = (const ItemComponent*)GetComponentArray(world, COMPONENT_ITEM);
+    int itemCount = GetComponentCount(world, COMPONENT_ITEM);
+    hash = HashBytes(hash, &itemCount, sizeof(itemCount));
+    for (int i = 0; i < itemCount; i++) {
+        hash = HashItem(hash, &items[i]);
+    }
+
+    for (Query query = BeginQuery(world, WITH_TRANSFORM | WITH_PROJECTILE); QueryNext(&query);) {
+        const WorldTransform* transform = (const WorldTransform*)GetComponent(world, query.entity, COMPONENT_TRANSFORM);
+        const Projectile* projectile = (const Projectile*)GetComponent(world, query.entity, COMPONENT_PROJECTILE);
+        hash = HashBytes(hash, &transform->position, sizeof(transform->position));
+        hash = HashBytes(hash, projectile, sizeof(Projectile));
+    }
+    return hash;
+}
@@ -0,0 +1,87 @@
+#include "../include/resolution.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <math.h>
+#include <string.h>
+
+// Apply a scale, keeping the render area at even pixel sizes
+static void SetResolutionScale(DynamicResolution* resolution, float scale) {
+    resolution->scale = Clamp(scale, RES_MIN_SCALE, RES_MAX_SCALE);
+    resolution->renderWidth = ((int)(resolution->fullWidth * resolution->scale)) & ~1;
+    resolution->renderHeight = ((int)(resolution->fullHeight * resolution->scale)) & ~1;
+    resolution->framesOverBudget = 0;
+    resolution->framesUnderBudget = 0;
+}
+
+// Create the full-size scene target and start at full resolution
+void InitDynamicResolution(DynamicResolution* resolution, int width, int height, int targetFps) {
+    memset(resolution, 0, sizeof(DynamicResolution));
+    resolution->fullWidth = width;
+    resolution->fullHeight = height;
+    resolution->targetFrameTime = 1.0f / (float)targetFps;
+    resolution->averageFrameTime = resolution->targetFrameTime * RES_UP_THRESHOLD;
+
+    resolution->target = LoadRenderTexture(width, height);
+    SetTextureFilter(resolution->target.texture, TEXTURE_FILTER_BILINEAR);
+
+    SetResolutionScale(resolution, RES_MAX_SCALE);
+}
+
+// Free the scene target
+void UnloadDynamicResolution(DynamicResolution* resolution) {
+    UnloadRenderTexture(resolution->target);
+    memset(resolution, 0, sizeof(DynamicResolution));
+}
+
+// Feed one frame's timings to the controller. frameTime is the full frame
+// interval, which is clamped to the budget by the frame limiter; busyTime
+// is the part spent working, which shows how much headroom is left.
+void UpdateDynamicResolution(DynamicResolution* resolution, float frameTime, float busyTime) {
+    float budget = resolution->targetFrameTime;
+
+    // A frame that overran the budget is a real miss, whatever the CPU saw
+    float sample = (frameTime > budget * 1.05f) ? frameTime : busyTime;
+    resolution->averageFrameTime += (sample - resolution->averageFrameTime) * RES_SMOOTHING;
+    float average = resolution->averageFrameTime;
+
+    // Separate thresholds and frame counts either way keep the scale from
+    // oscillating around the budget
+    if (average > budget * RES_DOWN_THRESHOLD) {
+        resolution->framesUnderBudget = 0;
+        if (++resolution->framesOverBudget < RES_DOWN_FRAMES || resolution->scale <= RES_MIN_SCALE) return;
+
+        // Pixel cost goes with the square of the scale
+        float wanted = resolution->scale * sqrtf(budget * RES_DOWN_THRESHOLD / average);
+        SetResolutionScale(resolution, fmaxf(wanted, resolution->scale - RES_MAX_STEP));
+    } else if (average < budget * RES_UP_THRESHOLD) {
+        resolution->framesOverBudget = 0;
+        if (++resolution->framesUnderBudget < RES_UP_FRAMES || resolution->scale >= RES_MAX_SCALE) return;
+
+        SetResolutionScale(resolution, resolution->scale + RES_UP_STEP);
+    } else {
+        resolution->framesOverBudget = 0;
+        resolution->framesUnderBudget = 0;
+    }
+}
+
+// Start drawing the 3D scene into the scaled area of the offscreen target.
+// The 2D projection still spans the full size, so screen-space overlays
+// drawn here land in the right place at any scale.
+void BeginSceneRender(DynamicResolution* resolution) {
+    BeginTextureMode(resolution->target);
+    rlViewport(0, 0, resolution->renderWidth, resolution->renderHeight);
+}
+
+// Finish drawing the scene
+void EndSceneRender(DynamicResolution* resolution) {
+    (void)resolution;
+    EndTextureMode();
+}
+
+// Stretch the rendered area over the whole screen, ready for the HUD
+void DrawSceneUpscaled(DynamicResolution* resolution) {
+    // Render textures are stored bottom-up, so flip the source vertically
+    Rectangle source = { 0.0f, 0.0f, (float)resolution->renderWidth, -(float)resolution->renderHeight };
+    Rectangle dest = { 0.0f, 0.0f, (float)GetScreenWidth(), (float)GetScreenHeight() };
+    DrawTexturePro(resolution->target.texture, source, dest, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+}
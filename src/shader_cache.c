@@ -0,0 +1,253 @@
+#define _GNU_SOURCE
+#include "../include/shader_cache.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+#define SHADER_CACHE_MAGIC 0x42485343u  // "CSHB"
+#define SHADER_CACHE_VERSION 1
+
+// GL enums raylib does not expose
+#define GL_VENDOR 0x1F00
+#define GL_RENDERER 0x1F01
+#define GL_VERSION 0x1F02
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_LINK_STATUS 0x8B82
+
+// GL entry points for program binaries. raylib does not wrap them, so
+// they are looked up in the GL library the game links against.
+typedef void (*GetProgramBinaryProc)(unsigned int, int, int*, unsigned int*, void*);
+typedef void (*ProgramBinaryProc)(unsigned int, unsigned int, const void*, int);
+typedef void (*GetProgramivProc)(unsigned int, unsigned int, int*);
+typedef unsigned int (*CreateProgramProc)(void);
+typedef void (*GetIntegervProc)(unsigned int, int*);
+typedef const unsigned char* (*GetStringProc)(unsigned int);
+
+// Header of a cached program, followed by the binary
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t hash;
+    uint32_t format;
+    uint32_t length;
+} ShaderCacheHeader;
+
+static GetProgramBinaryProc getProgramBinary = NULL;
+static ProgramBinaryProc programBinary = NULL;
+static GetProgramivProc getProgramiv = NULL;
+static CreateProgramProc createProgram = NULL;
+static bool binariesSupported = false;
+static uint32_t driverHash = 0;
+
+// Pipeline warm-up resources, created on first use
+static Mesh warmupMesh = { 0 };
+static Material warmupMaterial = { 0 };
+static RenderTexture2D warmupTarget = { 0 };
+
+// FNV-1a over a string, continuing from a previous hash
+static uint32_t HashString(uint32_t hash, const char* text) {
+    if (text == NULL) text = "";
+    for (const char* c = text; *c != '\0'; c++) {
+        hash ^= (unsigned char)*c;
+        hash *= 16777619u;
+    }
+    // Separate consecutive strings
+    hash ^= 0xFF;
+    hash *= 16777619u;
+    return hash;
+}
+
+// Resolve the program binary entry points and check the driver offers
+// at least one binary format - call once after the window is created
+void InitShaderCache(void) {
+    getProgramBinary = (GetProgramBinaryProc)dlsym(RTLD_DEFAULT, "glGetProgramBinary");
+    programBinary = (ProgramBinaryProc)dlsym(RTLD_DEFAULT, "glProgramBinary");
+    getProgramiv = (GetProgramivProc)dlsym(RTLD_DEFAULT, "glGetProgramiv");
+    createProgram = (CreateProgramProc)dlsym(RTLD_DEFAULT, "glCreateProgram");
+    GetIntegervProc getIntegerv = (GetIntegervProc)dlsym(RTLD_DEFAULT, "glGetIntegerv");
+    GetStringProc getString = (GetStringProc)dlsym(RTLD_DEFAULT, "glGetString");
+
+    int formats = 0;
+    if (getIntegerv != NULL) getIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    binariesSupported = getProgramBinary != NULL && programBinary != NULL && getProgramiv != NULL &&
+                        createProgram != NULL && getString != NULL && formats > 0;
+
+    // Binaries are only valid for the driver that produced them
+    if (binariesSupported) {
+        driverHash = 2166136261u;
+        driverHash = HashString(driverHash, (const char*)getString(GL_VENDOR));
+        driverHash = HashString(driverHash, (const char*)getString(GL_RENDERER));
+        driverHash = HashString(driverHash, (const char*)getString(GL_VERSION));
+    }
+
+    TraceLog(LOG_INFO, "SHADERS: Program binary cache %s", binariesSupported ? "enabled" : "unavailable");
+}
+
+// Free the warm-up resources
+void UnloadShaderCache(void) {
+    if (warmupMesh.vaoId != 0) UnloadMesh(warmupMesh);
+    if (warmupTarget.id != 0) UnloadRenderTexture(warmupTarget);
+    // The material only borrows shaders, so just free its maps
+    MemFree(warmupMaterial.maps);
+
+    warmupMesh = (Mesh){ 0 };
+    warmupMaterial = (Material){ 0 };
+    warmupTarget = (RenderTexture2D){ 0 };
+}
+
+// Path of a program's cache file
+static void GetShaderCachePath(uint32_t hash, char* path, int size) {
+    snprintf(path, size, "%s/%08x.bin", SHADER_CACHE_DIR, hash);
+}
+
+// Look up the locations raylib fills in for every shader it loads
+static void SetDefaultShaderLocations(Shader* shader) {
+    for (int i = 0; i < SHADER_CACHE_MAX_LOCATIONS; i++) shader->locs[i] = -1;
+
+    shader->locs[SHADER_LOC_VERTEX_POSITION] = rlGetLocationAttrib(shader->id, "vertexPosition");
+    shader->locs[SHADER_LOC_VERTEX_TEXCOORD01] = rlGetLocationAttrib(shader->id, "vertexTexCoord");
+    shader->locs[SHADER_LOC_VERTEX_TEXCOORD02] = rlGetLocationAttrib(shader->id, "vertexTexCoord2");
+    shader->locs[SHADER_LOC_VERTEX_NORMAL] = rlGetLocationAttrib(shader->id, "vertexNormal");
+    shader->locs[SHADER_LOC_VERTEX_TANGENT] = rlGetLocationAttrib(shader->id, "vertexTangent");
+    shader->locs[SHADER_LOC_VERTEX_COLOR] = rlGetLocationAttrib(shader->id, "vertexColor");
+
+    shader->locs[SHADER_LOC_MATRIX_MVP] = rlGetLocationUniform(shader->id, "mvp");
+    shader->locs[SHADER_LOC_MATRIX_VIEW] = rlGetLocationUniform(shader->id, "matView");
+    shader->locs[SHADER_LOC_MATRIX_PROJECTION] = rlGetLocationUniform(shader->id, "matProjection");
+    shader->locs[SHADER_LOC_MATRIX_MODEL] = rlGetLocationUniform(shader->id, "matModel");
+    shader->locs[SHADER_LOC_MATRIX_NORMAL] = rlGetLocationUniform(shader->id, "matNormal");
+
+    shader->locs[SHADER_LOC_COLOR_DIFFUSE] = rlGetLocationUniform(shader->id, "colDiffuse");
+    shader->locs[SHADER_LOC_MAP_DIFFUSE] = rlGetLocationUniform(shader->id, "texture0");
+    shader->locs[SHADER_LOC_MAP_SPECULAR] = rlGetLocationUniform(shader->id, "texture1");
+    shader->locs[SHADER_LOC_MAP_NORMAL] = rlGetLocationUniform(shader->id, "texture2");
+}
+
+// Link a program from a cached binary. Returns an empty shader if there
+// is no valid binary or the driver rejects it.
+static Shader LoadCachedProgram(uint32_t hash) {
+    Shader shader = { 0 };
+    char path[256];
+    GetShaderCachePath(hash, path, sizeof(path));
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return shader;
+
+    ShaderCacheHeader header;
+    void* binary = NULL;
+    if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == SHADER_CACHE_MAGIC &&
+        header.version == SHADER_CACHE_VERSION && header.hash == hash && header.length > 0) {
+        binary = malloc(header.length);
+        if (binary != NULL && fread(binary, 1, header.length, file) != header.length) {
+            free(binary);
+            binary = NULL;
+        }
+    }
+    fclose(file);
+    if (binary == NULL) return shader;
+
+    unsigned int program = createProgram();
+    programBinary(program, header.format, binary, (int)header.length);
+    free(binary);
+
+    int linked = 0;
+    getProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        rlUnloadShaderProgram(program);
+        TraceLog(LOG_INFO, "SHADERS: Cached binary %08x rejected by the driver, recompiling", hash);
+        return shader;
+    }
+
+    shader.id = program;
+    shader.locs = (int*)MemAlloc(SHADER_CACHE_MAX_LOCATIONS * sizeof(int));
+    SetDefaultShaderLocations(&shader);
+    return shader;
+}
+
+// Create a directory unless it already exists
+static bool EnsureDirectory(const char* path) {
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+// Save a linked program's binary, written under a temporary name and
+// renamed so a reader never sees half of it
+static void StoreCachedProgram(unsigned int program, uint32_t hash) {
+    int length = 0;
+    getProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    void* binary = malloc(length);
+    if (binary == NULL) return;
+    unsigned int format = 0;
+    getProgramBinary(program, length, &length, &format, binary);
+
+    char directory[sizeof(SHADER_CACHE_DIR)];
+    snprintf(directory, sizeof(directory), "%s", SHADER_CACHE_DIR);
+    for (char* slash = strchr(directory, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        EnsureDirectory(directory);
+        *slash = '/';
+    }
+
+    char path[256];
+    char temporary[264];
+    GetShaderCachePath(hash, path, sizeof(path));
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+
+    FILE* file = EnsureDirectory(directory) ? fopen(temporary, "wb") : NULL;
+    if (file != NULL) {
+        ShaderCacheHeader header = { SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, hash, format, (uint32_t)length };
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(binary, 1, length, file) == (size_t)length;
+        ok = (fclose(file) == 0) && ok;
+        if (!ok || rename(temporary, path) != 0) remove(temporary);
+    }
+    free(binary);
+}
+
+// Build a shader program from source, or from its cached binary when the
+// same sources were linked by the same driver before. A NULL source
+// selects raylib's default stage, as with LoadShaderFromMemory.
+Shader LoadShaderCached(const char* vsCode, const char* fsCode) {
+    if (!binariesSupported) return LoadShaderFromMemory(vsCode, fsCode);
+
+    uint32_t hash = HashString(HashString(driverHash, vsCode), fsCode);
+    Shader shader = LoadCachedProgram(hash);
+    if (shader.id != 0) {
+        TraceLog(LOG_INFO, "SHADERS: Program %08x loaded from binary cache", hash);
+        return shader;
+    }
+
+    double start = GetTime();
+    shader = LoadShaderFromMemory(vsCode, fsCode);
+
+    // A failed build falls back to the default program - never cache that
+    if (shader.id != 0 && shader.id != rlGetShaderIdDefault()) {
+        StoreCachedProgram(shader.id, hash);
+        TraceLog(LOG_INFO, "SHADERS: Program %08x compiled in %.1f ms and cached", hash, (GetTime() - start) * 1000.0);
+    }
+    return shader;
+}
+
+// Draw a tiny mesh offscreen with a shader so the driver finishes any
+// compile work it defers until first use
+void WarmUpShader(Shader shader) {
+    if (shader.id == 0) return;
+
+    if (warmupTarget.id == 0) {
+        warmupTarget = LoadRenderTexture(4, 4);
+        warmupMesh = GenMeshPlane(1.0f, 1.0f, 1, 1);
+        warmupMaterial = LoadMaterialDefault();
+    }
+
+    warmupMaterial.shader = shader;
+    BeginTextureMode(warmupTarget);
+        DrawMesh(warmupMesh, warmupMaterial, MatrixIdentity());
+    EndTextureMode();
+}
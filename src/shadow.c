@@ -0,0 +1,204 @@
+#include "../include/shadow.h"
+#include "../include/lightmap.h"
+#include "../include/jobs.h"
+#include "raymath.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Check if a caster touches a torch's light radius
+static bool CasterInLight(const TorchLight* torch, const ShadowCaster* caster) {
+    float dx = caster->position.x - torch->tileX;
+    float dz = caster->position.z - torch->tileY;
+    float reach = torch->radius + caster->radius;
+    return dx*dx + dz*dz < reach * reach;
+}
+
+// Check if a caster sits between the light and a tile centre
+static bool CasterBlocksTile(float lightX, float lightY, float tileX, float tileY, const ShadowCaster* caster) {
+    float dirX = tileX - lightX;
+    float dirY = tileY - lightY;
+    float lengthSq = dirX*dirX + dirY*dirY;
+    if (lengthSq <= 0.0f) return false;
+
+    // A caster never shadows the tile it is standing on
+    float toTileX = tileX - caster->position.x;
+    float toTileY = tileY - caster->position.z;
+    if (toTileX*toTileX + toTileY*toTileY < 0.25f) return false;
+
+    // Closest point on the light ray to the caster
+    float relX = caster->position.x - lightX;
+    float relY = caster->position.z - lightY;
+    float t = (relX*dirX + relY*dirY) / lengthSq;
+    if (t <= 0.0f || t >= 1.0f) return false;
+
+    float offX = relX - dirX * t;
+    float offY = relY - dirY * t;
+    return offX*offX + offY*offY < caster->radius * caster->radius;
+}
+
+// Zero the dynamic shadow term inside a light's window
+static void ClearShadowWindow(Dungeon* dungeon, TorchShadowMap* map) {
+    for (int i = 0; i < map->size; i++) {
+        int x = map->originX + i;
+        if (x < 0 || x >= dungeon->width) continue;
+
+        for (int j = 0; j < map->size; j++) {
+            int y = map->originY + j;
+            if (y < 0 || y >= dungeon->height) continue;
+            dungeon->dynamicShadow[x * dungeon->height + y] = (Vector3){0.0f, 0.0f, 0.0f};
+        }
+    }
+}
+
+// Render the dynamic casters of one light over its cached static map
+static void RenderDynamicCasters(Dungeon* dungeon, int torchIndex, const ShadowCaster* casters, int casterCount) {
+    TorchLight* torch = &dungeon->torches[torchIndex];
+    TorchShadowMap* map = &dungeon->torchShadows[torchIndex];
+
+    // Gather the casters inside this light's radius
+    const ShadowCaster* local[SHADOW_MAX_CASTERS_PER_LIGHT];
+    int localCount = 0;
+    for (int c = 0; c < casterCount && localCount < SHADOW_MAX_CASTERS_PER_LIGHT; c++) {
+        if (CasterInLight(torch, &casters[c])) {
+            local[localCount++] = &casters[c];
+        }
+    }
+
+    float r = torch->color.r / 255.0f;
+    float g = torch->color.g / 255.0f;
+    float b = torch->color.b / 255.0f;
+
+    for (int i = 0; i < map->size; i++) {
+        for (int j = 0; j < map->size; j++) {
+            // Tiles the walls already shadow have nothing left to block
+            float amount = dungeon->shadowAtlas[map->atlasOffset + i * map->size + j];
+            if (amount <= 0.0f) continue;
+
+            int x = map->originX + i;
+            int y = map->originY + j;
+
+            for (int c = 0; c < localCount; c++) {
+                if (CasterBlocksTile(torch->tileX, torch->tileY, x, y, local[c])) {
+                    Vector3* shadow = &dungeon->dynamicShadow[x * dungeon->height + y];
+                    shadow->x += amount * r;
+                    shadow->y += amount * g;
+                    shadow->z += amount * b;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Shadow map job - store the light that gets past the walls for each tile
+// of a range of torches' windows. Windows sit apart in the atlas, so jobs
+// never write the same cell.
+static void RenderStaticShadows(void* context, int begin, int end) {
+    Dungeon* dungeon = (Dungeon*)context;
+
+    for (int i = begin; i < end; i++) {
+        TorchLight* torch = &dungeon->torches[i];
+        TorchShadowMap* map = &dungeon->torchShadows[i];
+
+        for (int wx = 0; wx < map->size; wx++) {
+            for (int wy = 0; wy < map->size; wy++) {
+                int x = map->originX + wx;
+                int y = map->originY + wy;
+                float amount = 0.0f;
+
+                if (x >= 0 && x < dungeon->width && y >= 0 && y < dungeon->height &&
+                    dungeon->tiles[x][y] != TILE_WALL && dungeon->tiles[x][y] != TILE_NONE) {
+                    amount = TorchLightAmount(torch, x, y);
+                    if (amount > 0.0f && !TileLineOfSight(dungeon, torch->tileX, torch->tileY, x, y)) {
+                        amount = 0.0f;
+                    }
+                }
+
+                dungeon->shadowAtlas[map->atlasOffset + wx * map->size + wy] = amount;
+            }
+        }
+    }
+}
+
+// Build the cached static shadow map of every torch
+void BuildTorchShadowMaps(Dungeon* dungeon) {
+    double startTime = GetTime();
+
+    UnloadTorchShadowMaps(dungeon);
+    if (dungeon->torchCount == 0) return;
+
+    dungeon->torchShadows = (TorchShadowMap*)malloc(dungeon->torchCount * sizeof(TorchShadowMap));
+    dungeon->dynamicShadow = (Vector3*)calloc(dungeon->width * dungeon->height, sizeof(Vector3));
+
+    // Lay every light's window out in a single atlas
+    int atlasSize = 0;
+    for (int i = 0; i < dungeon->torchCount; i++) {
+        TorchLight* torch = &dungeon->torches[i];
+        TorchShadowMap* map = &dungeon->torchShadows[i];
+        int reach = (int)ceilf(torch->radius);
+
+        map->originX = torch->tileX - reach;
+        map->originY = torch->tileY - reach;
+        map->size = reach * 2 + 1;
+        map->atlasOffset = atlasSize;
+        map->dynamicActive = false;
+        atlasSize += map->size * map->size;
+    }
+
+    dungeon->shadowAtlas = (float*)malloc(atlasSize * sizeof(float));
+    dungeon->shadowAtlasSize = atlasSize;
+
+    // Static pass, a torch at a time across the job system
+    ParallelFor(dungeon->torchCount, 1, RenderStaticShadows, dungeon);
+
+    TraceLog(LOG_INFO, "SHADOW: Cached %d torch shadow maps (%d atlas cells) in %.2f ms",
+             dungeon->torchCount, atlasSize, (GetTime() - startTime) * 1000.0);
+}
+
+// Free the shadow atlas and the dynamic shadow buffer
+void UnloadTorchShadowMaps(Dungeon* dungeon) {
+    free(dungeon->torchShadows);
+    free(dungeon->shadowAtlas);
+    free(dungeon->dynamicShadow);
+    dungeon->torchShadows = NULL;
+    dungeon->shadowAtlas = NULL;
+    dungeon->dynamicShadow = NULL;
+    dungeon->shadowAtlasSize = 0;
+}
+
+// Re-render dynamic casters for lights that contain one
+int UpdateTorchShadows(Dungeon* dungeon, const ShadowCaster* casters, int casterCount) {
+    if (dungeon->torchShadows == NULL) return 0;
+
+    // Clear the windows of lights that had casters last update or have one now.
+    // All clears happen before any rendering so overlapping lights stay correct.
+    for (int i = 0; i < dungeon->torchCount; i++) {
+        TorchShadowMap* map = &dungeon->torchShadows[i];
+        bool active = false;
+
+        for (int c = 0; c < casterCount; c++) {
+            if (CasterInLight(&dungeon->torches[i], &casters[c])) {
+                active = true;
+                break;
+            }
+        }
+
+        if (active || map->dynamicActive) {
+            ClearShadowWindow(dungeon, map);
+        }
+        map->dynamicActive = active;
+    }
+
+    // Render the casters of every active light
+    int updated = 0;
+    for (int i = 0; i < dungeon->torchCount; i++) {
+        if (dungeon->torchShadows[i].dynamicActive) {
+            RenderDynamicCasters(dungeon, i, casters, casterCount);
+            updated++;
+        }
+    }
+
+    return updated;
+}
@@ -0,0 +1,303 @@
+#include "../include/sim.h"
+#include "../include/dungeon_props.h"
+#include "../include/lightmap.h"
+#include "../include/systems.h"
+#include "raymath.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Blend two angles in degrees along the shortest arc
+static float LerpAngleDegrees(float from, float to, float t) {
+    float delta = fmodf(to - from + 540.0f, 360.0f) - 180.0f;
+    return from + delta * t;
+}
+
+// Blend two positions, snapping instead when the entity teleported
+static Vector3 LerpPosition(Vector3 from, Vector3 to, float t) {
+    if (Vector3Distance(from, to) > SIM_SNAP_DISTANCE) return to;
+    return Vector3Lerp(from, to, t);
+}
+
+// Grow a snapshot array to hold count elements. Returns false, leaving
+// the array as it was, when out of memory.
+static bool ReserveSnapshotArray(void** array, int* capacity, int count, size_t size) {
+    if (count <= *capacity) return true;
+
+    int grown = (*capacity > 0) ? *capacity : 64;
+    while (grown < count) grown *= 2;
+    void* resized = realloc(*array, grown * size);
+    if (resized == NULL) return false;
+    *array = resized;
+    *capacity = grown;
+    return true;
+}
+
+// Start with the renderer holding slots 0 and 1, slot 2 waiting (but not
+// fresh) and the simulation writing slot 3
+void InitSimClock(SimClock* clock) {
+    memset(clock, 0, sizeof(SimClock));
+    clock->drawn[0] = 0;
+    clock->drawn[1] = 1;
+    atomic_init(&clock->ready, 2);
+    clock->writing = 3;
+    pthread_mutex_init(&clock->mailbox, NULL);
+}
+
+// Free snapshot storage - both threads must be done with the clock
+void UnloadSimClock(SimClock* clock) {
+    for (int i = 0; i < SIM_SNAPSHOT_COUNT; i++) {
+        SimSnapshot* snapshot = &clock->snapshots[i];
+        free(snapshot->inventory);
+        free(snapshot->tiles);
+        free(snapshot->tileColumns);
+        free(snapshot->light);
+        free(snapshot->torches);
+        UnloadSceneList(&snapshot->scene);
+    }
+    pthread_mutex_destroy(&clock->mailbox);
+    memset(clock, 0, sizeof(SimClock));
+}
+
+// Add the time elapsed since the last call and return how many fixed
+// ticks are due
+int AdvanceSimClock(SimClock* clock, float elapsed) {
+    clock->accumulator += elapsed;
+
+    // Drop time rather than falling further behind after a long stall
+    double maxBacklog = SIM_MAX_TICKS_PER_FRAME * (double)SIM_TICK_TIME;
+    if (clock->accumulator > maxBacklog) {
+        clock->accumulator = maxBacklog;
+    }
+
+    int ticks = (int)(clock->accumulator / SIM_TICK_TIME);
+    clock->accumulator -= ticks * (double)SIM_TICK_TIME;
+
+    return ticks;
+}
+
+// Copy the level as drawn: tiles, their lighting with this tick's
+// shadows, torches and the shared models. Everything else the level
+// points at stays with the simulation.
+static void CaptureLevel(SimSnapshot* snapshot, Dungeon* dungeon) {
+    Dungeon* level = &snapshot->level;
+    *level = *dungeon;
+    level->tiles = NULL;
+    level->rooms = NULL;
+    level->roomCount = 0;
+    level->torches = NULL;
+    level->torchCount = 0;
+    level->bakedLight = NULL;
+    level->torchShadows = NULL;
+    level->shadowAtlas = NULL;
+    level->dynamicShadow = NULL;
+    level->navGraph = NULL;
+    level->assetCount = 0;
+
+    int tileCount = dungeon->width * dungeon->height;
+    if (dungeon->tiles == NULL || tileCount == 0 ||
+        !ReserveSnapshotArray((void**)&snapshot->tiles, &snapshot->tileCapacity, tileCount, sizeof(TileType)) ||
+        !ReserveSnapshotArray((void**)&snapshot->light, &snapshot->lightCapacity, tileCount, sizeof(Color)) ||
+        !ReserveSnapshotArray((void**)&snapshot->tileColumns, &snapshot->columnCapacity, dungeon->width,
+                              sizeof(TileType*))) {
+        level->width = 0;
+        level->height = 0;
+        return;
+    }
+
+    for (int x = 0; x < dungeon->width; x++) {
+        snapshot->tileColumns[x] = &snapshot->tiles[x * dungeon->height];
+        memcpy(snapshot->tileColumns[x], dungeon->tiles[x], dungeon->height * sizeof(TileType));
+        for (int y = 0; y < dungeon->height; y++) {
+            snapshot->light[x * dungeon->height + y] = GetTileLight(dungeon, x, y);
+        }
+    }
+    level->tiles = snapshot->tileColumns;
+    level->bakedLight = snapshot->light;
+
+    if (dungeon->torchCount > 0 &&
+        ReserveSnapshotArray((void**)&snapshot->torches, &snapshot->torchCapacity, dungeon->torchCount,
+                             sizeof(TorchLight))) {
+        memcpy(snapshot->torches, dungeon->torches, dungeon->torchCount * sizeof(TorchLight));
+        level->torches = snapshot->torches;
+        level->torchCount = dungeon->torchCount;
+    }
+}
+
+// Copy the player with its inventory
+static void CapturePlayer(SimSnapshot* snapshot, Player* player) {
+    snapshot->player = *player;
+    snapshot->player.inventory.items = NULL;
+    snapshot->player.inventory.itemCount = 0;
+
+    int itemCount = player->inventory.itemCount;
+    if (itemCount > 0 &&
+        ReserveSnapshotArray((void**)&snapshot->inventory, &snapshot->inventoryCapacity, itemCount, sizeof(Item))) {
+        memcpy(snapshot->inventory, player->inventory.items, itemCount * sizeof(Item));
+        snapshot->player.inventory.items = snapshot->inventory;
+        snapshot->player.inventory.itemCount = itemCount;
+    }
+}
+
+// Copy what the renderer needs from the state the last tick left, then
+// hand the snapshot over. The slot the renderer last let go of becomes
+// the next one written. Simulation thread only.
+void PublishSimSnapshot(SimClock* clock, GameState* gameState, double time) {
+    SimSnapshot* snapshot = &clock->snapshots[clock->writing];
+    snapshot->time = time;
+
+    // The level and its models only matter while it is being played
+    ClearSceneList(&snapshot->scene);
+    snapshot->awakeEnemies = 0;
+    memset(snapshot->enemyTiers, 0, sizeof(snapshot->enemyTiers));
+    if (gameState->currentState == GAMEPLAY) {
+        CaptureLevel(snapshot, gameState->dungeon);
+        RecordEnemies(&gameState->enemyPool, &snapshot->scene);
+        RecordWorldEntities(&gameState->world, &snapshot->scene);
+        snapshot->awakeEnemies = GetAwakeEnemyCount(&gameState->enemyPool);
+        memcpy(snapshot->enemyTiers, gameState->enemyPool.tierCounts, sizeof(snapshot->enemyTiers));
+    } else {
+        memset(&snapshot->level, 0, sizeof(Dungeon));
+    }
+    CapturePlayer(snapshot, gameState->player);
+
+    // The screens see the game through a copy that leads back only into
+    // this snapshot
+    GameState* view = &snapshot->view;
+    memset(view, 0, sizeof(GameState));
+    view->currentState = gameState->currentState;
+    view->warmup = gameState->warmup;
+    view->screenWidth = gameState->screenWidth;
+    view->screenHeight = gameState->screenHeight;
+    view->player = &snapshot->player;
+    view->dungeon = &snapshot->level;
+    view->director = gameState->director;
+    view->camera = gameState->camera;
+    view->gameTime = gameState->gameTime;
+    view->currentLevel = gameState->currentLevel;
+    view->maxLevel = gameState->maxLevel;
+    view->isPaused = gameState->isPaused;
+
+    int released = atomic_exchange_explicit(&clock->ready, clock->writing | SIM_SNAPSHOT_FRESH, memory_order_acq_rel);
+    clock->writing = released & ~SIM_SNAPSHOT_FRESH;
+}
+
+// Take the newest snapshot if one came in and work out the frame's blend.
+// Frames are drawn a tick behind the simulation, so there is normally a
+// pair to blend between. Returns false until the first snapshot arrives.
+// Renderer only.
+bool TakeSimView(SimClock* clock, double now, SimView* view) {
+    if (atomic_load_explicit(&clock->ready, memory_order_acquire) & SIM_SNAPSHOT_FRESH) {
+        int taken = atomic_exchange_explicit(&clock->ready, clock->drawn[0], memory_order_acq_rel);
+        clock->drawn[0] = clock->drawn[1];
+        clock->drawn[1] = taken & ~SIM_SNAPSHOT_FRESH;
+        if (clock->taken < 2) clock->taken++;
+    }
+    if (clock->taken == 0) return false;
+
+    SimSnapshot* latest = &clock->snapshots[clock->drawn[1]];
+    SimSnapshot* previous = (clock->taken == 2) ? &clock->snapshots[clock->drawn[0]] : latest;
+
+    // Nothing to blend across a level change or a change of screen
+    if (previous->view.currentLevel != latest->view.currentLevel ||
+        previous->view.currentState != latest->view.currentState) {
+        previous = latest;
+    }
+
+    double span = latest->time - previous->time;
+    view->previous = previous;
+    view->latest = latest;
+    view->alpha = (span > 0.0) ? Clamp((float)((now - SIM_TICK_TIME - previous->time) / span), 0.0f, 1.0f) : 1.0f;
+
+    // The camera looks along the blended view direction from its blended position
+    Camera from = previous->view.camera;
+    Camera to = latest->view.camera;
+    Vector3 previousLook = Vector3Subtract(from.target, from.position);
+    Vector3 latestLook = Vector3Subtract(to.target, to.position);
+    view->camera = to;
+    view->camera.position = LerpPosition(from.position, to.position, view->alpha);
+    view->camera.target = Vector3Add(view->camera.position, Vector3Lerp(previousLook, latestLook, view->alpha));
+    return true;
+}
+
+// Find a model's entry in a scene by id, trying the hinted entry first
+// since the order rarely shifts between ticks
+static int FindSceneModel(const SceneList* scene, unsigned int id, int hint) {
+    if (hint >= 0 && hint < scene->count && scene->models[hint].id == id) return hint;
+    for (int i = 0; i < scene->count; i++) {
+        if (scene->models[i].id == id) return i;
+    }
+    return -1;
+}
+
+// Draw the latest snapshot's scene, with each moving model blended from
+// its pose in the previous one. Models that just appeared have no earlier
+// pose and are drawn where they are.
+void DrawInterpolatedScene(const SimView* view, RenderQueue* queue) {
+    const SceneList* from = &view->previous->scene;
+    const SceneList* to = &view->latest->scene;
+    bool blend = (view->previous != view->latest);
+
+    // Collect the scene's draws, then sort and submit them in one pass
+    BeginRenderQueue(queue, view->camera);
+        DrawDungeon(&view->latest->level, queue);
+        DrawDungeonProps(&view->latest->level, queue);
+
+        int offset = 0;
+        for (int i = 0; i < to->count; i++) {
+            const SceneModel* model = &to->models[i];
+            Vector3 position = model->position;
+            float rotation = model->rotation;
+
+            int match = blend ? FindSceneModel(from, model->id, i + offset) : -1;
+            if (match >= 0) {
+                offset = match - i;
+                position = LerpPosition(from->models[match].position, position, view->alpha);
+                rotation = LerpAngleDegrees(from->models[match].rotation, rotation, view->alpha);
+            }
+
+            QueueModel(queue, model->model, position, (Vector3){ 0.0f, 1.0f, 0.0f }, rotation,
+                       (Vector3){ 1.0f, 1.0f, 1.0f }, model->tint);
+            if (model->healthBar > 0.0f) {
+                QueueHealthBar(queue, (Vector3){ position.x, position.y + model->barHeight, position.z },
+                               model->healthBar);
+            }
+        }
+    FlushRenderQueue(queue);
+}
+
+// Latch this frame's device input for the simulation's next tick. Renderer only.
+void PollSimInput(SimClock* clock) {
+    pthread_mutex_lock(&clock->mailbox);
+    PollInput(&clock->pendingInput);
+    pthread_mutex_unlock(&clock->mailbox);
+}
+
+// Take the input latched since the last tick. Simulation thread only.
+InputFrame ConsumeSimInput(SimClock* clock) {
+    pthread_mutex_lock(&clock->mailbox);
+    InputFrame input = ConsumeInput(&clock->pendingInput);
+    pthread_mutex_unlock(&clock->mailbox);
+    return input;
+}
+
+// Pass the last scene's draw time to the simulation for the spawn director.
+// Renderer only.
+void ReportSceneCost(SimClock* clock, float seconds, int enemies) {
+    pthread_mutex_lock(&clock->mailbox);
+    clock->sceneTime = seconds;
+    clock->sceneEnemies = enemies;
+    clock->sceneReported = true;
+    pthread_mutex_unlock(&clock->mailbox);
+}
+
+// Take the scene cost reported since the last call, if any. Simulation
+// thread only.
+bool TakeSceneCost(SimClock* clock, float* seconds, int* enemies) {
+    pthread_mutex_lock(&clock->mailbox);
+    bool reported = clock->sceneReported;
+    *seconds = clock->sceneTime;
+    *enemies = clock->sceneEnemies;
+    clock->sceneReported = false;
+    pthread_mutex_unlock(&clock->mailbox);
+    return reported;
+}
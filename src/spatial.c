@@ -0,0 +1,176 @@
+#include "../include/spatial.h"
+#include "raymath.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Allocate room for capacity entries. Cells are sized per level by
+// BeginSpatialHash.
+void InitSpatialHash(SpatialHash* hash, int capacity) {
+    memset(hash, 0, sizeof(SpatialHash));
+    hash->entries = (SpatialEntry*)malloc(capacity * sizeof(SpatialEntry));
+    hash->pending = (SpatialEntry*)malloc(capacity * sizeof(SpatialEntry));
+    hash->entryCells = (int*)malloc(capacity * sizeof(int));
+    if (hash->entries == NULL || hash->pending == NULL || hash->entryCells == NULL) {
+        TraceLog(LOG_WARNING, "SPATIAL: Failed to allocate %d entries", capacity);
+        return;
+    }
+    hash->capacity = capacity;
+}
+
+// Free the grid and its entries
+void UnloadSpatialHash(SpatialHash* hash) {
+    free(hash->cellStart);
+    free(hash->entries);
+    free(hash->pending);
+    free(hash->entryCells);
+    memset(hash, 0, sizeof(SpatialHash));
+}
+
+// Cell coordinate of a world position along one axis, clamped to the grid
+static int CellCoordinate(float position, int cells) {
+    int cell = (int)floorf(position / SPATIAL_CELL_SIZE);
+    if (cell < 0) return 0;
+    if (cell >= cells) return cells - 1;
+    return cell;
+}
+
+// Start a rebuild over a level of width x height tiles
+void BeginSpatialHash(SpatialHash* hash, int width, int height) {
+    int cellsX = (int)ceilf(width / SPATIAL_CELL_SIZE);
+    int cellsZ = (int)ceilf(height / SPATIAL_CELL_SIZE);
+    if (cellsX < 1) cellsX = 1;
+    if (cellsZ < 1) cellsZ = 1;
+
+    // The cell table is kept across levels and only grows
+    if (cellsX * cellsZ > hash->cellCapacity) {
+        free(hash->cellStart);
+        hash->cellStart = (int*)malloc((cellsX * cellsZ + 1) * sizeof(int));
+        hash->cellCapacity = (hash->cellStart != NULL) ? cellsX * cellsZ : 0;
+    }
+    hash->cellsX = cellsX;
+    hash->cellsZ = cellsZ;
+    hash->count = 0;
+}
+
+// File an entity for this tick. Entities past capacity are dropped.
+void InsertSpatialEntity(SpatialHash* hash, Entity entity, Vector3 position, unsigned kind) {
+    if (hash->count >= hash->capacity) return;
+    hash->pending[hash->count++] = (SpatialEntry){ entity, position, kind };
+}
+
+// Bucket the inserted entries by cell. Counting sort: count per cell,
+// prefix-sum into offsets, then scatter.
+void EndSpatialHash(SpatialHash* hash) {
+    int cellCount = hash->cellsX * hash->cellsZ;
+    if (hash->cellStart == NULL) return;
+    memset(hash->cellStart, 0, (cellCount + 1) * sizeof(int));
+
+    for (int i = 0; i < hash->count; i++) {
+        Vector3 position = hash->pending[i].position;
+        int cell = CellCoordinate(position.z, hash->cellsZ) * hash->cellsX + CellCoordinate(position.x, hash->cellsX);
+        hash->entryCells[i] = cell;
+        hash->cellStart[cell + 1]++;
+    }
+    for (int cell = 0; cell < cellCount; cell++) {
+        hash->cellStart[cell + 1] += hash->cellStart[cell];
+    }
+
+    // Scatter, using the cell starts as cursors; each ends up at the next
+    // cell's start, so shift them back one
+    for (int i = 0; i < hash->count; i++) {
+        hash->entries[hash->cellStart[hash->entryCells[i]]++] = hash->pending[i];
+    }
+    for (int cell = cellCount; cell > 0; cell--) {
+        hash->cellStart[cell] = hash->cellStart[cell - 1];
+    }
+    hash->cellStart[0] = 0;
+}
+
+// Shape tests applied to each entry in the cells a query overlaps
+typedef enum {
+    SPATIAL_SHAPE_RADIUS,
+    SPATIAL_SHAPE_CONE,
+    SPATIAL_SHAPE_BOX
+} SpatialShape;
+
+typedef struct {
+    SpatialShape shape;
+    Vector3 origin;
+    Vector3 direction;
+    float rangeSquared;
+    float minDot;
+    Vector2 min;
+    Vector2 max;
+} SpatialTest;
+
+static bool PassesSpatialTest(const SpatialTest* test, Vector3 position) {
+    switch (test->shape) {
+        case SPATIAL_SHAPE_RADIUS:
+            return Vector3DistanceSqr(position, test->origin) <= test->rangeSquared;
+
+        case SPATIAL_SHAPE_CONE: {
+            Vector3 offset = Vector3Subtract(position, test->origin);
+            float distanceSquared = Vector3LengthSqr(offset);
+            if (distanceSquared > test->rangeSquared) return false;
+            return Vector3DotProduct(test->direction, offset) > test->minDot * sqrtf(distanceSquared);
+        }
+
+        default:
+            return position.x >= test->min.x && position.x <= test->max.x &&
+                   position.z >= test->min.y && position.z <= test->max.y;
+    }
+}
+
+// Gather the entries of the given kinds in the cells covering [min, max]
+// that pass the test. Returns the number of handles written.
+static int QueryCells(const SpatialHash* hash, Vector2 min, Vector2 max, unsigned kind, const SpatialTest* test,
+                      Entity* results, int maxResults) {
+    if (hash->cellStart == NULL) return 0;
+
+    int minX = CellCoordinate(min.x, hash->cellsX);
+    int maxX = CellCoordinate(max.x, hash->cellsX);
+    int minZ = CellCoordinate(min.y, hash->cellsZ);
+    int maxZ = CellCoordinate(max.y, hash->cellsZ);
+
+    int found = 0;
+    for (int z = minZ; z <= maxZ; z++) {
+        for (int x = minX; x <= maxX; x++) {
+            int cell = z * hash->cellsX + x;
+            for (int i = hash->cellStart[cell]; i < hash->cellStart[cell + 1]; i++) {
+                const SpatialEntry* entry = &hash->entries[i];
+                if (!(entry->kind & kind) || !PassesSpatialTest(test, entry->position)) continue;
+                if (found >= maxResults) return found;
+                results[found++] = entry->entity;
+            }
+        }
+    }
+    return found;
+}
+
+// Entities within radius of a point
+int QuerySpatialRadius(const SpatialHash* hash, Vector3 center, float radius, unsigned kind,
+                       Entity* results, int maxResults) {
+    SpatialTest test = { .shape = SPATIAL_SHAPE_RADIUS, .origin = center, .rangeSquared = radius * radius };
+    return QueryCells(hash, (Vector2){ center.x - radius, center.z - radius },
+                      (Vector2){ center.x + radius, center.z + radius }, kind, &test, results, maxResults);
+}
+
+// Entities within range of origin whose direction from it has a dot
+// product above minDot with the unit direction - the cosine of the
+// cone's half angle
+int QuerySpatialCone(const SpatialHash* hash, Vector3 origin, Vector3 direction, float range, float minDot,
+                     unsigned kind, Entity* results, int maxResults) {
+    SpatialTest test = { .shape = SPATIAL_SHAPE_CONE, .origin = origin, .direction = direction,
+                         .rangeSquared = range * range, .minDot = minDot };
+    return QueryCells(hash, (Vector2){ origin.x - range, origin.z - range },
+                      (Vector2){ origin.x + range, origin.z + range }, kind, &test, results, maxResults);
+}
+
+// Entities inside an axis-aligned box on the floor plane, given as x/z
+// minimum and maximum corners
+int QuerySpatialBox(const SpatialHash* hash, Vector2 min, Vector2 max, unsigned kind,
+                    Entity* results, int maxResults) {
+    SpatialTest test = { .shape = SPATIAL_SHAPE_BOX, .min = min, .max = max };
+    return QueryCells(hash, min, max, kind, &test, results, maxResults);
+}
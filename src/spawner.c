@@ -0,0 +1,262 @@
+#include "../include/spawner.h"
+#include "raymath.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SPAWN_ATTEMPTS_PER_ROOM 16      // Rejected tiles tolerated before a room gives up
+
+// Allocate one hot array per field, 16-byte aligned so the update
+// kernels can load four slots at a time
+static void* AllocateHotArray(int capacity) {
+    size_t bytes = (size_t)capacity * sizeof(float);
+    void* array = aligned_alloc(16, bytes);
+    if (array != NULL) memset(array, 0, bytes);
+    return array;
+}
+
+// Mark slots [0, count) empty. Dormant is zero, so cleared memory alone
+// would read as a pool full of sleeping enemies.
+static void MarkSlotsDead(EnemyPool* pool, int count) {
+    for (int i = 0; i < count; i++) {
+        pool->state[i] = ENEMY_DEAD;
+        pool->attacking[i] = 0;
+        pool->stepTime[i] = 0.0f;
+    }
+}
+
+// Allocate every slot the pool will ever hand out, and take references to
+// the archetype models the enemies share. Capacity is rounded up to whole
+// kernel batches. Each live enemy also gets an entity in the world.
+void InitEnemyPool(EnemyPool* pool, int capacity, World* world) {
+    memset(pool, 0, sizeof(EnemyPool));
+    pool->world = world;
+    capacity = (capacity + ENEMY_SIMD_WIDTH - 1) / ENEMY_SIMD_WIDTH * ENEMY_SIMD_WIDTH;
+    
+    float** floatArrays[] = {
+        &pool->positionX, &pool->positionY, &pool->positionZ, &pool->velocityX, &pool->velocityZ,
+        &pool->directionX, &pool->directionZ, &pool->rotation, &pool->attackTimer, &pool->pathfindTimer,
+        &pool->stateTimer, &pool->animTimer, &pool->speed, &pool->attackRange, &pool->detectionRange,
+        &pool->attackCooldown, &pool->stepTime, &pool->lodTime
+    };
+    int** intArrays[] = { &pool->state, &pool->attacking, &pool->seesPlayer, &pool->lodTier };
+    
+    bool allocated = true;
+    for (size_t i = 0; i < sizeof(floatArrays) / sizeof(floatArrays[0]); i++) {
+        *floatArrays[i] = (float*)AllocateHotArray(capacity);
+        allocated = allocated && *floatArrays[i] != NULL;
+    }
+    for (size_t i = 0; i < sizeof(intArrays) / sizeof(intArrays[0]); i++) {
+        *intArrays[i] = (int*)AllocateHotArray(capacity);
+        allocated = allocated && *intArrays[i] != NULL;
+    }
+    pool->enemies = (Enemy*)calloc(capacity, sizeof(Enemy));
+    pool->freeSlots = (int*)malloc(capacity * sizeof(int));
+    allocated = allocated && pool->enemies != NULL && pool->freeSlots != NULL;
+    
+    if (allocated) {
+        pool->capacity = capacity;
+        MarkSlotsDead(pool, capacity);
+    } else {
+        TraceLog(LOG_WARNING, "SPAWNER: Failed to allocate %d enemy slots", capacity);
+    }
+    
+    LoadEnemyModels();
+}
+
+// Free the slots and drop the archetype models
+void UnloadEnemyPool(EnemyPool* pool) {
+    void* arrays[] = {
+        pool->positionX, pool->positionY, pool->positionZ, pool->velocityX, pool->velocityZ,
+        pool->directionX, pool->directionZ, pool->rotation, pool->attackTimer, pool->pathfindTimer,
+        pool->stateTimer, pool->animTimer, pool->speed, pool->attackRange, pool->detectionRange,
+        pool->attackCooldown, pool->stepTime, pool->lodTime, pool->state, pool->attacking, pool->seesPlayer,
+        pool->lodTier, pool->enemies, pool->freeSlots
+    };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++) {
+        free(arrays[i]);
+    }
+    memset(pool, 0, sizeof(EnemyPool));
+    
+    UnloadEnemyModels();
+}
+
+// Forget every enemy, e.g. on a level change. Enemies own no resources,
+// so this only resets the bookkeeping; their entities go with the world's
+// own clear.
+void ClearEnemyPool(EnemyPool* pool) {
+    MarkSlotsDead(pool, pool->used);
+    pool->used = 0;
+    pool->freeCount = 0;
+    pool->liveCount = 0;
+    pool->dormantCount = 0;
+    pool->lodCursor = 0;
+}
+
+// Place an enemy in a free slot. Dormant enemies are skipped by the
+// simulation until WakeEnemies reaches them. Returns the slot, or -1 when
+// the pool or the world is full.
+int SpawnEnemy(EnemyPool* pool, EnemyType type, Vector3 position, int level, bool dormant) {
+    if (pool->freeCount == 0 && pool->used >= pool->capacity) return -1;
+    
+    Entity entity = CreateEntity(pool->world);
+    EnemyComponent* component = (EnemyComponent*)AddComponent(pool->world, entity, COMPONENT_ENEMY);
+    if (component == NULL) {
+        DestroyEntity(pool->world, entity);
+        return -1;
+    }
+    
+    int slot = (pool->freeCount > 0) ? pool->freeSlots[--pool->freeCount] : pool->used++;
+    InitEnemy(pool, slot, type, position, level);
+    pool->enemies[slot].entity = entity;
+    component->slot = slot;
+    
+    if (dormant) {
+        pool->state[slot] = ENEMY_DORMANT;
+        pool->dormantCount++;
+    }
+    pool->liveCount++;
+    return slot;
+}
+
+// Return an enemy's slot to the free list - call once when it dies or is
+// despawned
+void ReleaseEnemy(EnemyPool* pool, int slot) {
+    if (pool->state[slot] == ENEMY_DORMANT) pool->dormantCount--;
+    pool->state[slot] = ENEMY_DEAD;
+    pool->attacking[slot] = 0;
+    DestroyEntity(pool->world, pool->enemies[slot].entity);
+    
+    pool->freeSlots[pool->freeCount++] = slot;
+    pool->liveCount--;
+}
+
+// Enemies currently being simulated
+int GetAwakeEnemyCount(const EnemyPool* pool) {
+    return pool->liveCount - pool->dormantCount;
+}
+
+// Difficulty points a level's rooms are filled with
+int GetLevelSpawnBudget(int level) {
+    return SPAWN_BUDGET_BASE + level * SPAWN_BUDGET_PER_LEVEL;
+}
+
+// Pick a random archetype unlocked at this level that fits the budget,
+// or -1 if none does
+static int PickArchetype(int level, int budget) {
+    int eligible[ENEMY_COUNT];
+    int eligibleCount = 0;
+    for (int i = 0; i < ENEMY_COUNT; i++) {
+        if (enemyArchetypes[i].minLevel <= level && enemyArchetypes[i].spawnCost <= budget) {
+            eligible[eligibleCount++] = i;
+        }
+    }
+    return (eligibleCount > 0) ? eligible[GetRandomValue(0, eligibleCount - 1)] : -1;
+}
+
+// Buy enemies for one room until its budget or its attempts run out.
+// Nothing is placed within avoidDistance of the avoid point. Returns the
+// points left unspent, or -1 once the pool is full.
+static int SpawnIntoRoom(EnemyPool* pool, Dungeon* dungeon, const Room* room, int budget, int level,
+                         bool dormant, Vector3 avoid, float avoidDistance, int* spawned) {
+    for (int attempt = 0; budget > 0 && attempt < SPAWN_ATTEMPTS_PER_ROOM; attempt++) {
+        int type = PickArchetype(level, budget);
+        if (type < 0) break;
+        
+        int tileX = GetRandomValue(room->x, room->x + room->width - 1);
+        int tileZ = GetRandomValue(room->y, room->y + room->height - 1);
+        if (dungeon->tiles[tileX][tileZ] != TILE_FLOOR) continue;
+        
+        Vector3 position = { tileX + 0.5f, enemyArchetypes[type].height * 0.5f, tileZ + 0.5f };
+        if (Vector3Distance(position, avoid) < avoidDistance) continue;
+        
+        if (SpawnEnemy(pool, (EnemyType)type, position, level, dormant) < 0) return -1;
+        budget -= enemyArchetypes[type].spawnCost;
+        (*spawned)++;
+    }
+    return budget;
+}
+
+// Fill the level's rooms with dormant enemies bought from its difficulty
+// budget. Rooms share the budget by floor area and the start room stays
+// empty; points a room can't spend carry over to the next one. Returns
+// the number of enemies placed.
+int PopulateDungeon(EnemyPool* pool, Dungeon* dungeon, int level) {
+    int budget = GetLevelSpawnBudget(level);
+    
+    int totalArea = 0;
+    for (int i = 1; i < dungeon->roomCount; i++) {
+        totalArea += dungeon->rooms[i].width * dungeon->rooms[i].height;
+    }
+    if (totalArea == 0) return 0;
+    
+    int spawned = 0;
+    int allotted = 0;
+    int carried = 0;
+    int area = 0;
+    
+    for (int i = 1; i < dungeon->roomCount && carried >= 0; i++) {
+        Room* room = &dungeon->rooms[i];
+        
+        // This room's share, rounded so the shares add up to the budget
+        area += room->width * room->height;
+        int share = budget * area / totalArea - allotted;
+        allotted += share;
+        
+        carried = SpawnIntoRoom(pool, dungeon, room, share + carried, level, true,
+                                dungeon->startPosition, SPAWN_SAFE_DISTANCE, &spawned);
+    }
+    
+    TraceLog(LOG_INFO, "SPAWNER: Level %d populated with %d enemies (budget %d)", level, spawned, budget);
+    return spawned;
+}
+
+// Spend a budget on awake enemies in one random room whose centre lies
+// between minDistance and maxDistance of the player. Returns the number
+// spawned, which is zero when no room is in that band.
+int SpawnWave(EnemyPool* pool, Dungeon* dungeon, Vector3 playerPosition, int level, int budget,
+              float minDistance, float maxDistance) {
+    int candidates[SPAWN_MAX_WAVE_ROOMS];
+    int candidateCount = 0;
+    for (int i = 1; i < dungeon->roomCount && candidateCount < SPAWN_MAX_WAVE_ROOMS; i++) {
+        Room* room = &dungeon->rooms[i];
+        Vector3 center = { room->x + room->width * 0.5f, 0.0f, room->y + room->height * 0.5f };
+        float distance = Vector3Distance(center, (Vector3){ playerPosition.x, 0.0f, playerPosition.z });
+        if (distance >= minDistance && distance <= maxDistance) {
+            candidates[candidateCount++] = i;
+        }
+    }
+    if (candidateCount == 0) return 0;
+    
+    Room* room = &dungeon->rooms[candidates[GetRandomValue(0, candidateCount - 1)]];
+    int spawned = 0;
+    SpawnIntoRoom(pool, dungeon, room, budget, level, false, playerPosition, minDistance * 0.5f, &spawned);
+    return spawned;
+}
+
+// Start simulating up to maxWakes dormant enemies within the radius of
+// the player, found through the spatial hash. Returns the number woken;
+// waiting receives the number left dormant in range because of the limit.
+int WakeEnemies(EnemyPool* pool, const SpatialHash* spatial, Vector3 playerPosition, float radius, int maxWakes,
+                int* waiting) {
+    *waiting = 0;
+    if (pool->dormantCount == 0) return 0;
+    
+    Entity nearby[SPATIAL_MAX_RESULTS];
+    int nearbyCount = QuerySpatialRadius(spatial, playerPosition, radius, WITH_ENEMY, nearby, SPATIAL_MAX_RESULTS);
+    
+    int woken = 0;
+    for (int i = 0; i < nearbyCount; i++) {
+        EnemyComponent* component = (EnemyComponent*)GetComponent(pool->world, nearby[i], COMPONENT_ENEMY);
+        if (component == NULL || pool->state[component->slot] != ENEMY_DORMANT) continue;
+        
+        if (woken < maxWakes) {
+            pool->state[component->slot] = ENEMY_IDLE;
+            pool->stateTimer[component->slot] = 0.0f;
+            woken++;
+        } else {
+            (*waiting)++;
+        }
+    }
+    pool->dormantCount -= woken;
+    return woken;
+}
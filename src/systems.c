@@ -0,0 +1,365 @@
+#include "../include/systems.h"
+#include "../include/shadow.h"
+#include "../include/jobs.h"
+#include "../include/collision.h"
+#include "raymath.h"
+
+#define MAX_SHADOW_CASTERS (DIRECTOR_MAX_ACTIVE + 1)  // The player and a full active cap
+#define ITEM_JOB_GRAIN 256              // Ground items per animation job at least
+
+// Bolt model shared by every projectile
+static AssetHandle boltHandle;
+static Model boltModel;
+
+// Wake enemies near the player and pace waves within the budget
+static void DirectorSystem(World* world, void* context, float deltaTime) {
+    (void)world;
+    GameState* gameState = (GameState*)context;
+    UpdateSpawnDirector(&gameState->director, &gameState->enemyPool, &gameState->spatial, gameState->dungeon,
+                        gameState->player->position, gameState->currentLevel, deltaTime);
+}
+
+// Visibility jobs. The field of view and the flow field toward the player
+// only read the level and each write their own grid, so they are built
+// side by side.
+static void CastFieldOfView(void* context, int begin, int end) {
+    (void)begin;
+    (void)end;
+    GameState* gameState = (GameState*)context;
+    UpdateFieldOfView(&gameState->fieldOfView, gameState->dungeon, gameState->player->position);
+}
+
+static void SpreadFlowField(void* context, int begin, int end) {
+    (void)begin;
+    (void)end;
+    GameState* gameState = (GameState*)context;
+    UpdateFlowField(&gameState->flowField, gameState->dungeon, gameState->player->position);
+}
+
+// Recast the player's field of view and rebuild the flow field if the
+// player changed tile, let enemies in view see them, and run the enemy
+// update over the pool's arrays. Then act on the attacks it readied:
+// melee lands at once, ranged archetypes loose a bolt. Timed for the
+// director.
+static void EnemySystem(World* world, void* context, float deltaTime) {
+    GameState* gameState = (GameState*)context;
+    EnemyPool* pool = &gameState->enemyPool;
+    Player* player = gameState->player;
+    double start = GetTime();
+    int awakeEnemies = GetAwakeEnemyCount(pool);
+
+    Job visibilityJobs[] = {
+        { CastFieldOfView, gameState, 0, 1, NULL },
+        { SpreadFlowField, gameState, 0, 1, NULL }
+    };
+    JobCounter visibility = { 0 };
+    RunJobs(visibilityJobs, 2, &visibility);
+    WaitForJobs(&visibility);
+
+    UpdateEnemySight(pool, &gameState->fieldOfView);
+    UpdateEnemies(pool, gameState->dungeon, &gameState->flowField, player->position, deltaTime);
+
+    for (Query query = BeginQuery(world, WITH_ENEMY); QueryNext(&query);) {
+        EnemyComponent* component = (EnemyComponent*)GetComponent(world, query.entity, COMPONENT_ENEMY);
+        int slot = component->slot;
+
+        int damageDealt = 0;
+        if (!IsEnemyAwake(pool, slot) || !EnemyAttack(pool, gameState->dungeon, slot, player->position, player->radius,
+                                                      &damageDealt)) {
+            continue;
+        }
+
+        float projectileSpeed = enemyArchetypes[pool->enemies[slot].type].projectileSpeed;
+        if (projectileSpeed > 0.0f) {
+            Vector3 from = GetEnemyPosition(pool, slot);
+            Vector3 aim = Vector3Normalize((Vector3){ player->position.x - from.x, 0.0f, player->position.z - from.z });
+            SpawnProjectile(world, from, Vector3Scale(aim, projectileSpeed), damageDealt);
+        } else {
+            PlayerTakeDamage(player, damageDealt);
+        }
+    }
+
+    RecordEnemySimCost(&gameState->director, (float)(GetTime() - start), awakeEnemies);
+}
+
+// File every live enemy and ground item under its cell, after the enemy
+// update has moved them
+static void SpatialSystem(World* world, void* context, float deltaTime) {
+    (void)world;
+    (void)deltaTime;
+    RebuildSpatialHash((GameState*)context);
+}
+
+// Push overlapping awake enemies apart, so a chasing crowd spreads out
+// instead of stacking. Each enemy moves itself half the overlap with each
+// neighbour found in the hash, and never into a wall.
+static void SeparationSystem(World* world, void* context, float deltaTime) {
+    (void)deltaTime;
+    GameState* gameState = (GameState*)context;
+    EnemyPool* pool = &gameState->enemyPool;
+    Entity nearby[SPATIAL_MAX_RESULTS];
+
+    for (Query query = BeginQuery(world, WITH_ENEMY); QueryNext(&query);) {
+        int slot = ((EnemyComponent*)GetComponent(world, query.entity, COMPONENT_ENEMY))->slot;
+        if (!IsEnemyAwake(pool, slot)) continue;
+
+        float radius = pool->enemies[slot].radius;
+        Vector3 position = GetEnemyPosition(pool, slot);
+        int nearbyCount = QuerySpatialRadius(&gameState->spatial, position, radius + ENEMY_SEPARATION_REACH,
+                                             WITH_ENEMY, nearby, SPATIAL_MAX_RESULTS);
+
+        float pushX = 0.0f;
+        float pushZ = 0.0f;
+        for (int i = 0; i < nearbyCount; i++) {
+            EnemyComponent* other = (EnemyComponent*)GetComponent(world, nearby[i], COMPONENT_ENEMY);
+            if (other == NULL || other->slot == slot) continue;
+
+            float dx = position.x - pool->positionX[other->slot];
+            float dz = position.z - pool->positionZ[other->slot];
+            float distance = sqrtf(dx * dx + dz * dz);
+            float overlap = radius + pool->enemies[other->slot].radius - distance;
+            if (overlap <= 0.0f || distance < 0.0001f) continue;
+
+            pushX += dx / distance * overlap * 0.5f;
+            pushZ += dz / distance * overlap * 0.5f;
+        }
+
+        if (pushX != 0.0f || pushZ != 0.0f) {
+            Vector2 floorPosition = { position.x, position.z };
+            MoveCircle(gameState->dungeon, &floorPosition, (Vector2){ pushX, pushZ }, radius);
+            pool->positionX[slot] = floorPosition.x;
+            pool->positionZ[slot] = floorPosition.y;
+        }
+    }
+}
+
+// Apply the player's swing to awake enemies in the cone in front of them,
+// rewarding kills with experience and drops
+static void PlayerMeleeSystem(World* world, void* context, float deltaTime) {
+    (void)deltaTime;
+    GameState* gameState = (GameState*)context;
+    EnemyPool* pool = &gameState->enemyPool;
+    Player* player = gameState->player;
+    if (!player->isAttacking) return;
+
+    // Within attack range and a ~60 degree cone in front
+    Entity targets[SPATIAL_MAX_RESULTS];
+    int targetCount = QuerySpatialCone(&gameState->spatial, player->position, player->direction, player->attackRange,
+                                       0.5f, WITH_ENEMY, targets, SPATIAL_MAX_RESULTS);
+
+    for (int i = 0; i < targetCount; i++) {
+        EnemyComponent* component = (EnemyComponent*)GetComponent(world, targets[i], COMPONENT_ENEMY);
+        if (component == NULL || !IsEnemyAwake(pool, component->slot)) continue;
+        int slot = component->slot;
+
+        EnemyTakeDamage(pool, slot, player->attackDamage);
+        if (pool->state[slot] != ENEMY_DEAD) continue;
+
+        // Give player experience and a chance at a drop
+        Enemy* enemy = &pool->enemies[slot];
+        PlayerAddExperience(player, enemy->experienceValue);
+        if (GetRandomValue(0, 100) < enemy->dropChance * 100) {
+            SpawnItemEntity(world, GetRandomValue(1, 6), GetRandomValue(0, 4), gameState->currentLevel,
+                            GetEnemyPosition(pool, slot));
+        }
+
+        // Hand the slot back for the next spawn
+        ReleaseEnemy(pool, slot);
+    }
+}
+
+// Fly bolts, ending them on walls, on the player or when they expire
+static void ProjectileSystem(World* world, void* context, float deltaTime) {
+    GameState* gameState = (GameState*)context;
+    Player* player = gameState->player;
+
+    for (Query query = BeginQuery(world, WITH_TRANSFORM | WITH_PROJECTILE); QueryNext(&query);) {
+        WorldTransform* transform = (WorldTransform*)GetComponent(world, query.entity, COMPONENT_TRANSFORM);
+        Projectile* projectile = (Projectile*)GetComponent(world, query.entity, COMPONENT_PROJECTILE);
+
+        // Sweep the bolt first, so a fast one can't skip through a wall
+        Vector2 normal;
+        Vector2 move = { projectile->velocity.x * deltaTime, projectile->velocity.z * deltaTime };
+        float wallTime = SweepCircle(gameState->dungeon, (Vector2){ transform->position.x, transform->position.z }, move,
+                                     projectile->radius * COLLISION_RADIUS_SCALE, &normal);
+
+        projectile->lifetime -= deltaTime;
+        transform->position = Vector3Add(transform->position, Vector3Scale(projectile->velocity, deltaTime * wallTime));
+
+        float dx = transform->position.x - player->position.x;
+        float dz = transform->position.z - player->position.z;
+        float hitDistance = projectile->radius + player->radius;
+        if (dx * dx + dz * dz <= hitDistance * hitDistance) {
+            PlayerTakeDamage(player, projectile->damage);
+            DestroyEntity(world, query.entity);
+        } else if (projectile->lifetime <= 0.0f || wallTime < 1.0f) {
+            DestroyEntity(world, query.entity);
+        }
+    }
+}
+
+// Shared state for the item animation jobs
+typedef struct {
+    ItemComponent* items;
+    float deltaTime;
+} ItemAnimationJob;
+
+// Item animation job - a range of the item store's dense array
+static void AnimateItems(void* context, int begin, int end) {
+    ItemAnimationJob* job = (ItemAnimationJob*)context;
+    for (int i = begin; i < end; i++) {
+        UpdateItem(&job->items[i], job->deltaTime);
+    }
+}
+
+// Animate ground items and hand the player the ones in reach when they
+// interact. A picked up item's model goes with it into the inventory.
+static void ItemSystem(World* world, void* context, float deltaTime) {
+    GameState* gameState = (GameState*)context;
+    Player* player = gameState->player;
+
+    ItemAnimationJob animation = { (ItemComponent*)GetComponentArray(world, COMPONENT_ITEM), deltaTime };
+    ParallelFor(GetComponentCount(world, COMPONENT_ITEM), ITEM_JOB_GRAIN, AnimateItems, &animation);
+
+    if (!InputPressed(&gameState->input, INPUT_INTERACT)) return;
+
+    Entity inReach[SPATIAL_MAX_RESULTS];
+    int inReachCount = QuerySpatialRadius(&gameState->spatial, player->position, ITEM_PICKUP_RANGE, WITH_ITEM,
+                                          inReach, SPATIAL_MAX_RESULTS);
+    for (int i = 0; i < inReachCount && player->inventory.itemCount < player->inventory.maxItems; i++) {
+        ItemComponent* item = (ItemComponent*)GetComponent(world, inReach[i], COMPONENT_ITEM);
+        if (item == NULL) continue;
+
+        item->isOnGround = false;
+        PlayerAddItem(player, *item);
+        DestroyEntity(world, inReach[i]);
+    }
+}
+
+// Re-render torch shadows for lights that contain the player or an enemy
+static void ShadowSystem(World* world, void* context, float deltaTime) {
+    (void)deltaTime;
+    GameState* gameState = (GameState*)context;
+    EnemyPool* pool = &gameState->enemyPool;
+
+    ShadowCaster casters[MAX_SHADOW_CASTERS];
+    int casterCount = 0;
+    casters[casterCount++] = (ShadowCaster){ gameState->player->position, gameState->player->radius };
+    for (Query query = BeginQuery(world, WITH_ENEMY); QueryNext(&query) && casterCount < MAX_SHADOW_CASTERS;) {
+        int slot = ((EnemyComponent*)GetComponent(world, query.entity, COMPONENT_ENEMY))->slot;
+        if (IsEnemyAwake(pool, slot)) {
+            casters[casterCount++] = (ShadowCaster){ GetEnemyPosition(pool, slot), pool->enemies[slot].radius };
+        }
+    }
+    UpdateTorchShadows(gameState->dungeon, casters, casterCount);
+}
+
+// File the level's live enemies and ground items by cell. Runs as a
+// system each tick, and once when a level is built so the first tick's
+// queries see its enemies.
+void RebuildSpatialHash(GameState* gameState) {
+    SpatialHash* spatial = &gameState->spatial;
+    World* world = &gameState->world;
+    EnemyPool* pool = &gameState->enemyPool;
+
+    BeginSpatialHash(spatial, gameState->dungeon->width, gameState->dungeon->height);
+    for (Query query = BeginQuery(world, WITH_ENEMY); QueryNext(&query);) {
+        int slot = ((EnemyComponent*)GetComponent(world, query.entity, COMPONENT_ENEMY))->slot;
+        InsertSpatialEntity(spatial, query.entity, GetEnemyPosition(pool, slot), WITH_ENEMY);
+    }
+    for (Query query = BeginQuery(world, WITH_ITEM); QueryNext(&query);) {
+        ItemComponent* item = (ItemComponent*)GetComponent(world, query.entity, COMPONENT_ITEM);
+        InsertSpatialEntity(spatial, query.entity, item->position, WITH_ITEM);
+    }
+    EndSpatialHash(spatial);
+}
+
+// Create the world's stores and register the gameplay systems in the
+// order they run each tick
+void InitGameWorld(World* world, int maxEnemies, int maxItems) {
+    InitWorld(world, maxEnemies + maxItems + MAX_PROJECTILES + MAX_PROPS);
+    RegisterComponent(world, COMPONENT_TRANSFORM, sizeof(WorldTransform), MAX_PROJECTILES + MAX_PROPS);
+    RegisterComponent(world, COMPONENT_RENDERABLE, sizeof(Renderable), MAX_PROJECTILES + MAX_PROPS);
+    RegisterComponent(world, COMPONENT_ENEMY, sizeof(EnemyComponent), maxEnemies);
+    RegisterComponent(world, COMPONENT_ITEM, sizeof(ItemComponent), maxItems);
+    RegisterComponent(world, COMPONENT_PROJECTILE, sizeof(Projectile), MAX_PROJECTILES);
+    RegisterComponent(world, COMPONENT_PROP, sizeof(Prop), MAX_PROPS);
+
+    AddSystem(world, "director", DirectorSystem);
+    AddSystem(world, "enemies", EnemySystem);
+    AddSystem(world, "spatial", SpatialSystem);
+    AddSystem(world, "separation", SeparationSystem);
+    AddSystem(world, "player-melee", PlayerMeleeSystem);
+    AddSystem(world, "projectiles", ProjectileSystem);
+    AddSystem(world, "items", ItemSystem);
+    AddSystem(world, "shadows", ShadowSystem);
+
+    boltHandle = AcquireMeshModel("projectile/bolt", MESH_SHAPE_SPHERE, (Vector3){ PROJECTILE_RADIUS, 0.0f, 0.0f }, 6);
+    Model* model = GetModelAsset(boltHandle);
+    if (model != NULL) boltModel = *model;
+}
+
+// Free the world and its shared projectile model
+void UnloadGameWorld(World* world) {
+    ClearGameWorld(world);
+    UnloadWorld(world);
+
+    ReleaseAsset(boltHandle);
+    boltModel = (Model){0};
+}
+
+// Destroy every entity, e.g. on a level change
+void ClearGameWorld(World* world) {
+    ClearWorld(world);
+}
+
+// Drop an item on the ground. Returns ENTITY_NONE when the world has no
+// room for another item.
+Entity SpawnItemEntity(World* world, ItemType type, int subType, int level, Vector3 position) {
+    Entity entity = CreateEntity(world);
+    ItemComponent* item = (ItemComponent*)AddComponent(world, entity, COMPONENT_ITEM);
+    if (item == NULL) {
+        DestroyEntity(world, entity);
+        return ENTITY_NONE;
+    }
+
+    InitItem(item, type, subType, level, position);
+    return entity;
+}
+
+// Launch a bolt at the player. Returns ENTITY_NONE when too many are in flight.
+Entity SpawnProjectile(World* world, Vector3 position, Vector3 velocity, int damage) {
+    Entity entity = CreateEntity(world);
+    WorldTransform* transform = (WorldTransform*)AddComponent(world, entity, COMPONENT_TRANSFORM);
+    Renderable* renderable = (Renderable*)AddComponent(world, entity, COMPONENT_RENDERABLE);
+    Projectile* projectile = (Projectile*)AddComponent(world, entity, COMPONENT_PROJECTILE);
+    if (transform == NULL || renderable == NULL || projectile == NULL) {
+        DestroyEntity(world, entity);
+        return ENTITY_NONE;
+    }
+
+    transform->position = position;
+    renderable->model = &boltModel;
+    renderable->tint = ORANGE;
+    projectile->velocity = velocity;
+    projectile->radius = PROJECTILE_RADIUS;
+    projectile->lifetime = PROJECTILE_LIFETIME;
+    projectile->damage = damage;
+    return entity;
+}
+
+// Record every drawable entity and ground item for drawing
+void RecordWorldEntities(World* world, SceneList* scene) {
+    for (Query query = BeginQuery(world, WITH_TRANSFORM | WITH_RENDERABLE); QueryNext(&query);) {
+        WorldTransform* transform = (WorldTransform*)GetComponent(world, query.entity, COMPONENT_TRANSFORM);
+        Renderable* renderable = (Renderable*)GetComponent(world, query.entity, COMPONENT_RENDERABLE);
+        if (renderable->model->meshCount == 0) continue;
+
+        RecordSceneModel(scene, query.entity, renderable->model, transform->position, transform->rotation,
+                         renderable->tint);
+    }
+
+    for (Query query = BeginQuery(world, WITH_ITEM); QueryNext(&query);) {
+        RecordItem((ItemComponent*)GetComponent(world, query.entity, COMPONENT_ITEM), query.entity, scene);
+    }
+}
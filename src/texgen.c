@@ -0,0 +1,430 @@
+#include "../include/texgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+#define TEXGEN_CACHE_MAGIC 0x58455443u  // "CTEX"
+#define TEXGEN_OCTAVES 5
+
+// Header of a cached texture, followed by RGBA8 pixels
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t hash;
+    uint32_t width;
+    uint32_t height;
+} TexGenCacheHeader;
+
+// One sample of a surface: its height and albedo
+typedef struct {
+    float height;
+    float r, g, b;
+} SurfaceSample;
+
+static const char* patternNames[] = { "stone", "cave_rock", "crypt_brick" };
+static const char* channelNames[] = { "albedo", "normal" };
+static atomic_uint cacheWrites = 0;    // Keeps temporary names apart when two workers write one file
+
+// FNV-1a over a few bytes, continuing from a previous hash
+static uint32_t HashBytes(uint32_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Hash the generator version and every parameter, field by field
+static uint32_t HashTexGenParams(const TexGenParams* params) {
+    uint32_t hash = 2166136261u;
+    int version = TEXGEN_VERSION;
+    hash = HashBytes(hash, &version, sizeof(version));
+    hash = HashBytes(hash, &params->pattern, sizeof(params->pattern));
+    hash = HashBytes(hash, &params->channel, sizeof(params->channel));
+    hash = HashBytes(hash, &params->size, sizeof(params->size));
+    hash = HashBytes(hash, &params->seed, sizeof(params->seed));
+    hash = HashBytes(hash, &params->baseColor, sizeof(params->baseColor));
+    hash = HashBytes(hash, &params->accentColor, sizeof(params->accentColor));
+    hash = HashBytes(hash, &params->featureScale, sizeof(params->featureScale));
+    hash = HashBytes(hash, &params->normalStrength, sizeof(params->normalStrength));
+    return hash;
+}
+
+// Registry key for a generated texture
+void GetTexGenKey(const TexGenParams* params, char* key, int size) {
+    snprintf(key, size, "texgen:%s:%s:%08x", patternNames[params->pattern], channelNames[params->channel],
+             HashTexGenParams(params));
+}
+
+// Scramble lattice coordinates and a seed into 32 random bits
+static uint32_t HashLattice(int x, int y, uint32_t seed) {
+    uint32_t h = seed * 0x9E3779B1u ^ (uint32_t)x * 0x85EBCA77u ^ (uint32_t)y * 0xC2B2AE3Du;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return h;
+}
+
+// Random value in [0, 1] for a lattice point
+static float LatticeValue(int x, int y, uint32_t seed) {
+    return (HashLattice(x, y, seed) & 0xFFFFFF) / 16777215.0f;
+}
+
+// Wrap a lattice coordinate into [0, period)
+static int WrapLattice(int value, int period) {
+    int wrapped = value % period;
+    return (wrapped < 0) ? wrapped + period : wrapped;
+}
+
+// Value noise whose lattice repeats every `period` cells, so it tiles
+static float TileNoise(float x, float y, int period, uint32_t seed) {
+    int x0 = (int)floorf(x);
+    int y0 = (int)floorf(y);
+    float fx = x - x0;
+    float fy = y - y0;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+
+    int xa = WrapLattice(x0, period), xb = WrapLattice(x0 + 1, period);
+    int ya = WrapLattice(y0, period), yb = WrapLattice(y0 + 1, period);
+    float top = LatticeValue(xa, ya, seed) + (LatticeValue(xb, ya, seed) - LatticeValue(xa, ya, seed)) * fx;
+    float bottom = LatticeValue(xa, yb, seed) + (LatticeValue(xb, yb, seed) - LatticeValue(xa, yb, seed)) * fx;
+    return top + (bottom - top) * fy;
+}
+
+// Tileable fractal noise in [0, 1] over texture coordinates in [0, 1)
+static float TileFbm(float u, float v, int period, uint32_t seed) {
+    float sum = 0.0f;
+    float amplitude = 0.5f;
+    float total = 0.0f;
+    for (int octave = 0; octave < TEXGEN_OCTAVES; octave++) {
+        sum += amplitude * TileNoise(u * period, v * period, period, seed + octave);
+        total += amplitude;
+        amplitude *= 0.5f;
+        period *= 2;
+    }
+    return sum / total;
+}
+
+// Tileable ridged noise in [0, 1] - sharp crests where the noise crosses
+// its midpoint, for rock
+static float TileRidged(float u, float v, int period, uint32_t seed) {
+    float sum = 0.0f;
+    float amplitude = 0.5f;
+    float total = 0.0f;
+    for (int octave = 0; octave < TEXGEN_OCTAVES; octave++) {
+        float ridge = 1.0f - fabsf(2.0f * TileNoise(u * period, v * period, period, seed + octave) - 1.0f);
+        sum += amplitude * ridge * ridge;
+        total += amplitude;
+        amplitude *= 0.5f;
+        period *= 2;
+    }
+    return sum / total;
+}
+
+// Tileable cellular noise: distances to the nearest and second nearest
+// feature points (in cell units) and the nearest cell's random id
+static void TileCells(float u, float v, int cells, uint32_t seed, float* f1, float* f2, uint32_t* cellId) {
+    float x = u * cells;
+    float y = v * cells;
+    int cx = (int)floorf(x);
+    int cy = (int)floorf(y);
+    *f1 = *f2 = 8.0f;
+    *cellId = 0;
+
+    // Two cells out, so the second nearest point is never missed
+    for (int j = -2; j <= 2; j++) {
+        for (int i = -2; i <= 2; i++) {
+            int wx = WrapLattice(cx + i, cells);
+            int wy = WrapLattice(cy + j, cells);
+            uint32_t h = HashLattice(wx, wy, seed);
+            float px = cx + i + (h & 0xFFFF) / 65535.0f;
+            float py = cy + j + (h >> 16) / 65535.0f;
+            float distance = sqrtf((px - x) * (px - x) + (py - y) * (py - y));
+
+            if (distance < *f1) {
+                *f2 = *f1;
+                *f1 = distance;
+                *cellId = h;
+            } else if (distance < *f2) {
+                *f2 = distance;
+            }
+        }
+    }
+}
+
+// Smooth step between two edges
+static float SmoothStep(float edge0, float edge1, float x) {
+    float t = (x - edge0) / (edge1 - edge0);
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// Blend accent and base colors by `amount`, shaded by `tone`
+static void MixSurfaceColor(const TexGenParams* params, float amount, float tone, SurfaceSample* sample) {
+    Color a = params->accentColor;
+    Color b = params->baseColor;
+    sample->r = (a.r + (b.r - a.r) * amount) * tone;
+    sample->g = (a.g + (b.g - a.g) * amount) * tone;
+    sample->b = (a.b + (b.b - a.b) * amount) * tone;
+}
+
+// Cobbled stone: cells with mortar along their borders
+static SurfaceSample SampleStone(const TexGenParams* params, float u, float v, int scale) {
+    SurfaceSample sample;
+    float f1, f2;
+    uint32_t cellId;
+    TileCells(u, v, scale, params->seed, &f1, &f2, &cellId);
+
+    float detail = TileFbm(u, v, 8, params->seed + 11);
+    float stone = SmoothStep(0.03f, 0.14f, (f2 - f1) + (detail - 0.5f) * 0.08f);
+    float bulge = 1.0f - 0.35f * f1;
+    float cellTone = 0.8f + 0.3f * (((cellId >> 8) & 0xFF) / 255.0f);
+
+    sample.height = stone * (0.55f + 0.3f * bulge + 0.15f * detail);
+    MixSurfaceColor(params, stone, cellTone * (0.8f + 0.4f * detail), &sample);
+    return sample;
+}
+
+// Cave rock: ridged noise over bands of strata
+static SurfaceSample SampleCaveRock(const TexGenParams* params, float u, float v, int scale) {
+    SurfaceSample sample;
+    float ridged = TileRidged(u, v, 4, params->seed);
+    float warp = TileFbm(u, v, 2, params->seed + 7);
+    float strata = 0.5f + 0.5f * sinf((v * scale + warp * 1.5f) * 2.0f * PI);
+    float detail = TileFbm(u, v, 16, params->seed + 13);
+
+    sample.height = 0.65f * ridged + 0.25f * strata + 0.1f * detail;
+    MixSurfaceColor(params, SmoothStep(0.2f, 0.6f, sample.height), 0.8f + 0.35f * detail, &sample);
+    return sample;
+}
+
+// Crypt brick: courses offset by half a brick, bricks twice as long as tall
+static SurfaceSample SampleCryptBrick(const TexGenParams* params, float u, float v, int scale) {
+    SurfaceSample sample;
+    int rows = (scale < 2) ? 2 : scale & ~1;
+    int columns = rows / 2;
+
+    float by = v * rows;
+    int row = (int)floorf(by);
+    float bx = u * columns + ((row & 1) ? 0.5f : 0.0f);
+    int column = (int)floorf(bx);
+    float fx = bx - column;
+    float fy = by - row;
+
+    // Distance to the nearest mortar line, in course heights
+    float edgeX = fminf(fx, 1.0f - fx) * 2.0f;
+    float edgeY = fminf(fy, 1.0f - fy);
+    float detail = TileFbm(u, v, 8, params->seed + 3);
+    float brick = SmoothStep(0.05f, 0.12f, fminf(edgeX, edgeY) + (detail - 0.5f) * 0.06f);
+
+    uint32_t brickId = HashLattice(WrapLattice(column, columns), WrapLattice(row, rows), params->seed);
+    float brickTone = 0.75f + 0.35f * ((brickId & 0xFF) / 255.0f);
+    float wear = TileFbm(u, v, 32, params->seed + 5);
+
+    sample.height = brick * (0.7f + 0.2f * detail + 0.1f * wear);
+    MixSurfaceColor(params, brick, brickTone * (0.85f + 0.3f * wear), &sample);
+    return sample;
+}
+
+// Sample a pattern at texture coordinates in [0, 1)
+static SurfaceSample SampleSurface(const TexGenParams* params, float u, float v) {
+    int scale = (params->featureScale >= 1.0f) ? (int)params->featureScale : 1;
+    switch (params->pattern) {
+        case TEXGEN_CAVE_ROCK:   return SampleCaveRock(params, u, v, scale);
+        case TEXGEN_CRYPT_BRICK: return SampleCryptBrick(params, u, v, scale);
+        case TEXGEN_STONE:
+        default:                 return SampleStone(params, u, v, scale);
+    }
+}
+
+// Clamp a color channel to a byte
+static unsigned char ToByte(float value) {
+    if (value < 0.0f) return 0;
+    if (value > 255.0f) return 255;
+    return (unsigned char)(value + 0.5f);
+}
+
+// Wrap generated pixels in an image
+static Image MakeImage(unsigned char* pixels, int size) {
+    Image image = { 0 };
+    image.data = pixels;
+    image.width = size;
+    image.height = size;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    return image;
+}
+
+// Run a generator. One pass samples the height field and the albedo, and
+// the normal map comes from that height field's wrapped central
+// differences, so both channels of a material cost a single sampling pass.
+static bool GenerateImages(const TexGenParams* params, Image* albedo, Image* normal) {
+    int size = params->size;
+    size_t count = (size_t)size * size;
+    unsigned char* colors = (unsigned char*)malloc(count * 4);
+    unsigned char* normals = (unsigned char*)malloc(count * 4);
+    float* heights = (float*)malloc(count * sizeof(float));
+    if (colors == NULL || normals == NULL || heights == NULL) {
+        free(colors);
+        free(normals);
+        free(heights);
+        return false;
+    }
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            SurfaceSample sample = SampleSurface(params, (x + 0.5f) / size, (y + 0.5f) / size);
+            unsigned char* p = &colors[(y * size + x) * 4];
+            heights[y * size + x] = sample.height;
+            p[0] = ToByte(sample.r);
+            p[1] = ToByte(sample.g);
+            p[2] = ToByte(sample.b);
+            p[3] = 255;
+        }
+    }
+
+    float strength = params->normalStrength * size / 64.0f;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float left = heights[y * size + WrapLattice(x - 1, size)];
+            float right = heights[y * size + WrapLattice(x + 1, size)];
+            float up = heights[WrapLattice(y - 1, size) * size + x];
+            float down = heights[WrapLattice(y + 1, size) * size + x];
+
+            float nx = (left - right) * strength;
+            float ny = (up - down) * strength;
+            float length = sqrtf(nx * nx + ny * ny + 1.0f);
+            unsigned char* p = &normals[(y * size + x) * 4];
+            p[0] = ToByte((nx / length * 0.5f + 0.5f) * 255.0f);
+            p[1] = ToByte((ny / length * 0.5f + 0.5f) * 255.0f);
+            p[2] = ToByte((1.0f / length * 0.5f + 0.5f) * 255.0f);
+            p[3] = 255;
+        }
+    }
+    free(heights);
+
+    *albedo = MakeImage(colors, size);
+    *normal = MakeImage(normals, size);
+    return true;
+}
+
+// Path of a texture's cache file
+static void GetCachePath(const TexGenParams* params, uint32_t hash, char* path, int size) {
+    snprintf(path, size, "%s/%s_%s_%08x.tex", TEXGEN_CACHE_DIR, patternNames[params->pattern],
+             channelNames[params->channel], hash);
+}
+
+// Read a cached texture, if a valid one exists for these parameters
+static Image LoadCachedImage(const TexGenParams* params, uint32_t hash) {
+    Image image = { 0 };
+    char path[256];
+    GetCachePath(params, hash, path, sizeof(path));
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return image;
+
+    TexGenCacheHeader header;
+    size_t pixelSize = (size_t)params->size * params->size * 4;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == TEXGEN_CACHE_MAGIC &&
+                 header.version == TEXGEN_VERSION && header.hash == hash &&
+                 header.width == (uint32_t)params->size && header.height == (uint32_t)params->size;
+
+    unsigned char* pixels = valid ? (unsigned char*)malloc(pixelSize) : NULL;
+    if (pixels != NULL && fread(pixels, 1, pixelSize, file) == pixelSize) {
+        image.data = pixels;
+        image.width = params->size;
+        image.height = params->size;
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    } else {
+        free(pixels);
+    }
+    fclose(file);
+    return image;
+}
+
+// Create a directory unless it already exists
+static bool EnsureDirectory(const char* path) {
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+// Write a generated texture to the cache. The file is written under a
+// temporary name of its own and renamed, so a reader never sees half of it
+// and two workers caching the same channel do not interleave.
+static void StoreCachedImage(const TexGenParams* params, uint32_t hash, const Image* image) {
+    char directory[sizeof(TEXGEN_CACHE_DIR)];
+    snprintf(directory, sizeof(directory), "%s", TEXGEN_CACHE_DIR);
+    for (char* slash = strchr(directory, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        EnsureDirectory(directory);
+        *slash = '/';
+    }
+    if (!EnsureDirectory(directory)) {
+        TraceLog(LOG_WARNING, "TEXGEN: Failed to create cache directory %s", directory);
+        return;
+    }
+
+    char path[256];
+    char temporary[280];
+    GetCachePath(params, hash, path, sizeof(path));
+    snprintf(temporary, sizeof(temporary), "%s.%u.tmp", path, atomic_fetch_add(&cacheWrites, 1));
+
+    FILE* file = fopen(temporary, "wb");
+    if (file == NULL) return;
+
+    TexGenCacheHeader header = { TEXGEN_CACHE_MAGIC, TEXGEN_VERSION, hash, (uint32_t)image->width,
+                                 (uint32_t)image->height };
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(image->data, 4, (size_t)image->width * image->height, file) == (size_t)image->width * image->height;
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(temporary, path) != 0) {
+        remove(temporary);
+        TraceLog(LOG_WARNING, "TEXGEN: Failed to write cache file %s", path);
+    }
+}
+
+// Load a generated texture from the disk cache, generating and caching it
+// on a miss. Safe to call from worker threads.
+Image LoadGeneratedImage(const TexGenParams* params) {
+    Image image = { 0 };
+    if (params->size <= 0 || (params->size & (params->size - 1)) != 0) {
+        TraceLog(LOG_WARNING, "TEXGEN: Size %d is not a power of two", params->size);
+        return image;
+    }
+
+    uint32_t hash = HashTexGenParams(params);
+    image = LoadCachedImage(params, hash);
+    if (image.data != NULL) {
+        TraceLog(LOG_DEBUG, "TEXGEN: Cache hit for %s %s %08x", patternNames[params->pattern],
+                 channelNames[params->channel], hash);
+        return image;
+    }
+
+    // Generate both channels and cache the one not asked for too, so its
+    // request is a cache hit rather than a second pass over the same heights
+    Image albedo;
+    Image normal;
+    if (!GenerateImages(params, &albedo, &normal)) return image;
+
+    TexGenParams sibling = *params;
+    sibling.channel = (params->channel == TEXGEN_NORMAL) ? TEXGEN_ALBEDO : TEXGEN_NORMAL;
+    image = (params->channel == TEXGEN_NORMAL) ? normal : albedo;
+    Image other = (params->channel == TEXGEN_NORMAL) ? albedo : normal;
+
+    StoreCachedImage(params, hash, &image);
+    StoreCachedImage(&sibling, HashTexGenParams(&sibling), &other);
+    free(other.data);
+    TraceLog(LOG_INFO, "TEXGEN: Generated %s %dx%d", patternNames[params->pattern], image.width, image.height);
+    return image;
+}
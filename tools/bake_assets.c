@@ -0,0 +1,943 @@
+// Offline asset baker - converts the game's PNG textures and glTF models
+// into one archive the game can memory-map and upload without decoding.
+//
+// Usage: bake_assets [--compress] output.pak input.png|input.gltf ...
+//
+// Entries are named by their input paths, which must match the paths the
+// game loads them by (run from the project root, as `make bake` does).
+
+#include "raylib.h"
+#include "../include/pak.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+#define MAX_INDEXED_VERTICES 65536      // Indices are 16-bit
+#define VERTEX_FLOATS 8                 // Position, texcoord, normal
+#define VERTEX_CACHE_SIZE 32            // Cache modelled when ordering triangles
+#define FIFO_CACHE_SIZE 16              // Cache simulated to measure the result
+#define OVERDRAW_THRESHOLD 1.05f        // Cache efficiency overdraw ordering may give up
+
+// An entry being built, with its data kept in memory until written
+typedef struct {
+    PakEntry toc;
+    unsigned char* data;
+    char textureName[PAK_NAME_LENGTH];  // Model's diffuse image, matched to a texture entry
+} BakeEntry;
+
+// A mesh of unique interleaved vertices, ready to be optimized and packed
+typedef struct {
+    float* vertices;                    // VERTEX_FLOATS per vertex: position, texcoord, normal
+    unsigned short* indices;
+    int vertexCount;
+    int indexCount;
+} BakedMesh;
+
+// Sizes and cache efficiency before and after baking, for the report
+typedef struct {
+    unsigned int sourceBytes;
+    unsigned int bakedBytes;
+    float sourceACMR;
+    float bakedACMR;
+    int triangles;
+} MeshStats;
+
+static BakeEntry* entries = NULL;
+static int entryCount = 0;
+static int entryCapacity = 0;
+static unsigned int modelSourceBytes = 0;
+static unsigned int modelBakedBytes = 0;
+
+// Align a size up to the archive alignment
+static unsigned int AlignSize(unsigned int size) {
+    return (size + PAK_ALIGNMENT - 1) & ~(unsigned int)(PAK_ALIGNMENT - 1);
+}
+
+// Add an entry to the archive
+static BakeEntry* AddBakeEntry(const char* name, PakEntryType type) {
+    if (strlen(name) >= PAK_NAME_LENGTH) {
+        TraceLog(LOG_WARNING, "BAKE: [%s] Path too long, skipped", name);
+        return NULL;
+    }
+    if (entryCount >= entryCapacity) {
+        entryCapacity = entryCapacity == 0 ? 64 : entryCapacity * 2;
+        entries = (BakeEntry*)realloc(entries, entryCapacity * sizeof(BakeEntry));
+    }
+
+    BakeEntry* entry = &entries[entryCount++];
+    memset(entry, 0, sizeof(BakeEntry));
+    snprintf(entry->toc.name, sizeof(entry->toc.name), "%s", name);
+    entry->toc.type = type;
+    return entry;
+}
+
+// Pack a color into RGB565
+static unsigned short PackRGB565(int r, int g, int b) {
+    return (unsigned short)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+// Expand RGB565 back to 8 bits per channel
+static void UnpackRGB565(unsigned short c, int* rgb) {
+    rgb[0] = ((c >> 11) & 31) * 255 / 31;
+    rgb[1] = ((c >> 5) & 63) * 255 / 63;
+    rgb[2] = (c & 31) * 255 / 31;
+}
+
+// Encode one 4x4 block as BC1 (DXT1) - endpoints from the inset bounding
+// box of the block's colors, each pixel mapped to the nearest palette entry
+static void EncodeBC1Block(const unsigned char* pixels, int stride, unsigned char* out) {
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const unsigned char* p = pixels + y * stride + x * 4;
+            for (int c = 0; c < 3; c++) {
+                if (p[c] < minColor[c]) minColor[c] = p[c];
+                if (p[c] > maxColor[c]) maxColor[c] = p[c];
+            }
+        }
+    }
+
+    // Inset the box slightly to reduce the error of the extreme colors
+    for (int c = 0; c < 3; c++) {
+        int inset = (maxColor[c] - minColor[c]) / 16;
+        minColor[c] += inset;
+        maxColor[c] -= inset;
+    }
+
+    unsigned short c0 = PackRGB565(maxColor[0], maxColor[1], maxColor[2]);
+    unsigned short c1 = PackRGB565(minColor[0], minColor[1], minColor[2]);
+    unsigned int indices = 0;
+
+    // c0 > c1 selects the four-color mode; equal endpoints need no indices
+    if (c0 < c1) {
+        unsigned short swap = c0;
+        c0 = c1;
+        c1 = swap;
+    }
+
+    if (c0 != c1) {
+        int palette[4][3];
+        UnpackRGB565(c0, palette[0]);
+        UnpackRGB565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; i++) {
+            const unsigned char* p = pixels + (i / 4) * stride + (i % 4) * 4;
+            int best = 0;
+            int bestDistance = 0x7FFFFFFF;
+            for (int k = 0; k < 4; k++) {
+                int dr = p[0] - palette[k][0];
+                int dg = p[1] - palette[k][1];
+                int db = p[2] - palette[k][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = k;
+                }
+            }
+            indices |= (unsigned int)best << (i * 2);
+        }
+    }
+
+    out[0] = c0 & 0xFF;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xFF;
+    out[3] = c1 >> 8;
+    out[4] = indices & 0xFF;
+    out[5] = (indices >> 8) & 0xFF;
+    out[6] = (indices >> 16) & 0xFF;
+    out[7] = (indices >> 24) & 0xFF;
+}
+
+// Compress one RGBA8 mip level to BC1. Levels smaller than a block are
+// padded by repeating their edge pixels.
+static int CompressLevelBC1(const unsigned char* rgba, int width, int height, unsigned char* out) {
+    int written = 0;
+    unsigned char block[4 * 4 * 4];
+
+    for (int by = 0; by < height; by += 4) {
+        for (int bx = 0; bx < width; bx += 4) {
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    int sx = (bx + x < width) ? bx + x : width - 1;
+                    int sy = (by + y < height) ? by + y : height - 1;
+                    memcpy(&block[(y * 4 + x) * 4], &rgba[(sy * width + sx) * 4], 4);
+                }
+            }
+            EncodeBC1Block(block, 16, out + written);
+            written += 8;
+        }
+    }
+    return written;
+}
+
+// Check if every pixel of an RGBA8 image is opaque
+static bool IsImageOpaque(const Image* image) {
+    const unsigned char* pixels = (const unsigned char*)image->data;
+    for (int i = 0; i < image->width * image->height; i++) {
+        if (pixels[i * 4 + 3] != 255) return false;
+    }
+    return true;
+}
+
+// Bake a texture: decode, convert to RGBA8, build mipmaps, optionally compress
+static void BakeTexture(const char* path, bool compress) {
+    Image image = LoadImage(path);
+    if (image.data == NULL) {
+        TraceLog(LOG_WARNING, "BAKE: [%s] Failed to load image, skipped", path);
+        return;
+    }
+
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    bool opaque = IsImageOpaque(&image);
+    ImageMipmaps(&image);
+
+    BakeEntry* entry = AddBakeEntry(path, PAK_ENTRY_TEXTURE);
+    if (entry == NULL) {
+        UnloadImage(image);
+        return;
+    }
+
+    entry->toc.texture.width = image.width;
+    entry->toc.texture.height = image.height;
+    entry->toc.texture.mipmaps = image.mipmaps;
+
+    // Levels are stored back to back in the image data
+    int levelSize[32];
+    int totalSize = 0;
+    for (int level = 0, w = image.width, h = image.height; level < image.mipmaps; level++) {
+        levelSize[level] = GetPixelDataSize(w, h, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        totalSize += levelSize[level];
+        if (w > 1) w /= 2;
+        if (h > 1) h /= 2;
+    }
+
+    // BC1 has no alpha, and raylib sizes compressed mips assuming whole
+    // blocks, so only square power-of-two opaque images are compressed
+    bool powerOfTwo = (image.width & (image.width - 1)) == 0 && image.width == image.height;
+    if (compress && opaque && powerOfTwo && image.width >= 4) {
+        unsigned char* out = (unsigned char*)malloc(totalSize);
+        const unsigned char* level = (const unsigned char*)image.data;
+        int written = 0;
+        for (int i = 0, w = image.width, h = image.height; i < image.mipmaps; i++) {
+            written += CompressLevelBC1(level, w, h, out + written);
+            level += levelSize[i];
+            if (w > 1) w /= 2;
+            if (h > 1) h /= 2;
+        }
+        entry->data = out;
+        entry->toc.size = written;
+        entry->toc.texture.format = PIXELFORMAT_COMPRESSED_DXT1_RGB;
+    } else {
+        entry->data = (unsigned char*)malloc(totalSize);
+        memcpy(entry->data, image.data, totalSize);
+        entry->toc.size = totalSize;
+        entry->toc.texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    }
+
+    TraceLog(LOG_INFO, "BAKE: [%s] %dx%d, %d mips, %u KB", path, image.width, image.height,
+             image.mipmaps, entry->toc.size / 1024);
+    UnloadImage(image);
+}
+
+// Hash a vertex's attributes for deduplication
+static unsigned int HashVertex(const float* vertex) {
+    const unsigned char* bytes = (const unsigned char*)vertex;
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < VERTEX_FLOATS * (int)sizeof(float); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Gather one corner's attributes, filling in missing streams with zeros
+static void GatherVertex(const Mesh* mesh, int index, float* vertex) {
+    memset(vertex, 0, VERTEX_FLOATS * sizeof(float));
+    memcpy(vertex, &mesh->vertices[index * 3], 3 * sizeof(float));
+    if (mesh->texcoords != NULL) memcpy(vertex + 3, &mesh->texcoords[index * 2], 2 * sizeof(float));
+    if (mesh->normals != NULL) memcpy(vertex + 5, &mesh->normals[index * 3], 3 * sizeof(float));
+}
+
+// Convert a mesh to an indexed mesh of unique vertices. Meshes with too
+// many unique vertices for 16-bit indices are written unindexed.
+static BakedMesh IndexMesh(const Mesh* mesh) {
+    BakedMesh baked = { 0 };
+    int cornerCount = (mesh->indices != NULL) ? mesh->triangleCount * 3 : mesh->vertexCount;
+
+    float* unique = (float*)malloc((size_t)cornerCount * VERTEX_FLOATS * sizeof(float));
+    unsigned short* indices = (unsigned short*)malloc((size_t)cornerCount * sizeof(unsigned short));
+
+    // Open-addressed table of unique vertex indices
+    int tableSize = 1;
+    while (tableSize < cornerCount * 2) tableSize <<= 1;
+    int* table = (int*)malloc(tableSize * sizeof(int));
+    for (int i = 0; i < tableSize; i++) table[i] = -1;
+
+    int uniqueCount = 0;
+    bool overflow = false;
+    for (int corner = 0; corner < cornerCount && !overflow; corner++) {
+        float vertex[VERTEX_FLOATS];
+        GatherVertex(mesh, (mesh->indices != NULL) ? mesh->indices[corner] : corner, vertex);
+
+        unsigned int slot = HashVertex(vertex) & (tableSize - 1);
+        while (table[slot] >= 0 && memcmp(&unique[table[slot] * VERTEX_FLOATS], vertex, sizeof(vertex)) != 0) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] < 0) {
+            if (uniqueCount >= MAX_INDEXED_VERTICES) {
+                overflow = true;
+                break;
+            }
+            table[slot] = uniqueCount;
+            memcpy(&unique[uniqueCount * VERTEX_FLOATS], vertex, sizeof(vertex));
+            uniqueCount++;
+        }
+        indices[corner] = (unsigned short)table[slot];
+    }
+    free(table);
+
+    // Expand every corner if the mesh cannot be indexed
+    if (overflow) {
+        for (int corner = 0; corner < cornerCount; corner++) {
+            GatherVertex(mesh, (mesh->indices != NULL) ? mesh->indices[corner] : corner,
+                         &unique[corner * VERTEX_FLOATS]);
+        }
+        uniqueCount = cornerCount;
+        free(indices);
+        indices = NULL;
+    }
+
+    baked.vertexCount = uniqueCount;
+    baked.indexCount = overflow ? 0 : cornerCount;
+    baked.indices = indices;
+    baked.vertices = unique;
+    return baked;
+}
+
+// Simulate a FIFO post-transform cache - returns 1 on a miss
+static int TouchFifoCache(unsigned int* cacheTime, unsigned int* time, int vertex) {
+    if (*time - cacheTime[vertex] <= FIFO_CACHE_SIZE) return 0;
+    cacheTime[vertex] = (*time)++;
+    return 1;
+}
+
+// Average cache misses per triangle (ACMR) of an index order
+static float MeasureACMR(const unsigned short* indices, int indexCount, int vertexCount) {
+    if (indexCount == 0) return 0.0f;
+
+    unsigned int* cacheTime = (unsigned int*)calloc(vertexCount, sizeof(unsigned int));
+    unsigned int time = FIFO_CACHE_SIZE + 1;
+    int misses = 0;
+    for (int i = 0; i < indexCount; i++) {
+        misses += TouchFifoCache(cacheTime, &time, indices[i]);
+    }
+    free(cacheTime);
+
+    return (float)misses / (indexCount / 3);
+}
+
+// Score a vertex for cache ordering: recently used vertices and vertices
+// with few triangles left score higher (Forsyth's heuristic)
+static float VertexCacheScore(int cachePosition, int remaining) {
+    if (remaining == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // The last triangle's vertices are scored flat so it is not repeated
+        if (cachePosition < 3) score = 0.75f;
+        else score = powf(1.0f - (float)(cachePosition - 3) / (VERTEX_CACHE_SIZE - 3), 1.5f);
+    }
+    return score + 2.0f / sqrtf((float)remaining);
+}
+
+// Reorder triangles so consecutive ones share vertices still in the
+// post-transform cache. Greedy: always emit the best-scoring triangle
+// that uses a cached vertex, rescoring only what the cache touched.
+static void OptimizeVertexCache(unsigned short* indices, int indexCount, int vertexCount) {
+    int triangleCount = indexCount / 3;
+    if (triangleCount <= 0) return;
+
+    // Triangles using each vertex; the live ones are kept at the front
+    int* remaining = (int*)calloc(vertexCount, sizeof(int));
+    int* adjacencyStart = (int*)malloc((vertexCount + 1) * sizeof(int));
+    int* adjacency = (int*)malloc(indexCount * sizeof(int));
+    for (int i = 0; i < indexCount; i++) remaining[indices[i]]++;
+
+    adjacencyStart[0] = 0;
+    for (int v = 0; v < vertexCount; v++) adjacencyStart[v + 1] = adjacencyStart[v] + remaining[v];
+    int* fill = (int*)calloc(vertexCount, sizeof(int));
+    for (int i = 0; i < indexCount; i++) {
+        int v = indices[i];
+        adjacency[adjacencyStart[v] + fill[v]++] = i / 3;
+    }
+    free(fill);
+
+    float* vertexScore = (float*)malloc(vertexCount * sizeof(float));
+    int* cachePosition = (int*)malloc(vertexCount * sizeof(int));
+    for (int v = 0; v < vertexCount; v++) {
+        cachePosition[v] = -1;
+        vertexScore[v] = VertexCacheScore(-1, remaining[v]);
+    }
+
+    float* triangleScore = (float*)malloc(triangleCount * sizeof(float));
+    bool* emitted = (bool*)calloc(triangleCount, sizeof(bool));
+    for (int t = 0; t < triangleCount; t++) {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+
+    unsigned short* output = (unsigned short*)malloc(indexCount * sizeof(unsigned short));
+    int cache[VERTEX_CACHE_SIZE + 3];
+    int cacheCount = 0;
+    int best = -1;
+
+    for (int out = 0; out < triangleCount; out++) {
+        // Nothing cached is usable - start over from the best triangle left
+        if (best < 0) {
+            float bestScore = -2.0f;
+            for (int t = 0; t < triangleCount; t++) {
+                if (!emitted[t] && triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        emitted[best] = true;
+        memcpy(&output[out * 3], &indices[best * 3], 3 * sizeof(unsigned short));
+
+        // Drop the triangle from its vertices' live lists
+        for (int k = 0; k < 3; k++) {
+            int v = indices[best * 3 + k];
+            int* list = &adjacency[adjacencyStart[v]];
+            for (int j = 0; j < remaining[v]; j++) {
+                if (list[j] == best) {
+                    list[j] = list[remaining[v] - 1];
+                    list[remaining[v] - 1] = best;
+                    remaining[v]--;
+                    break;
+                }
+            }
+        }
+
+        // The triangle's vertices move to the front of the LRU cache
+        int newCache[VERTEX_CACHE_SIZE + 3];
+        int newCount = 0;
+        for (int k = 0; k < 3; k++) {
+            int v = indices[best * 3 + k];
+            bool present = false;
+            for (int j = 0; j < newCount; j++) present |= (newCache[j] == v);
+            if (!present) newCache[newCount++] = v;
+        }
+        for (int j = 0; j < cacheCount; j++) {
+            int v = cache[j];
+            if (v != newCache[0] && (newCount < 2 || v != newCache[1]) && (newCount < 3 || v != newCache[2])) {
+                newCache[newCount++] = v;
+            }
+        }
+
+        // Rescore everything whose cache position changed, evictions included
+        best = -1;
+        float bestScore = -2.0f;
+        for (int j = 0; j < newCount; j++) {
+            int v = newCache[j];
+            cachePosition[v] = (j < VERTEX_CACHE_SIZE) ? j : -1;
+
+            float score = VertexCacheScore(cachePosition[v], remaining[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+
+            for (int a = 0; a < remaining[v]; a++) {
+                int t = adjacency[adjacencyStart[v] + a];
+                triangleScore[t] += delta;
+            }
+        }
+        cacheCount = (newCount < VERTEX_CACHE_SIZE) ? newCount : VERTEX_CACHE_SIZE;
+        memcpy(cache, newCache, cacheCount * sizeof(int));
+
+        for (int j = 0; j < cacheCount; j++) {
+            int v = cache[j];
+            for (int a = 0; a < remaining[v]; a++) {
+                int t = adjacency[adjacencyStart[v] + a];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    memcpy(indices, output, indexCount * sizeof(unsigned short));
+    free(output);
+    free(emitted);
+    free(triangleScore);
+    free(cachePosition);
+    free(vertexScore);
+    free(adjacency);
+    free(adjacencyStart);
+    free(remaining);
+}
+
+// A run of cache-ordered triangles moved as a unit by overdraw ordering
+typedef struct {
+    int start;
+    int count;
+    float sortKey;
+} TriangleCluster;
+
+// Sort clusters with the most outward-facing first
+static int CompareClusters(const void* a, const void* b) {
+    float ka = ((const TriangleCluster*)a)->sortKey;
+    float kb = ((const TriangleCluster*)b)->sortKey;
+    return (ka < kb) - (ka > kb);
+}
+
+// Reorder the cache-ordered triangles to reduce overdraw: split them
+// into clusters where the order restarts (a triangle missing on every
+// vertex), then draw clusters facing away from the mesh center first, as
+// they tend to occlude the rest. Kept only if the cache cost is small.
+static void OptimizeOverdraw(const float* vertices, unsigned short* indices, int indexCount, int vertexCount) {
+    int triangleCount = indexCount / 3;
+    float before = MeasureACMR(indices, indexCount, vertexCount);
+
+    TriangleCluster* clusters = (TriangleCluster*)malloc(triangleCount * sizeof(TriangleCluster));
+    int clusterCount = 0;
+    unsigned int* cacheTime = (unsigned int*)calloc(vertexCount, sizeof(unsigned int));
+    unsigned int time = FIFO_CACHE_SIZE + 1;
+
+    for (int t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for (int k = 0; k < 3; k++) misses += TouchFifoCache(cacheTime, &time, indices[t * 3 + k]);
+        if (t == 0 || misses == 3) {
+            clusters[clusterCount].start = t;
+            clusters[clusterCount].count = 0;
+            clusterCount++;
+        }
+        clusters[clusterCount - 1].count++;
+    }
+    free(cacheTime);
+
+    if (clusterCount < 2) {
+        free(clusters);
+        return;
+    }
+
+    // Area-weighted centroids and normals of each cluster and of the mesh
+    Vector3* centroids = (Vector3*)calloc(clusterCount, sizeof(Vector3));
+    Vector3* normals = (Vector3*)calloc(clusterCount, sizeof(Vector3));
+    Vector3 meshCentroid = { 0 };
+    float meshArea = 0.0f;
+
+    for (int c = 0; c < clusterCount; c++) {
+        float clusterArea = 0.0f;
+        for (int t = clusters[c].start; t < clusters[c].start + clusters[c].count; t++) {
+            const float* a = &vertices[indices[t * 3] * VERTEX_FLOATS];
+            const float* b = &vertices[indices[t * 3 + 1] * VERTEX_FLOATS];
+            const float* d = &vertices[indices[t * 3 + 2] * VERTEX_FLOATS];
+
+            float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            float e2[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+            Vector3 cross = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            float area = sqrtf(cross.x * cross.x + cross.y * cross.y + cross.z * cross.z);
+
+            centroids[c].x += area * (a[0] + b[0] + d[0]) / 3.0f;
+            centroids[c].y += area * (a[1] + b[1] + d[1]) / 3.0f;
+            centroids[c].z += area * (a[2] + b[2] + d[2]) / 3.0f;
+            normals[c].x += cross.x;
+            normals[c].y += cross.y;
+            normals[c].z += cross.z;
+            clusterArea += area;
+        }
+
+        meshCentroid.x += centroids[c].x;
+        meshCentroid.y += centroids[c].y;
+        meshCentroid.z += centroids[c].z;
+        meshArea += clusterArea;
+        if (clusterArea > 0.0f) {
+            centroids[c].x /= clusterArea;
+            centroids[c].y /= clusterArea;
+            centroids[c].z /= clusterArea;
+        }
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid.x /= meshArea;
+        meshCentroid.y /= meshArea;
+        meshCentroid.z /= meshArea;
+    }
+
+    for (int c = 0; c < clusterCount; c++) {
+        Vector3 n = normals[c];
+        float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+        clusters[c].sortKey = 0.0f;
+        if (length > 0.0f) {
+            clusters[c].sortKey = ((centroids[c].x - meshCentroid.x) * n.x + (centroids[c].y - meshCentroid.y) * n.y +
+                                   (centroids[c].z - meshCentroid.z) * n.z) / length;
+        }
+    }
+    free(centroids);
+    free(normals);
+
+    qsort(clusters, clusterCount, sizeof(TriangleCluster), CompareClusters);
+
+    unsigned short* output = (unsigned short*)malloc(indexCount * sizeof(unsigned short));
+    int written = 0;
+    for (int c = 0; c < clusterCount; c++) {
+        memcpy(&output[written], &indices[clusters[c].start * 3], clusters[c].count * 3 * sizeof(unsigned short));
+        written += clusters[c].count * 3;
+    }
+    free(clusters);
+
+    if (MeasureACMR(output, indexCount, vertexCount) <= before * OVERDRAW_THRESHOLD) {
+        memcpy(indices, output, indexCount * sizeof(unsigned short));
+    }
+    free(output);
+}
+
+// Renumber vertices in the order the triangles first use them, so the
+// vertex fetch walks memory forward. Returns the count still referenced.
+static int OptimizeVertexFetch(float* vertices, unsigned short* indices, int indexCount, int vertexCount) {
+    int* remap = (int*)malloc(vertexCount * sizeof(int));
+    for (int v = 0; v < vertexCount; v++) remap[v] = -1;
+
+    float* reordered = (float*)malloc((size_t)vertexCount * VERTEX_FLOATS * sizeof(float));
+    int next = 0;
+    for (int i = 0; i < indexCount; i++) {
+        int v = indices[i];
+        if (remap[v] < 0) {
+            remap[v] = next;
+            memcpy(&reordered[next * VERTEX_FLOATS], &vertices[v * VERTEX_FLOATS], VERTEX_FLOATS * sizeof(float));
+            next++;
+        }
+        indices[i] = (unsigned short)remap[v];
+    }
+
+    memcpy(vertices, reordered, (size_t)next * VERTEX_FLOATS * sizeof(float));
+    free(reordered);
+    free(remap);
+    return next;
+}
+
+// Order an indexed mesh for the vertex cache, overdraw and vertex fetch
+static void OptimizeMesh(BakedMesh* mesh) {
+    if (mesh->indexCount == 0) return;
+
+    OptimizeVertexCache(mesh->indices, mesh->indexCount, mesh->vertexCount);
+    OptimizeOverdraw(mesh->vertices, mesh->indices, mesh->indexCount, mesh->vertexCount);
+    mesh->vertexCount = OptimizeVertexFetch(mesh->vertices, mesh->indices, mesh->indexCount, mesh->vertexCount);
+}
+
+// Quantize a value in [0, 1] to an unsigned 16-bit fraction
+static unsigned short QuantizeUnorm16(float value) {
+    if (value < 0.0f) value = 0.0f;
+    if (value > 1.0f) value = 1.0f;
+    return (unsigned short)(value * 65535.0f + 0.5f);
+}
+
+// Quantize a value in [-1, 1] to a signed 8-bit fraction
+static signed char QuantizeSnorm8(float value) {
+    if (value < -1.0f) value = -1.0f;
+    if (value > 1.0f) value = 1.0f;
+    return (signed char)lroundf(value * 127.0f);
+}
+
+// Check if every texcoord of a mesh fits a unorm fraction
+static bool TexcoordsInUnitRange(const BakedMesh* mesh) {
+    for (int i = 0; i < mesh->vertexCount; i++) {
+        const float* uv = &mesh->vertices[i * VERTEX_FLOATS + 3];
+        if (uv[0] < 0.0f || uv[0] > 1.0f || uv[1] < 0.0f || uv[1] > 1.0f) return false;
+    }
+    return true;
+}
+
+// Size of a mesh's packed streams
+static unsigned int PackedStreamSize(const BakedMesh* mesh, bool floatTexcoords) {
+    unsigned int size = AlignSize(mesh->vertexCount * 4 * sizeof(uint16_t));
+    size += AlignSize(mesh->vertexCount * (floatTexcoords ? 2 * sizeof(float) : 2 * sizeof(uint16_t)));
+    size += AlignSize(mesh->vertexCount * 4);
+    size += AlignSize(mesh->indexCount * sizeof(unsigned short));
+    return size;
+}
+
+// Write a mesh's quantized streams at the record's offsets
+static void PackMesh(const BakedMesh* mesh, const PakModel* header, PakMesh* record, unsigned char* data) {
+    uint16_t* positions = (uint16_t*)(data + record->positionOffset);
+    signed char* normals = (signed char*)(data + record->normalOffset);
+
+    for (int i = 0; i < mesh->vertexCount; i++) {
+        const float* vertex = &mesh->vertices[i * VERTEX_FLOATS];
+
+        for (int c = 0; c < 3; c++) {
+            positions[i * 4 + c] = QuantizeUnorm16((vertex[c] - header->boundsMin[c]) / header->boundsSize[c]);
+        }
+
+        // The model transform scales the unit positions by the bounds, and
+        // the normal matrix divides by that scale. Store the normal
+        // stretched by it in advance, so the two cancel.
+        float n[3];
+        for (int c = 0; c < 3; c++) n[c] = vertex[5 + c] * header->boundsSize[c];
+        float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float scale = (length > 0.0f) ? 1.0f / length : 0.0f;
+        for (int c = 0; c < 3; c++) normals[i * 4 + c] = QuantizeSnorm8(n[c] * scale);
+
+        if (record->flags & PAK_MESH_FLOAT_TEXCOORDS) {
+            memcpy(data + record->texcoordOffset + i * 2 * sizeof(float), vertex + 3, 2 * sizeof(float));
+        } else {
+            uint16_t* texcoords = (uint16_t*)(data + record->texcoordOffset);
+            texcoords[i * 2] = QuantizeUnorm16(vertex[3]);
+            texcoords[i * 2 + 1] = QuantizeUnorm16(vertex[4]);
+        }
+    }
+
+    if (mesh->indexCount > 0) {
+        memcpy(data + record->indexOffset, mesh->indices, mesh->indexCount * sizeof(unsigned short));
+    }
+}
+
+// Find the first external image a glTF references
+static void FindModelTexture(const char* path, char* textureName, int size) {
+    textureName[0] = '\0';
+    char* text = LoadFileText(path);
+    if (text == NULL) return;
+
+    for (char* cursor = strstr(text, "\"uri\""); cursor != NULL; cursor = strstr(cursor + 1, "\"uri\"")) {
+        char* start = strchr(cursor + 5, '"');
+        if (start == NULL) break;
+        start++;
+        char* end = strchr(start, '"');
+        if (end == NULL) break;
+
+        int length = (int)(end - start);
+        if (length > 4 && strncasecmp(end - 4, ".png", 4) == 0) {
+            snprintf(textureName, size, "%.*s", length, start);
+            break;
+        }
+    }
+
+    UnloadFileText(text);
+}
+
+// Bake a model: parse it, optimize every mesh's order and store its
+// attributes quantized against the model's bounds
+static void BakeModel(const char* path) {
+    Model model = LoadModel(path);
+    if (model.meshCount == 0 || model.meshes == NULL) {
+        TraceLog(LOG_WARNING, "BAKE: [%s] Failed to load model, skipped", path);
+        return;
+    }
+
+    BakeEntry* entry = AddBakeEntry(path, PAK_ENTRY_MODEL);
+    if (entry == NULL) {
+        UnloadModel(model);
+        return;
+    }
+
+    BakedMesh* meshes = (BakedMesh*)calloc(model.meshCount, sizeof(BakedMesh));
+    MeshStats stats = { 0 };
+    PakModel header = { { INFINITY, INFINITY, INFINITY }, { 0 } };
+    float boundsMax[3] = { -INFINITY, -INFINITY, -INFINITY };
+
+    for (int i = 0; i < model.meshCount; i++) {
+        const Mesh* source = &model.meshes[i];
+        int sourceIndices = (source->indices != NULL) ? source->triangleCount * 3 : 0;
+        stats.sourceBytes += source->vertexCount * VERTEX_FLOATS * sizeof(float) + sourceIndices * sizeof(unsigned short);
+
+        meshes[i] = IndexMesh(source);
+        if (source->indices != NULL) {
+            stats.sourceACMR += MeasureACMR(source->indices, sourceIndices, source->vertexCount) * source->triangleCount;
+        } else {
+            stats.sourceACMR += source->vertexCount;
+        }
+
+        OptimizeMesh(&meshes[i]);
+        int triangles = (meshes[i].indexCount > 0 ? meshes[i].indexCount : meshes[i].vertexCount) / 3;
+        stats.bakedACMR += (meshes[i].indexCount > 0)
+            ? MeasureACMR(meshes[i].indices, meshes[i].indexCount, meshes[i].vertexCount) * triangles
+            : meshes[i].vertexCount;
+        stats.triangles += triangles;
+
+        for (int v = 0; v < meshes[i].vertexCount; v++) {
+            const float* position = &meshes[i].vertices[v * VERTEX_FLOATS];
+            for (int c = 0; c < 3; c++) {
+                header.boundsMin[c] = fminf(header.boundsMin[c], position[c]);
+                boundsMax[c] = fmaxf(boundsMax[c], position[c]);
+            }
+        }
+    }
+
+    // Flat models still need an invertible transform at runtime
+    for (int c = 0; c < 3; c++) {
+        if (header.boundsMin[c] > boundsMax[c]) header.boundsMin[c] = boundsMax[c] = 0.0f;
+        header.boundsSize[c] = fmaxf(boundsMax[c] - header.boundsMin[c], 1e-4f);
+    }
+
+    // Header and mesh records first, then each mesh's streams
+    unsigned int recordsSize = AlignSize(sizeof(PakModel) + model.meshCount * sizeof(PakMesh));
+    unsigned int size = recordsSize;
+    for (int i = 0; i < model.meshCount; i++) {
+        size += PackedStreamSize(&meshes[i], !TexcoordsInUnitRange(&meshes[i]));
+    }
+
+    entry->data = (unsigned char*)calloc(1, size);
+    entry->toc.size = size;
+    entry->toc.model.meshCount = model.meshCount;
+    entry->toc.model.textureEntry = PAK_NO_TEXTURE;
+    memcpy(entry->data, &header, sizeof(PakModel));
+
+    PakMesh* records = (PakMesh*)(entry->data + sizeof(PakModel));
+    unsigned int offset = recordsSize;
+    int vertexTotal = 0;
+    for (int i = 0; i < model.meshCount; i++) {
+        PakMesh* record = &records[i];
+        int count = meshes[i].vertexCount;
+        record->vertexCount = count;
+        record->indexCount = meshes[i].indexCount;
+        record->flags = TexcoordsInUnitRange(&meshes[i]) ? 0 : PAK_MESH_FLOAT_TEXCOORDS;
+
+        record->positionOffset = offset;
+        offset += AlignSize(count * 4 * sizeof(uint16_t));
+        record->texcoordOffset = offset;
+        offset += AlignSize(count * ((record->flags & PAK_MESH_FLOAT_TEXCOORDS) ? 2 * sizeof(float) : 2 * sizeof(uint16_t)));
+        record->normalOffset = offset;
+        offset += AlignSize(count * 4);
+        record->indexOffset = offset;
+        offset += AlignSize(record->indexCount * sizeof(unsigned short));
+
+        PackMesh(&meshes[i], &header, record, entry->data);
+        vertexTotal += count;
+        free(meshes[i].vertices);
+        free(meshes[i].indices);
+    }
+    free(meshes);
+
+    stats.bakedBytes = size;
+    float triangles = (stats.triangles > 0) ? (float)stats.triangles : 1.0f;
+    modelSourceBytes += stats.sourceBytes;
+    modelBakedBytes += stats.bakedBytes;
+    FindModelTexture(path, entry->textureName, sizeof(entry->textureName));
+
+    TraceLog(LOG_INFO, "BAKE: [%s] %d meshes, %d vertices, %d triangles, %.1f -> %.1f KB, ACMR %.2f -> %.2f",
+             path, model.meshCount, vertexTotal, stats.triangles, stats.sourceBytes / 1024.0f,
+             stats.bakedBytes / 1024.0f, stats.sourceACMR / triangles, stats.bakedACMR / triangles);
+    UnloadModel(model);
+}
+
+// Order entries by name for the runtime's binary search
+static int CompareEntries(const void* a, const void* b) {
+    return strncmp(((const BakeEntry*)a)->toc.name, ((const BakeEntry*)b)->toc.name, PAK_NAME_LENGTH);
+}
+
+// Point each model at the texture entry for its image, matched by file name
+static void ResolveModelTextures(void) {
+    for (int i = 0; i < entryCount; i++) {
+        BakeEntry* model = &entries[i];
+        if (model->toc.type != PAK_ENTRY_MODEL || model->textureName[0] == '\0') continue;
+
+        for (int j = 0; j < entryCount; j++) {
+            if (entries[j].toc.type != PAK_ENTRY_TEXTURE) continue;
+
+            const char* base = strrchr(entries[j].toc.name, '/');
+            base = (base != NULL) ? base + 1 : entries[j].toc.name;
+            if (strcmp(base, model->textureName) == 0) {
+                model->toc.model.textureEntry = j;
+                break;
+            }
+        }
+
+        if (model->toc.model.textureEntry == PAK_NO_TEXTURE) {
+            TraceLog(LOG_WARNING, "BAKE: [%s] Texture %s is not in the archive", model->toc.name, model->textureName);
+        }
+    }
+}
+
+// Write the archive: header, aligned entry data, table of contents
+static bool WritePak(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        TraceLog(LOG_ERROR, "BAKE: [%s] Failed to open output", path);
+        return false;
+    }
+
+    static const unsigned char padding[PAK_ALIGNMENT] = { 0 };
+    unsigned int offset = AlignSize(sizeof(PakHeader));
+    fseek(file, offset, SEEK_SET);
+
+    for (int i = 0; i < entryCount; i++) {
+        entries[i].toc.offset = offset;
+        fwrite(entries[i].data, 1, entries[i].toc.size, file);
+        unsigned int aligned = AlignSize(entries[i].toc.size);
+        fwrite(padding, 1, aligned - entries[i].toc.size, file);
+        offset += aligned;
+    }
+
+    PakHeader header = { PAK_MAGIC, PAK_VERSION, (uint32_t)entryCount, offset };
+    for (int i = 0; i < entryCount; i++) {
+        fwrite(&entries[i].toc, sizeof(PakEntry), 1, file);
+    }
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(PakHeader), 1, file);
+    bool ok = (ferror(file) == 0);
+    fclose(file);
+
+    TraceLog(LOG_INFO, "BAKE: [%s] Wrote %d entries, %u KB", path, entryCount,
+             (unsigned int)(offset + entryCount * sizeof(PakEntry)) / 1024);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    bool compress = false;
+    int first = 1;
+    if (first < argc && strcmp(argv[first], "--compress") == 0) {
+        compress = true;
+        first++;
+    }
+
+    if (argc - first < 2) {
+        printf("Usage: %s [--compress] output.pak input.png|input.gltf ...\n", argv[0]);
+        return 1;
+    }
+    const char* output = argv[first++];
+
+    // raylib builds models on the GPU, so a hidden window provides the context
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    SetTraceLogLevel(LOG_WARNING);
+    InitWindow(64, 64, "bake_assets");
+    SetTraceLogLevel(LOG_INFO);
+
+    for (int i = first; i < argc; i++) {
+        const char* extension = strrchr(argv[i], '.');
+        if (extension == NULL) continue;
+
+        if (strcasecmp(extension, ".png") == 0) {
+            BakeTexture(argv[i], compress);
+        } else if (strcasecmp(extension, ".gltf") == 0 || strcasecmp(extension, ".glb") == 0) {
+            BakeModel(argv[i]);
+        } else {
+            TraceLog(LOG_WARNING, "BAKE: [%s] Unsupported file type, skipped", argv[i]);
+        }
+    }
+
+    if (modelSourceBytes > 0) {
+        TraceLog(LOG_INFO, "BAKE: Model data %.1f -> %.1f KB (%.0f%%)", modelSourceBytes / 1024.0f,
+                 modelBakedBytes / 1024.0f, 100.0f * modelBakedBytes / modelSourceBytes);
+    }
+
+    qsort(entries, entryCount, sizeof(BakeEntry), CompareEntries);
+    ResolveModelTextures();
+    bool ok = WritePak(output);
+
+    for (int i = 0; i < entryCount; i++) {
+        free(entries[i].data);
+    }
+    free(entries);
+
+    CloseWindow();
+    return ok ? 0 : 1;
+}